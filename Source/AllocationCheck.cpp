@@ -0,0 +1,254 @@
+#include "AllocationCheck.h"
+#include <iostream>
+
+//==============================================================================
+AllocationCheck::AllocationCheck(const juce::StringArray& args)
+    : juce::Thread("Allocation check generator"),
+      messageThread(juce::Thread::getCurrentThreadId())
+{
+    auto getOption = [&args](const char* name)
+        {
+            int index = args.indexOf(name);
+            return index >= 0 && index + 1 < args.size() ? args[index + 1] : juce::String();
+        };
+
+    if (getOption("--allocation-rate").isNotEmpty())
+        rate = juce::jmax(1.0, getOption("--allocation-rate").getDoubleValue());
+    if (getOption("--allocation-warmup").isNotEmpty())
+        warmupSeconds = juce::jmax(0.0, getOption("--allocation-warmup").getDoubleValue());
+    if (getOption("--allocation-seconds").isNotEmpty())
+        measureSeconds = juce::jmax(0.1, getOption("--allocation-seconds").getDoubleValue());
+
+    juce::String error;
+
+    auto stages = juce::StringArray::fromTokens(getOption("--allocation-stages"), ",", "");
+    stages.trim();
+    stages.removeEmptyStrings();
+
+    for (int stage = 0; stage < AllocationCounter::numStages; ++stage)
+        checkedStages[stage] = stages.isEmpty() ? AllocationCounter::isRealtimeStage(stage)
+                                                : stages.contains(AllocationCounter::getStageName(stage));
+
+    for (auto& stage : stages)
+    {
+        bool known = false;
+        for (int i = 0; i < AllocationCounter::numStages; ++i)
+            known = known || stage == AllocationCounter::getStageName(i);
+
+        if (!known)
+            error = "Unknown allocation stage: " + stage;
+    }
+
+    // Let the OS pick a free port for the bridge's input, then hand it over
+    {
+        juce::DatagramSocket probe;
+        if (probe.bindToPort(0, "127.0.0.1"))
+            bridgePort = probe.getBoundPort();
+    }
+
+    // The bridge's output goes to a socket nobody reads: the kernel drops what doesn't fit
+    if (bridgePort <= 0 || !sinkSocket.bindToPort(0, "127.0.0.1"))
+        error = "Couldn't bind loopback sockets";
+
+    // Without the replaced allocator every count would be 0, and the check would pass whatever happened
+    if (!AllocationCounter::isEnabled)
+        error = "--allocation-check needs a build with OSC2MIDI_ALLOCATION_TRACKING=1 (the AllocationCheck configuration); "
+                "this one doesn't count allocations";
+
+    // Stand in for MIDI hardware, so the MIDI output path runs without a device
+    bridge.setMidiOutputStandIn([](const juce::MidiMessage&) {});
+
+    if (error.isEmpty())
+    {
+        juce::StringArray bridgeArgs;
+        bridgeArgs.add("--osc-in-port");
+        bridgeArgs.add(juce::String(bridgePort));
+        bridgeArgs.add("--osc-out");
+        bridgeArgs.add("127.0.0.1:" + juce::String(sinkSocket.getBoundPort()));
+        error = bridge.startHeadless(bridgeArgs);
+    }
+
+    if (error.isNotEmpty())
+    {
+        std::cerr << error << std::endl;
+        juce::JUCEApplication::getInstance()->setApplicationReturnValue(1);
+        juce::JUCEApplication::quit();
+        return;
+    }
+
+    startThread(juce::Thread::Priority::high);
+}
+
+AllocationCheck::~AllocationCheck()
+{
+    stopThread(5000);
+    bridge.setMidiOutputStandIn(nullptr);
+}
+
+//------------------------------------------------------------------------------
+void AllocationCheck::run()
+{
+    // Give the bridge's receiver a moment to start listening
+    juce::Thread::sleep(200);
+
+    // Both routes at the given rate, interleaved
+    auto interval = 1.0e9 / (rate * 2.0);
+    auto startTime = LatencyMonitor::now();
+    auto measureStart = startTime + static_cast<juce::int64>(warmupSeconds * 1.0e9);
+    auto measureEnd = measureStart + static_cast<juce::int64>(measureSeconds * 1.0e9);
+
+    Snapshot before;
+    bool measuring = false;
+    juce::uint64 measuredEvents = 0;
+
+    for (juce::uint64 i = 0; !threadShouldExit(); ++i)
+    {
+        auto due = startTime + static_cast<juce::int64>(static_cast<double>(i) * interval);
+        if (due >= measureEnd)
+            break;
+
+        if (!measuring && due >= measureStart)
+        {
+            // Let the warm-up traffic drain first, so none of it is counted
+            juce::Thread::sleep(100);
+            before = takeSnapshot();
+            measuring = true;
+        }
+
+        for (auto remaining = due - LatencyMonitor::now(); remaining > 0; remaining = due - LatencyMonitor::now())
+        {
+            if (remaining > 2000000)
+                juce::Thread::sleep(static_cast<int>((remaining - 2000000) / 1000000) + 1);
+            else
+                juce::Thread::yield();
+        }
+
+        sendEvent(i);
+
+        if (measuring)
+            ++measuredEvents;
+    }
+
+    // Let the last events through the message thread before counting
+    juce::Thread::sleep(250);
+    auto after = takeSnapshot();
+
+    if (threadShouldExit())
+        return;
+
+    juce::MessageManager::callAsync([this, before = std::move(before), after = std::move(after), measuredEvents]()
+        {
+            bool passed = report(before, after, measuredEvents);
+            juce::JUCEApplication::getInstance()->setApplicationReturnValue(passed ? 0 : 1);
+            juce::JUCEApplication::quit();
+        });
+}
+
+//------------------------------------------------------------------------------
+// Even events come in through the virtual MIDI input, odd ones over OSC. Each
+// route cycles through note on, note off, CC, pitch bend and aftertouch.
+void AllocationCheck::sendEvent(juce::uint64 index)
+{
+    auto step = static_cast<int>((index / 2) % 5);
+    auto note = 48 + static_cast<int>((index / 10) % 24);
+    auto value = static_cast<int>((index / 2) % 128);
+
+    if (index % 2 == 0)
+    {
+        switch (step)
+        {
+        case 0:  bridge.injectMidiInput(juce::MidiMessage::noteOn(1, note, static_cast<juce::uint8>(100))); break;
+        case 1:  bridge.injectMidiInput(juce::MidiMessage::noteOff(1, note)); break;
+        case 2:  bridge.injectMidiInput(juce::MidiMessage::controllerEvent(1, 1, value)); break;
+        case 3:  bridge.injectMidiInput(juce::MidiMessage::pitchWheel(1, value << 7)); break;
+        default: bridge.injectMidiInput(juce::MidiMessage::channelPressureChange(1, value)); break;
+        }
+        return;
+    }
+
+    static const ProtocolProfile::EventType types[] = { ProtocolProfile::EventType::NoteOn,
+                                                        ProtocolProfile::EventType::NoteOff,
+                                                        ProtocolProfile::EventType::ControlChange,
+                                                        ProtocolProfile::EventType::PitchBend,
+                                                        ProtocolProfile::EventType::ChannelPressure };
+    ProtocolProfile::Event event;
+    event.type = types[step];
+    event.channel = 1;
+    event.number = step == 2 ? 1 : note;
+    event.value = step == 0 ? 100 : step == 3 ? value << 7 : value;
+
+    profile->encode(event, [this](const char* data, int size)
+        {
+            generatorSocket.write("127.0.0.1", bridgePort, data, size);
+        });
+}
+
+//------------------------------------------------------------------------------
+AllocationCheck::Snapshot AllocationCheck::takeSnapshot()
+{
+    Snapshot snapshot;
+    snapshot.threads = AllocationCounter::getThreadCounts();
+
+    for (int stage = 0; stage < AllocationCounter::numStages; ++stage)
+        snapshot.stages[stage] = AllocationCounter::getStageCount(stage);
+
+    return snapshot;
+}
+
+//------------------------------------------------------------------------------
+bool AllocationCheck::report(const Snapshot& before, const Snapshot& after, juce::uint64 numEvents) const
+{
+    auto perEvent = [numEvents](juce::uint64 count)
+        {
+            return juce::String(numEvents > 0 ? static_cast<double>(count) / static_cast<double>(numEvents) : 0.0, 3);
+        };
+
+    bool passed = true;
+    juce::String text;
+    text << "Allocation check: " << static_cast<juce::int64>(numEvents) << " events over "
+         << juce::String(measureSeconds, 1) << " s after " << juce::String(warmupSeconds, 1) << " s warm-up\n\n"
+         << juce::String("stage").paddedRight(' ', 12) << juce::String("allocations").paddedLeft(' ', 13)
+         << juce::String("per event").paddedLeft(' ', 11) << "\n";
+
+    for (int stage = 0; stage < AllocationCounter::numStages; ++stage)
+    {
+        auto count = after.stages[stage] - before.stages[stage];
+        bool failed = checkedStages[stage] && count > 0;
+        passed = passed && !failed;
+
+        text << juce::String(AllocationCounter::getStageName(stage)).paddedRight(' ', 12)
+             << juce::String(static_cast<juce::int64>(count)).paddedLeft(' ', 13)
+             << perEvent(count).paddedLeft(' ', 11)
+             << (failed ? "  FAIL" : checkedStages[stage] ? "" : "  (not checked)") << "\n";
+    }
+
+    text << "\n" << juce::String("thread").paddedRight(' ', 24) << juce::String("allocations").paddedLeft(' ', 13)
+         << juce::String("per event").paddedLeft(' ', 11) << "  stages\n";
+
+    for (auto& thread : after.threads)
+    {
+        auto count = thread.count;
+        for (auto& previous : before.threads)
+            if (previous.id == thread.id)
+                count -= previous.count;
+
+        if (count == 0)
+            continue;
+
+        juce::String name = thread.id == messageThread         ? "message thread"
+                          : thread.id == getThreadId()         ? "generator (MIDI input)"
+                                                               : "thread " + juce::String::toHexString(reinterpret_cast<juce::pointer_sized_int>(thread.id));
+
+        juce::StringArray stageNames;
+        for (int stage = 0; stage < AllocationCounter::numStages; ++stage)
+            if ((thread.stages & (1u << stage)) != 0)
+                stageNames.add(AllocationCounter::getStageName(stage));
+
+        text << name.paddedRight(' ', 24) << juce::String(static_cast<juce::int64>(count)).paddedLeft(' ', 13)
+             << perEvent(count).paddedLeft(' ', 11) << "  " << stageNames.joinIntoString(", ") << "\n";
+    }
+
+    text << "\n" << (passed ? "PASS: the checked stages didn't allocate\n" : "FAIL: the checked stages allocated\n");
+    std::cout << text << std::flush;
+    return passed;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+#include "MainComponent.h"
+
+//==============================================================================
+// Steady-state allocation check, run with --allocation-check. The bridge runs
+// in-process, fed a mix of notes, CCs, pitch bend and aftertouch from both the
+// virtual MIDI input and OSC over 127.0.0.1. After a warm-up (so caches, pools
+// and queues have grown to size) the heap allocations made during a measured
+// window are reported per pipeline stage and per thread. The check fails, with
+// exit code 1, if any of the realtime stages allocated at all.
+//
+//   --allocation-check
+//   --allocation-rate <events/s>   events per second on each route (default 2000)
+//   --allocation-warmup <seconds>  traffic before measuring (default 1)
+//   --allocation-seconds <seconds> measured window (default 3)
+//   --allocation-stages <list>     comma-separated stages that must not allocate
+//                                  (default: every stage but ui)
+class AllocationCheck : private juce::Thread
+{
+public:
+    explicit AllocationCheck(const juce::StringArray& args);
+    ~AllocationCheck() override;
+
+private:
+    struct Snapshot
+    {
+        juce::uint64 stages[AllocationCounter::numStages] = {};
+        std::vector<AllocationCounter::ThreadCount> threads;
+    };
+
+    void run() override;
+    void sendEvent(juce::uint64 index);
+    static Snapshot takeSnapshot();
+
+    // Prints the difference between the snapshots and returns true if the checked stages didn't allocate
+    bool report(const Snapshot& before, const Snapshot& after, juce::uint64 numEvents) const;
+
+    MainComponent bridge;
+    ProtocolProfile::Ptr profile = ProtocolProfile::createPatchworld();
+    juce::DatagramSocket generatorSocket, sinkSocket;
+    int bridgePort = 0;
+    juce::Thread::ThreadID messageThread = nullptr;
+
+    double rate = 2000.0, warmupSeconds = 1.0, measureSeconds = 3.0;
+    bool checkedStages[AllocationCounter::numStages] = {};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AllocationCheck)
+};
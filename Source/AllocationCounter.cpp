@@ -0,0 +1,154 @@
+#include "AllocationCounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#if OSC2MIDI_ALLOCATION_TRACKING
+namespace
+{
+    // One per thread, claimed on the thread's first allocation and never released,
+    // so the totals survive the thread. Everything here is constant-initialised:
+    // the allocator can't allocate to set itself up.
+    struct ThreadRecord
+    {
+        std::atomic<juce::Thread::ThreadID> id { nullptr };
+        std::atomic<juce::uint64> count { 0 };
+        std::atomic<juce::uint32> stages { 0 };
+    };
+
+    ThreadRecord threadRecords[AllocationCounter::maxThreads];
+    std::atomic<int> numThreadRecords { 0 };
+    std::atomic<juce::uint64> stageCounts[AllocationCounter::numStages] = {};
+
+    thread_local juce::uint64 threadAllocations = 0;
+    thread_local ThreadRecord* threadRecord = nullptr;
+    thread_local int currentStage = -1;
+
+    ThreadRecord* claimThreadRecord() noexcept
+    {
+        auto index = juce::jmin(numThreadRecords.fetch_add(1, std::memory_order_relaxed), AllocationCounter::maxThreads - 1);
+        auto* record = &threadRecords[index];
+        record->id.store(juce::Thread::getCurrentThreadId(), std::memory_order_relaxed);
+        return record;
+    }
+
+    void* allocate(std::size_t size)
+    {
+        ++threadAllocations;
+
+        if (threadRecord == nullptr)
+            threadRecord = claimThreadRecord();
+
+        threadRecord->count.fetch_add(1, std::memory_order_relaxed);
+
+        if (currentStage >= 0)
+        {
+            stageCounts[currentStage].fetch_add(1, std::memory_order_relaxed);
+            threadRecord->stages.fetch_or(1u << currentStage, std::memory_order_relaxed);
+        }
+
+        return std::malloc(size == 0 ? 1 : size);
+    }
+}
+
+//==============================================================================
+juce::uint64 AllocationCounter::getThreadCount() noexcept
+{
+    return threadAllocations;
+}
+
+//------------------------------------------------------------------------------
+AllocationCounter::ScopedStage::ScopedStage(Stage stage) noexcept
+    : previousStage(currentStage)
+{
+    currentStage = stage;
+}
+
+AllocationCounter::ScopedStage::~ScopedStage() noexcept
+{
+    currentStage = previousStage;
+}
+
+//------------------------------------------------------------------------------
+juce::uint64 AllocationCounter::getStageCount(int stage) noexcept
+{
+    return stageCounts[stage].load(std::memory_order_relaxed);
+}
+#else
+//==============================================================================
+juce::uint64 AllocationCounter::getThreadCount() noexcept            { return 0; }
+juce::uint64 AllocationCounter::getStageCount(int) noexcept          { return 0; }
+#endif
+
+//------------------------------------------------------------------------------
+const char* AllocationCounter::getStageName(int stage) noexcept
+{
+    static const char* const names[numStages] = { "midi-input", "osc-input", "drain", "transform",
+                                                  "encode", "send", "log", "ui" };
+    return names[stage];
+}
+
+//------------------------------------------------------------------------------
+bool AllocationCounter::isRealtimeStage(int stage) noexcept
+{
+    return stage != ui;
+}
+
+//------------------------------------------------------------------------------
+std::vector<AllocationCounter::ThreadCount> AllocationCounter::getThreadCounts()
+{
+   #if !OSC2MIDI_ALLOCATION_TRACKING
+    return {};
+   #else
+    // Reserve first, so the caller's own allocation is in the snapshot rather than made during it
+    std::vector<ThreadCount> counts;
+    counts.reserve(static_cast<size_t>(maxThreads));
+
+    auto numRecords = juce::jmin(numThreadRecords.load(std::memory_order_relaxed), maxThreads);
+    for (int i = 0; i < numRecords; ++i)
+    {
+        ThreadCount count;
+        count.id = threadRecords[i].id.load(std::memory_order_relaxed);
+        count.count = threadRecords[i].count.load(std::memory_order_relaxed);
+        count.stages = threadRecords[i].stages.load(std::memory_order_relaxed);
+        counts.push_back(count);
+    }
+
+    return counts;
+   #endif
+}
+
+#if OSC2MIDI_ALLOCATION_TRACKING
+//==============================================================================
+// Replacements for the global allocation functions. The over-aligned variants
+// are left to the library; nothing on the bridge's paths uses them.
+void* operator new(std::size_t size)
+{
+    if (auto* memory = allocate(size))
+        return memory;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size);
+}
+
+void operator delete(void* memory) noexcept                         { std::free(memory); }
+void operator delete[](void* memory) noexcept                       { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept            { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept          { std::free(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept  { std::free(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+#endif
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+//==============================================================================
+// Counts heap allocations per thread. In builds with OSC2MIDI_ALLOCATION_TRACKING
+// set (the AllocationCheck configuration), AllocationCounter.cpp replaces the
+// global operator new, so every allocation in the process bumps a thread-local
+// counter: counting costs one increment and reading needs no locks. Take the
+// count before and after a piece of work on the same thread to see what it
+// allocated.
+//
+// The bridge's pipeline also marks which stage it is in with ScopedStage, so
+// allocations are attributed to stages as well as threads. --allocation-check
+// uses both to hold the realtime paths to zero allocations.
+//
+// Other builds keep the library's allocator: ScopedStage compiles to nothing and
+// every count stays 0.
+#ifndef OSC2MIDI_ALLOCATION_TRACKING
+ #define OSC2MIDI_ALLOCATION_TRACKING 0
+#endif
+
+namespace AllocationCounter
+{
+    // False when built without OSC2MIDI_ALLOCATION_TRACKING, so nothing is counted.
+    constexpr bool isEnabled = OSC2MIDI_ALLOCATION_TRACKING != 0;
+
+    // Allocations made by the calling thread since it started.
+    juce::uint64 getThreadCount() noexcept;
+
+    enum Stage
+    {
+        midiInput = 0,   // MIDI input and keyboard callbacks
+        oscInput,        // OSC message handling and decoding
+        drain,           // message-thread queue drain
+        transform,       // route transforms and stats
+        encode,          // OSC encoding
+        send,            // socket writes and MIDI output
+        log,             // log message queueing
+        ui,              // log list and other display updates
+        numStages
+    };
+
+    static constexpr int maxThreads = 256;
+
+    // Marks the calling thread as working in a stage until destroyed. Scopes nest;
+    // allocations are counted against the innermost one.
+   #if OSC2MIDI_ALLOCATION_TRACKING
+    class ScopedStage
+    {
+    public:
+        explicit ScopedStage(Stage stage) noexcept;
+        ~ScopedStage() noexcept;
+
+    private:
+        int previousStage;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedStage)
+    };
+   #else
+    class ScopedStage
+    {
+    public:
+        explicit ScopedStage(Stage) noexcept {}
+
+    private:
+        JUCE_DECLARE_NON_COPYABLE(ScopedStage)
+    };
+   #endif
+
+    // Allocations made in a stage since the process started, over all threads.
+    juce::uint64 getStageCount(int stage) noexcept;
+
+    const char* getStageName(int stage) noexcept;
+
+    // Everything but the display: the stages that run for every event.
+    bool isRealtimeStage(int stage) noexcept;
+
+    struct ThreadCount
+    {
+        juce::Thread::ThreadID id = nullptr;
+        juce::uint64 count = 0;
+        juce::uint32 stages = 0;   // bit per Stage that has allocated on this thread
+    };
+
+    // Every thread that has allocated so far. Threads beyond maxThreads share the last entry.
+    std::vector<ThreadCount> getThreadCounts();
+}
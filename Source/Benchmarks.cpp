@@ -0,0 +1,443 @@
+#include "Benchmarks.h"
+#include <iostream>
+#include <set>
+#include "AllocationCounter.h"
+#include "BridgeStats.h"
+#include "FairScheduler.h"
+#include "LatencyMonitor.h"
+#include "MidiTransform.h"
+#include "OscPacket.h"
+#include "ProtocolProfile.h"
+
+namespace
+{
+    // Each body runs the given number of events and returns a checksum of what it
+    // produced, which is folded into this so the optimiser can't drop the work
+    volatile juce::uint64 checksum = 0;
+
+    struct Case
+    {
+        const char* name;
+        std::function<juce::uint64(int iterations)> body;
+    };
+
+    struct Result
+    {
+        juce::String name;
+        juce::int64 iterations = 0;
+        double nsPerEvent = 0.0;
+        double allocationsPerEvent = 0.0;
+        double eventsPerSecond = 0.0;
+    };
+
+    //==========================================================================
+    Result measure(const Case& benchmark, double targetSeconds)
+    {
+        // Warm up, growing the batch until one takes at least 10 ms
+        int batchSize = 64;
+        double batchSeconds = 0.0;
+
+        for (;;)
+        {
+            auto start = LatencyMonitor::now();
+            checksum = checksum + benchmark.body(batchSize);
+            batchSeconds = static_cast<double>(LatencyMonitor::now() - start) / 1.0e9;
+
+            if (batchSeconds >= 0.01 || batchSize >= (1 << 28))
+                break;
+
+            batchSize *= 2;
+        }
+
+        // The fastest batch is reported: it's the one least disturbed by the rest of the system
+        auto numBatches = juce::jmax(5, static_cast<int>(targetSeconds / batchSeconds));
+        auto bestNs = std::numeric_limits<double>::max();
+        juce::uint64 allocations = 0;
+
+        for (int batch = 0; batch < numBatches; ++batch)
+        {
+            auto allocationsBefore = AllocationCounter::getThreadCount();
+            auto start = LatencyMonitor::now();
+            checksum = checksum + benchmark.body(batchSize);
+            auto elapsed = LatencyMonitor::now() - start;
+
+            allocations += AllocationCounter::getThreadCount() - allocationsBefore;
+            bestNs = juce::jmin(bestNs, static_cast<double>(elapsed) / batchSize);
+        }
+
+        Result result;
+        result.name = benchmark.name;
+        result.iterations = static_cast<juce::int64>(numBatches) * batchSize;
+        result.nsPerEvent = bestNs;
+        result.allocationsPerEvent = static_cast<double>(allocations) / static_cast<double>(result.iterations);
+        result.eventsPerSecond = bestNs > 0.0 ? 1.0e9 / bestNs : 0.0;
+        return result;
+    }
+
+    //==========================================================================
+    // Packets as the bridge receives them, pre-encoded with the Patchworld profile
+    std::vector<juce::MemoryBlock> encodePackets(const ProtocolProfile& profile)
+    {
+        std::vector<juce::MemoryBlock> packets;
+        auto add = [&](ProtocolProfile::EventType type, int number, int value)
+            {
+                ProtocolProfile::Event event;
+                event.type = type;
+                event.channel = 1;
+                event.number = number;
+                event.value = value;
+                profile.encode(event, [&](const char* data, int size) { packets.emplace_back(data, static_cast<size_t>(size)); });
+            };
+
+        add(ProtocolProfile::EventType::NoteOn, 60, 100);
+        add(ProtocolProfile::EventType::NoteOff, 60, 0);
+        add(ProtocolProfile::EventType::ControlChange, 74, 64);
+        add(ProtocolProfile::EventType::PitchBend, 0, 9000);
+        return packets;
+    }
+
+    // The MIDI message handleIncomingOSCMessage builds for a decoded event
+    juce::MidiMessage toMidiMessage(const ProtocolProfile::Event& event)
+    {
+        switch (event.type)
+        {
+        case ProtocolProfile::EventType::NoteOn:          return juce::MidiMessage::noteOn(event.channel, event.number, static_cast<juce::uint8>(event.value));
+        case ProtocolProfile::EventType::NoteOff:         return juce::MidiMessage::noteOff(event.channel, event.number, static_cast<juce::uint8>(event.value));
+        case ProtocolProfile::EventType::ControlChange:   return juce::MidiMessage::controllerEvent(event.channel, event.number, event.value);
+        case ProtocolProfile::EventType::PitchBend:       return juce::MidiMessage::pitchWheel(event.channel, event.value);
+        case ProtocolProfile::EventType::ChannelPressure: return juce::MidiMessage::channelPressureChange(event.channel, event.value);
+        }
+
+        return {};
+    }
+
+    //==========================================================================
+    std::vector<Case> createCases()
+    {
+        auto profile = ProtocolProfile::createPatchworld();
+
+        MidiTransform::Settings settings;
+        settings.velocityCurve = MidiTransform::Curve::Exponential;
+        settings.velocityAmount = 0.5f;
+        settings.transpose = 7;
+        settings.scaleMask = 0x0ab5;
+        auto transform = MidiTransform::compile(settings);
+
+        auto packets = std::make_shared<std::vector<juce::MemoryBlock>>(encodePackets(*profile));
+
+        std::vector<Case> cases;
+
+        //======================================================================
+        // MIDI -> OSC: what sendOSCNoteOn / sendCCMessage / sendPitchBendMessage do, minus the socket
+        auto encodeCase = [profile](ProtocolProfile::EventType type)
+            {
+                return [profile, type](int iterations)
+                    {
+                        juce::uint64 bytes = 0;
+                        ProtocolProfile::Event event;
+                        event.type = type;
+
+                        for (int i = 0; i < iterations; ++i)
+                        {
+                            event.channel = (i & 15) + 1;
+                            event.number = i & 127;
+                            event.value = type == ProtocolProfile::EventType::PitchBend ? (i & 16383) : (i & 127);
+                            profile->encode(event, [&](const char*, int size) { bytes += static_cast<juce::uint64>(size); });
+                        }
+                        return bytes;
+                    };
+            };
+
+        cases.push_back({ "midi2osc/note", encodeCase(ProtocolProfile::EventType::NoteOn) });
+        cases.push_back({ "midi2osc/cc", encodeCase(ProtocolProfile::EventType::ControlChange) });
+        cases.push_back({ "midi2osc/pitchbend", encodeCase(ProtocolProfile::EventType::PitchBend) });
+
+        // Native 'm' transport: MIDI packed into one message and written out when full
+        cases.push_back({ "midi2osc/native", [](int iterations)
+            {
+                OscMessageWriter writer;
+                char packet[OscPacket::maxPacketSize];
+                juce::uint64 bytes = 0;
+
+                writer.begin(OscPacket::nativeMidiAddress);
+                for (int i = 0; i < iterations; ++i)
+                {
+                    auto status = static_cast<juce::uint8>(0x90 | (i & 15));
+                    if (!writer.addMidi(0, status, static_cast<juce::uint8>(i & 127), 100))
+                    {
+                        bytes += static_cast<juce::uint64>(writer.write(packet, sizeof(packet)));
+                        writer.begin(OscPacket::nativeMidiAddress);
+                        writer.addMidi(0, status, static_cast<juce::uint8>(i & 127), 100);
+                    }
+                }
+                return bytes + static_cast<juce::uint64>(writer.write(packet, sizeof(packet)));
+            } });
+
+        cases.push_back({ "midi2osc/transform", [transform](int iterations)
+            {
+                juce::uint64 sum = 0;
+                for (int i = 0; i < iterations; ++i)
+                {
+                    juce::uint8 data[3] = { static_cast<juce::uint8>(0x90 | (i & 15)), static_cast<juce::uint8>(i & 127), 100 };
+                    if (transform->apply(data, 3))
+                        sum += data[1] + data[2];
+                }
+                return sum;
+            } });
+
+        //======================================================================
+        // OSC -> MIDI
+        cases.push_back({ "osc2midi/parse", [packets](int iterations)
+            {
+                OscMessageReader reader;
+                float arguments[ProtocolProfile::maxArguments];
+                juce::uint64 sum = 0;
+
+                for (int i = 0; i < iterations; ++i)
+                {
+                    auto& packet = (*packets)[static_cast<size_t>(i) % packets->size()];
+                    if (reader.parse(static_cast<const char*>(packet.getData()), static_cast<int>(packet.getSize())))
+                        sum += static_cast<juce::uint64>(ProtocolProfile::readArguments(reader, arguments));
+                }
+                return sum;
+            } });
+
+        // Parse, profile lookup, route transform and the MIDI message handed to the output
+        cases.push_back({ "osc2midi/decode-dispatch", [packets, profile, transform](int iterations)
+            {
+                OscMessageReader reader;
+                ProtocolProfile::DecoderState state;
+                ProtocolProfile::Event event;
+                float arguments[ProtocolProfile::maxArguments];
+                juce::uint64 sum = 0;
+
+                for (int i = 0; i < iterations; ++i)
+                {
+                    auto& packet = (*packets)[static_cast<size_t>(i) % packets->size()];
+                    if (!reader.parse(static_cast<const char*>(packet.getData()), static_cast<int>(packet.getSize())))
+                        continue;
+
+                    int numArguments = ProtocolProfile::readArguments(reader, arguments);
+                    if (!profile->decode(reader.getAddress(), arguments, numArguments, state, event))
+                        continue;
+
+                    auto midi = toMidiMessage(event);
+                    juce::uint8 data[3] = {};
+                    int size = midi.getRawDataSize();
+                    std::memcpy(data, midi.getRawData(), static_cast<size_t>(size));
+
+                    if (transform->apply(data, size))
+                        sum += static_cast<juce::uint64>(juce::MidiMessage(data, size).getRawDataSize());
+                }
+                return sum;
+            } });
+
+        // Baseline, not a bridge path: the juce::OSCMessage and address string that
+        // juce::OSCReceiver built for every packet before the bridge got its own receiver.
+        // Kept to compare against osc2midi/parse, which is what the receiver does now.
+        cases.push_back({ "baseline/juce-oscmessage", [](int iterations)
+            {
+                juce::uint64 sum = 0;
+                for (int i = 0; i < iterations; ++i)
+                {
+                    juce::OSCMessage message(juce::OSCAddressPattern("/ch1note"), static_cast<float>(i & 127));
+                    auto address = message.getAddressPattern().toString();
+
+                    for (auto& argument : message)
+                        sum += argument.isFloat32() ? static_cast<juce::uint64>(argument.getFloat32()) : 0;
+                    sum += static_cast<juce::uint64>(address.length());
+                }
+                return sum;
+            } });
+
+        //======================================================================
+        // Queue push from the MIDI thread and drain on the message thread, as the MIDI input
+        // source queues do, with notes from one source and controllers from another
+        cases.push_back({ "queue/push-drain", [](int iterations)
+            {
+                juce::CriticalSection lock;
+                FairScheduler queues;
+                juce::uint64 sum = 0;
+
+                for (int i = 0; i < iterations; ++i)
+                {
+                    {
+                        juce::ScopedLock scopedLock(lock);
+                        const juce::uint8 data[] = { static_cast<juce::uint8>((i & 1) != 0 ? 0xb0 : 0x90),
+                                                     static_cast<juce::uint8>(i & 127), 100 };
+                        queues.push(static_cast<juce::uint64>(1 + (i & 1)), data, 3, i);
+                    }
+
+                    // The drain usually finds a handful of events waiting
+                    if ((i & 7) == 7)
+                    {
+                        juce::ScopedLock scopedLock(lock);
+                        queues.drain(i, [&sum](juce::uint64, const FairScheduler::Event& event)
+                            {
+                                sum += event.data[1];
+                            });
+                    }
+                }
+                return sum;
+            } });
+
+        //======================================================================
+        // Note tables: activeNotes (std::set) and the ARP's heldNotes (juce::SortedSet)
+        cases.push_back({ "notes/active-set", [](int iterations)
+            {
+                std::set<int> activeNotes;
+                juce::uint64 sum = 0;
+
+                for (int i = 0; i < iterations; ++i)
+                {
+                    int note = (i * 7) & 127;
+                    if (activeNotes.find(note) != activeNotes.end())
+                        activeNotes.erase(note);
+                    else
+                        activeNotes.insert(note);
+                    sum += activeNotes.size();
+                }
+                return sum;
+            } });
+
+        cases.push_back({ "notes/held-sorted-set", [](int iterations)
+            {
+                juce::SortedSet<int> heldNotes;
+                juce::uint64 sum = 0;
+
+                for (int i = 0; i < iterations; ++i)
+                {
+                    int note = (i * 7) & 127;
+                    if (heldNotes.contains(note))
+                        heldNotes.removeValue(note);
+                    else
+                        heldNotes.add(note);
+                    sum += static_cast<juce::uint64>(heldNotes.size());
+                }
+                return sum;
+            } });
+
+        //======================================================================
+        // A typical per-event log line, appended to the pending log like logMessage
+        cases.push_back({ "log/format", [](int iterations)
+            {
+                juce::CriticalSection logLock;
+                juce::String pendingLogMessages;
+                juce::uint64 sum = 0;
+
+                for (int i = 0; i < iterations; ++i)
+                {
+                    auto message = "Received CC on channel " + juce::String((i & 15) + 1)
+                        + ": CC#" + juce::String(i & 127)
+                        + " Value: " + juce::String((i >> 7) & 127);
+                    {
+                        juce::ScopedLock lock(logLock);
+                        pendingLogMessages += message + "\n";
+                    }
+
+                    if ((i & 7) == 7)
+                    {
+                        sum += static_cast<juce::uint64>(pendingLogMessages.length());
+                        pendingLogMessages.clear();
+                    }
+                }
+                return sum;
+            } });
+
+        //======================================================================
+        // Instrumentation that runs on every event
+        cases.push_back({ "stats/count-event", [](int iterations)
+            {
+                static BridgeStats stats;
+                for (int i = 0; i < iterations; ++i)
+                    stats.countEvent(i & 1, BridgeStats::in, static_cast<juce::uint8>(0x90 | (i & 15)));
+                return static_cast<juce::uint64>(stats.getEvents(0, BridgeStats::in, 1, 1));
+            } });
+
+        cases.push_back({ "latency/record", [](int iterations)
+            {
+                static LatencyHistogram histogram;
+                for (int i = 0; i < iterations; ++i)
+                    histogram.record((i * 2654435761u) & 0xfffff);
+                return histogram.getCount();
+            } });
+
+        return cases;
+    }
+
+    //==========================================================================
+    void writeJson(const juce::File& file, const std::vector<Result>& results)
+    {
+        juce::Array<juce::var> benchmarks;
+        for (auto& result : results)
+        {
+            auto* entry = new juce::DynamicObject();
+            entry->setProperty("name", result.name);
+            entry->setProperty("iterations", result.iterations);
+            entry->setProperty("nsPerEvent", result.nsPerEvent);
+            if (AllocationCounter::isEnabled)
+                entry->setProperty("allocationsPerEvent", result.allocationsPerEvent);
+            entry->setProperty("eventsPerSecond", result.eventsPerSecond);
+            benchmarks.add(juce::var(entry));
+        }
+
+        auto* root = new juce::DynamicObject();
+        root->setProperty("version", ProjectInfo::versionString);
+        root->setProperty("time", juce::Time::getCurrentTime().toISO8601(true));
+        root->setProperty("os", juce::SystemStats::getOperatingSystemName());
+        root->setProperty("cpu", juce::SystemStats::getCpuModel());
+       #if JUCE_DEBUG
+        root->setProperty("build", "debug");
+       #else
+        root->setProperty("build", "release");
+       #endif
+        root->setProperty("benchmarks", benchmarks);
+
+        file.replaceWithText(juce::JSON::toString(juce::var(root)));
+    }
+}
+
+//==============================================================================
+int Benchmarks::run(const juce::StringArray& args)
+{
+    auto getOption = [&args](const juce::String& name)
+        {
+            int index = args.indexOf(name);
+            return index >= 0 && index + 1 < args.size() ? args[index + 1] : juce::String();
+        };
+
+    auto filter = getOption("--benchmark-filter");
+    auto targetMs = getOption("--benchmark-time").getIntValue();
+    auto targetSeconds = (targetMs > 0 ? targetMs : 300) / 1000.0;
+
+    std::vector<Result> results;
+
+    std::cout << juce::String("benchmark").paddedRight(' ', 28) << juce::String("ns/event").paddedLeft(' ', 12)
+              << juce::String("allocs/event").paddedLeft(' ', 14) << juce::String("events/s").paddedLeft(' ', 16) << std::endl;
+
+    for (auto& benchmark : createCases())
+    {
+        if (filter.isNotEmpty() && !juce::String(benchmark.name).contains(filter))
+            continue;
+
+        auto result = measure(benchmark, targetSeconds);
+        results.push_back(result);
+
+        std::cout << result.name.paddedRight(' ', 28)
+                  << juce::String(result.nsPerEvent, 1).paddedLeft(' ', 12)
+                  << (AllocationCounter::isEnabled ? juce::String(result.allocationsPerEvent, 2) : juce::String("-")).paddedLeft(' ', 14)
+                  << juce::String(static_cast<juce::int64>(result.eventsPerSecond)).paddedLeft(' ', 16) << std::endl;
+    }
+
+    if (results.empty())
+    {
+        std::cerr << "No benchmark matches " << filter << std::endl;
+        return 1;
+    }
+
+    auto json = getOption("--benchmark-json");
+    if (json.isNotEmpty())
+        writeJson(juce::File::getCurrentWorkingDirectory().getChildFile(json), results);
+
+    return 0;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// Microbenchmarks for the conversion hot paths, run with --benchmark instead of
+// starting the bridge. Each case repeats one event's worth of work through the
+// same classes the bridge uses (or a copy of the bridge's own code where it's
+// private to MainComponent) and reports ns/event, heap allocations/event and
+// events/s.
+//
+//   --benchmark                  run every case and print a table
+//   --benchmark-filter <text>    only run cases whose name contains text
+//   --benchmark-time <ms>        time spent measuring each case (default 300)
+//   --benchmark-json <file>      also write the results as JSON, for comparing versions
+namespace Benchmarks
+{
+    // Runs the benchmarks and returns the process exit code.
+    int run(const juce::StringArray& args);
+}
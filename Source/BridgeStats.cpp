@@ -0,0 +1,130 @@
+#include "BridgeStats.h"
+
+namespace
+{
+    const char* const routeNames[BridgeStats::numRoutes] = { "midi2osc", "osc2midi" };
+    const char* const directionNames[BridgeStats::numDirections] = { "in", "out" };
+    const char* const voiceTypeNames[BridgeStats::numVoiceTypes] = { "noteoff", "noteon", "polypressure", "cc",
+                                                                     "program", "pressure", "pitchbend" };
+}
+
+//==============================================================================
+void BridgeStats::reset() noexcept
+{
+    for (auto& route : events)
+        for (auto& direction : route)
+            for (auto& type : direction)
+                for (auto& count : type)
+                    count.store(0, std::memory_order_relaxed);
+
+    for (auto& count : drops)
+        count.store(0, std::memory_order_relaxed);
+
+    for (auto& size : queueHighWater)
+        size.store(0, std::memory_order_relaxed);
+
+    packetsSent.store(0, std::memory_order_relaxed);
+    bytesSent.store(0, std::memory_order_relaxed);
+    sendErrors.store(0, std::memory_order_relaxed);
+    packetsReceived.store(0, std::memory_order_relaxed);
+    sendCalls.store(0, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+// Snapshot layout (all int32 unless noted):
+//   /bridge/stats/uptime                  seconds since start
+//   /bridge/stats/<route>/<in|out>        totals per message type, noteoff ... pitchbend
+//   /bridge/stats/<route>/<in|out>/<type> 16 per-channel counts, only for types that saw traffic
+//   /bridge/stats/drops                   input filter, transform, malformed packet, unknown address, queue full,
+//                                         kernel receive buffer full, jitter buffer late, source queue,
+//                                         MIDI output lane
+//   /bridge/stats/queues                  high-water marks of the MIDI event and OSC stats request queues, and of the
+//                                         OSC socket receive buffer (bytes)
+//   /bridge/stats/socket                  packets sent, bytes sent, send errors, packets received, send calls,
+//                                         receive and send buffer sizes (bytes)
+//   /bridge/stats/latency/<route>         float end-to-end p50, p99, p99.9, max (microseconds)
+void BridgeStats::writeSnapshot(const LatencyMonitor& latency, std::function<void(const char*, int)> sendPacket) const
+{
+    OscBundleWriter bundle;
+    OscMessageWriter message;
+
+    // Starts a new bundle whenever the current one is full
+    auto addMessage = [&]
+        {
+            if (bundle.addMessage(message))
+                return;
+
+            sendPacket(bundle.getData(), bundle.getSize());
+            bundle.begin();
+            bundle.addMessage(message);
+        };
+
+    auto toInt = [](juce::uint64 value) { return static_cast<juce::int32>(static_cast<juce::uint32>(value)); };
+
+    message.begin("/bridge/stats/uptime");
+    message.addInt32(toInt((juce::Time::getMillisecondCounter() - startTime) / 1000));
+    addMessage();
+
+    for (int route = 0; route < numRoutes; ++route)
+    {
+        for (int direction = 0; direction < numDirections; ++direction)
+        {
+            juce::String prefix = juce::String(queryAddress) + "/" + routeNames[route] + "/" + directionNames[direction];
+            juce::uint32 totals[numVoiceTypes] = {};
+
+            for (int type = 0; type < numVoiceTypes; ++type)
+                for (auto& count : events[route][direction][type])
+                    totals[type] += count.load(std::memory_order_relaxed);
+
+            message.begin(prefix.toRawUTF8());
+            for (auto total : totals)
+                message.addInt32(toInt(total));
+            addMessage();
+
+            for (int type = 0; type < numVoiceTypes; ++type)
+            {
+                if (totals[type] == 0)
+                    continue;
+
+                message.begin((prefix + "/" + voiceTypeNames[type]).toRawUTF8());
+                for (auto& count : events[route][direction][type])
+                    message.addInt32(toInt(count.load(std::memory_order_relaxed)));
+                addMessage();
+            }
+        }
+    }
+
+    message.begin("/bridge/stats/drops");
+    for (auto& count : drops)
+        message.addInt32(toInt(count.load(std::memory_order_relaxed)));
+    addMessage();
+
+    message.begin("/bridge/stats/queues");
+    for (auto& size : queueHighWater)
+        message.addInt32(toInt(size.load(std::memory_order_relaxed)));
+    addMessage();
+
+    message.begin("/bridge/stats/socket");
+    message.addInt32(toInt(packetsSent.load(std::memory_order_relaxed)));
+    message.addInt32(toInt(bytesSent.load(std::memory_order_relaxed)));
+    message.addInt32(toInt(sendErrors.load(std::memory_order_relaxed)));
+    message.addInt32(toInt(packetsReceived.load(std::memory_order_relaxed)));
+    message.addInt32(toInt(sendCalls.load(std::memory_order_relaxed)));
+    message.addInt32(receiveBufferSize.load(std::memory_order_relaxed));
+    message.addInt32(sendBufferSize.load(std::memory_order_relaxed));
+    addMessage();
+
+    for (int route = 0; route < numRoutes; ++route)
+    {
+        auto& histogram = latency.getHistogram(route, LatencyMonitor::endToEnd);
+
+        message.begin((juce::String("/bridge/stats/latency/") + routeNames[route]).toRawUTF8());
+        message.addFloat32(static_cast<float>(histogram.getPercentile(0.5)) / 1000.0f);
+        message.addFloat32(static_cast<float>(histogram.getPercentile(0.99)) / 1000.0f);
+        message.addFloat32(static_cast<float>(histogram.getPercentile(0.999)) / 1000.0f);
+        message.addFloat32(static_cast<float>(histogram.getMax()) / 1000.0f);
+        addMessage();
+    }
+
+    sendPacket(bundle.getData(), bundle.getSize());
+}
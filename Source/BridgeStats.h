@@ -0,0 +1,132 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include "LatencyMonitor.h"
+#include "OscPacket.h"
+
+//==============================================================================
+// Counters for remote monitoring: events in/out per route, message type and
+// channel, drops by reason, queue high-water marks and socket activity. Every
+// update is a relaxed atomic operation, so counting costs the hot path nothing
+// more; snapshots are read and encoded separately, on demand.
+class BridgeStats
+{
+public:
+    // Indexed like TransformWindow::Route
+    static constexpr int numRoutes = 2;
+
+    // Channel voice messages, indexed by (status >> 4) - 8 like MidiInputFilter
+    static constexpr int numVoiceTypes = 7;
+
+    enum Direction
+    {
+        in = 0,
+        out,
+        numDirections
+    };
+
+    enum Drop
+    {
+        inputFilter = 0,   // rejected by the MIDI input filter
+        transform,         // dropped by a route transform (channel or note out of range)
+        malformedPacket,   // OSC packet that couldn't be parsed
+        unknownAddress,    // OSC address the protocol profile doesn't know
+        queueFull,         // incoming OSC dropped because the message thread fell behind
+        kernelReceive,     // datagrams the kernel dropped because the OSC socket's receive buffer was full
+        jitterLate,        // controller values that reached the jitter buffer after their playout time
+        sourceQueue,       // dropped by a full per-source input queue, or with every source slot busy
+        outputLane,        // dropped by a full MIDI output lane while the port is paced
+        numDrops
+    };
+
+    enum Queue
+    {
+        midiEventQueue = 0,   // MIDI input -> drain, all sources together
+        oscMessageQueue,      // stats requests, receiver thread -> message thread (bytes)
+        oscReceiveBuffer,     // bytes waiting in the OSC socket's kernel receive buffer
+        numQueues
+    };
+
+    BridgeStats() = default;
+
+    //==================================================================
+    void countEvent(int route, Direction direction, juce::uint8 status) noexcept
+    {
+        if (status >= 0x80 && status < 0xf0)
+            events[route][direction][(status >> 4) - 8][status & 0x0f].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void countDrop(Drop reason, juce::uint32 count = 1) noexcept
+    {
+        drops[reason].fetch_add(count, std::memory_order_relaxed);
+    }
+
+    void updateQueueSize(Queue queue, int size) noexcept
+    {
+        auto value = static_cast<juce::uint32>(size);
+        auto previous = queueHighWater[queue].load(std::memory_order_relaxed);
+        while (value > previous && !queueHighWater[queue].compare_exchange_weak(previous, value, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    void countPacketSent(int size) noexcept
+    {
+        countPacketsSent(1, size, 1);
+    }
+
+    // A batch of packets written with numCalls send system calls
+    void countPacketsSent(int numPackets, int numBytes, int numCalls) noexcept
+    {
+        packetsSent.fetch_add(static_cast<juce::uint64>(numPackets), std::memory_order_relaxed);
+        bytesSent.fetch_add(static_cast<juce::uint64>(numBytes), std::memory_order_relaxed);
+        sendCalls.fetch_add(static_cast<juce::uint32>(numCalls), std::memory_order_relaxed);
+    }
+
+    void countSendError(int numPackets = 1) noexcept
+    {
+        sendErrors.fetch_add(static_cast<juce::uint32>(numPackets), std::memory_order_relaxed);
+    }
+
+    void countPacketReceived() noexcept { packetsReceived.fetch_add(1, std::memory_order_relaxed); }
+
+    // Kernel buffer sizes in use on the OSC sockets, reported alongside the socket counters
+    void setSocketBufferSizes(int receiveBytes, int sendBytes) noexcept
+    {
+        receiveBufferSize.store(receiveBytes, std::memory_order_relaxed);
+        sendBufferSize.store(sendBytes, std::memory_order_relaxed);
+    }
+
+    //==================================================================
+    juce::uint32 getEvents(int route, Direction direction, int voiceType, int channel) const noexcept
+    {
+        return events[route][direction][voiceType][channel - 1].load(std::memory_order_relaxed);
+    }
+
+    juce::uint32 getDrops(Drop reason) const noexcept { return drops[reason].load(std::memory_order_relaxed); }
+
+    void reset() noexcept;
+
+    // Encodes a snapshot as one or more bundles under /bridge/stats and passes each
+    // finished packet to sendPacket(const char* data, int size).
+    void writeSnapshot(const LatencyMonitor& latency, std::function<void(const char*, int)> sendPacket) const;
+
+    // OSC addresses understood by the bridge for remote monitoring
+    static constexpr const char* queryAddress = "/bridge/stats";        // [s host, i port]: reply with a snapshot
+    static constexpr const char* pushAddress = "/bridge/stats/push";    // i seconds (0 = off) [s host, i port]
+    static constexpr const char* resetAddress = "/bridge/stats/reset";  // clears all counters
+
+private:
+    std::atomic<juce::uint32> events[numRoutes][numDirections][numVoiceTypes][16] = {};
+    std::atomic<juce::uint32> drops[numDrops] = {};
+    std::atomic<juce::uint32> queueHighWater[numQueues] = {};
+
+    std::atomic<juce::uint64> packetsSent { 0 }, bytesSent { 0 };
+    std::atomic<juce::uint32> sendErrors { 0 }, packetsReceived { 0 }, sendCalls { 0 };
+    std::atomic<int> receiveBufferSize { 0 }, sendBufferSize { 0 };
+
+    juce::uint32 startTime = juce::Time::getMillisecondCounter();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BridgeStats)
+};
@@ -0,0 +1,402 @@
+#include "FairScheduler.h"
+#include "OscPacket.h"
+
+//==============================================================================
+FairScheduler::FairScheduler()
+{
+    for (int i = 0; i < maxSources; ++i)
+        sources[i].queue = pool + i * queueSize;
+}
+
+//------------------------------------------------------------------------------
+void FairScheduler::setRateLimit(int eventsPerSecond) noexcept
+{
+    rateLimit = juce::jmax(0, eventsPerSecond);
+}
+
+void FairScheduler::setWeight(juce::uint64 sourceId, int weight) noexcept
+{
+    weight = juce::jlimit(1, maxWeight, weight);
+
+    for (auto& entry : weights)
+    {
+        if (entry.second == 0 || entry.first == sourceId)
+        {
+            entry = { sourceId, weight };
+            break;
+        }
+    }
+
+    for (auto& source : sources)
+        if (source.lastSeen != 0 && source.id.load(std::memory_order_relaxed) == sourceId)
+            source.weight = weight;
+}
+
+void FairScheduler::clearWeights() noexcept
+{
+    for (auto& entry : weights)
+        entry = {};
+
+    for (auto& source : sources)
+        source.weight = 1;
+}
+
+int FairScheduler::getConfiguredWeight(juce::uint64 sourceId) const noexcept
+{
+    for (auto& entry : weights)
+        if (entry.second != 0 && entry.first == sourceId)
+            return entry.second;
+
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+void FairScheduler::reset() noexcept
+{
+    for (auto& source : sources)
+    {
+        source.lastSeen = 0;
+        resetSource(source, 0, 0);
+    }
+
+    numQueued.store(0, std::memory_order_relaxed);
+    numUnplaced.store(0, std::memory_order_relaxed);
+}
+
+void FairScheduler::resetSource(Source& source, juce::uint64 sourceId, juce::int64 time) noexcept
+{
+    source.id.store(sourceId, std::memory_order_relaxed);
+    source.weight = getConfiguredWeight(sourceId);
+    source.head = 0;
+    source.count = 0;
+    source.heldBack = false;
+    source.tokens = juce::jmax(1.0, rateLimit / 10.0);
+    source.lastRefill = time;
+    source.numReceived.store(0, std::memory_order_relaxed);
+    source.numSent.store(0, std::memory_order_relaxed);
+    source.numSuperseded.store(0, std::memory_order_relaxed);
+    source.numDropped.store(0, std::memory_order_relaxed);
+    source.peakQueued.store(0, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+FairScheduler::Source* FairScheduler::findSource(juce::uint64 sourceId, juce::int64 time) noexcept
+{
+    // A handful of senders at most, so a linear search; a new one takes over the
+    // longest idle slot that has nothing queued
+    Source* idlest = nullptr;
+
+    for (auto& source : sources)
+    {
+        if (source.lastSeen != 0 && source.id.load(std::memory_order_relaxed) == sourceId)
+        {
+            source.lastSeen = time;
+            return &source;
+        }
+
+        if (source.count == 0 && (idlest == nullptr || source.lastSeen < idlest->lastSeen))
+            idlest = &source;
+    }
+
+    if (idlest != nullptr)
+    {
+        idlest->lastSeen = time;
+        resetSource(*idlest, sourceId, time);
+    }
+
+    return idlest;
+}
+
+//------------------------------------------------------------------------------
+bool FairScheduler::push(juce::uint64 sourceId, const juce::uint8* data, int size, juce::int64 time) noexcept
+{
+    if (size < 1 || size > 3)
+        return false;
+
+    Event event;
+    event.time = time;
+    event.size = static_cast<juce::uint8>(size);
+    std::memcpy(event.data, data, static_cast<size_t>(size));
+
+    auto* source = findSource(sourceId, juce::jmax<juce::int64>(1, time));
+    if (source == nullptr)
+    {
+        numUnplaced.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    source->numReceived.fetch_add(1, std::memory_order_relaxed);
+
+    // A value that would only go out late anyway replaces the one it supersedes. It takes the
+    // old one's place only if no note was queued after it: a value must not overtake a note
+    // (sustain off before the note-on it should hold), so otherwise it goes to the back.
+    if (isSupersedable(event) && (source->heldBack || source->count == queueSize))
+    {
+        auto key = getSupersedeKey(event);
+        bool noteBehind = false;
+
+        for (int i = source->count; --i >= 0;)
+        {
+            auto& queued = at(*source, i);
+
+            if (isSupersedable(queued) && getSupersedeKey(queued) == key)
+            {
+                if (noteBehind)
+                {
+                    removeAt(*source, i);
+                    append(*source, event);
+                }
+                else
+                {
+                    queued = event;
+                }
+
+                source->numSuperseded.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+
+            auto status = queued.data[0] & 0xf0;
+            noteBehind = noteBehind || status == 0x80 || status == 0x90;
+        }
+    }
+
+    if (source->count == queueSize && !makeRoom(*source, event))
+    {
+        source->numDropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    append(*source, event);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool FairScheduler::makeRoom(Source& source, const Event& incoming) noexcept
+{
+    // The oldest controller value goes first
+    for (int i = 0; i < source.count; ++i)
+    {
+        if (isSupersedable(at(source, i)))
+        {
+            removeAt(source, i);
+            source.numDropped.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    // Only notes left. A new note-on gives way, but a note-off is kept at the cost of the
+    // oldest queued note-on, so no note is left hanging
+    auto status = incoming.data[0] & 0xf0;
+    bool isNoteOff = status == 0x80 || (status == 0x90 && incoming.data[2] == 0);
+    if (!isNoteOff)
+        return false;
+
+    for (int i = 0; i < source.count; ++i)
+    {
+        auto& queued = at(source, i);
+        if ((queued.data[0] & 0xf0) == 0x90 && queued.data[2] != 0)
+        {
+            removeAt(source, i);
+            source.numDropped.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//------------------------------------------------------------------------------
+FairScheduler::Event FairScheduler::pop(Source& source) noexcept
+{
+    auto event = at(source, 0);
+    source.head = (source.head + 1) % queueSize;
+    --source.count;
+
+    source.numSent.fetch_add(1, std::memory_order_relaxed);
+    numQueued.fetch_sub(1, std::memory_order_relaxed);
+    return event;
+}
+
+void FairScheduler::removeAt(Source& source, int index) noexcept
+{
+    for (int i = index; i < source.count - 1; ++i)
+        at(source, i) = at(source, i + 1);
+
+    --source.count;
+    numQueued.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void FairScheduler::append(Source& source, const Event& event) noexcept
+{
+    at(source, source.count) = event;
+    ++source.count;
+
+    numQueued.fetch_add(1, std::memory_order_relaxed);
+    if (source.count > source.peakQueued.load(std::memory_order_relaxed))
+        source.peakQueued.store(source.count, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+bool FairScheduler::takeToken(Source& source, juce::int64 now) noexcept
+{
+    if (rateLimit <= 0)
+        return true;
+
+    // A tenth of a second's worth of events may go out back to back
+    auto burst = juce::jmax(1.0, rateLimit / 10.0);
+    source.tokens = juce::jmin(burst, source.tokens + static_cast<double>(now - source.lastRefill) * rateLimit / 1.0e9);
+    source.lastRefill = now;
+
+    if (source.tokens < 1.0)
+        return false;
+
+    source.tokens -= 1.0;
+    return true;
+}
+
+juce::int64 FairScheduler::getHoldTime() noexcept
+{
+    juce::int64 holdTime = -1;
+
+    for (auto& source : sources)
+    {
+        source.heldBack = source.count > 0;
+        if (!source.heldBack)
+            continue;
+
+        removeSuperseded(source);
+
+        // Until the bucket has a whole token again
+        auto wait = rateLimit > 0 ? static_cast<juce::int64>((1.0 - source.tokens) * 1.0e9 / rateLimit) + 1 : 0;
+        holdTime = holdTime < 0 ? wait : juce::jmin(holdTime, wait);
+    }
+
+    return holdTime;
+}
+
+//------------------------------------------------------------------------------
+// Keeps only the newest queued value for each controller key, in queue order.
+void FairScheduler::removeSuperseded(Source& source) noexcept
+{
+    std::bitset<65536> seen;
+    int numRemoved = 0;
+
+    // Newest first, marking older values of a key already seen as removed (size 0)
+    for (int i = source.count; --i >= 0;)
+    {
+        auto& event = at(source, i);
+        if (!isSupersedable(event))
+            continue;
+
+        auto key = static_cast<size_t>(getSupersedeKey(event));
+        if (seen[key])
+        {
+            event.size = 0;
+            ++numRemoved;
+        }
+
+        seen[key] = true;
+    }
+
+    if (numRemoved == 0)
+        return;
+
+    int kept = 0;
+    for (int i = 0; i < source.count; ++i)
+        if (at(source, i).size != 0)
+            at(source, kept++) = at(source, i);
+
+    source.count = kept;
+    numQueued.fetch_sub(numRemoved, std::memory_order_relaxed);
+    source.numSuperseded.fetch_add(static_cast<juce::uint32>(numRemoved), std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+bool FairScheduler::isSupersedable(const Event& event) noexcept
+{
+    auto status = event.data[0] & 0xf0;
+    return status == 0xa0 || status == 0xb0 || status == 0xd0 || status == 0xe0;
+}
+
+int FairScheduler::getSupersedeKey(const Event& event) noexcept
+{
+    auto status = event.data[0] & 0xf0;
+    bool numbered = status == 0xa0 || status == 0xb0;
+    return (event.data[0] << 8) | (numbered && event.size > 1 ? event.data[1] : 0);
+}
+
+//------------------------------------------------------------------------------
+std::vector<FairScheduler::SourceStats> FairScheduler::getStats() const
+{
+    std::vector<SourceStats> stats;
+
+    for (auto& source : sources)
+    {
+        SourceStats entry;
+        entry.source = source.id.load(std::memory_order_relaxed);
+        entry.numReceived = source.numReceived.load(std::memory_order_relaxed);
+
+        if (entry.numReceived == 0)
+            continue;
+
+        entry.weight = source.weight;
+        entry.numSent = source.numSent.load(std::memory_order_relaxed);
+        entry.numSuperseded = source.numSuperseded.load(std::memory_order_relaxed);
+        entry.numDropped = source.numDropped.load(std::memory_order_relaxed);
+        entry.peakQueued = source.peakQueued.load(std::memory_order_relaxed);
+        stats.push_back(entry);
+    }
+
+    return stats;
+}
+
+juce::String FairScheduler::getReport(const juce::String& route, std::function<juce::String(juce::uint64)> describeSource) const
+{
+    juce::String report;
+
+    for (auto& entry : getStats())
+        report << "Source queue " << route << " " << describeSource(entry.source)
+               << ": weight " << entry.weight
+               << ", " << static_cast<int>(entry.numReceived) << " received"
+               << ", " << static_cast<int>(entry.numSent) << " sent"
+               << ", " << static_cast<int>(entry.numSuperseded) << " superseded"
+               << ", " << static_cast<int>(entry.numDropped) << " dropped"
+               << ", peak " << entry.peakQueued << " queued\n";
+
+    if (getNumUnplaced() > 0)
+        report << "Source queue " << route << ": " << static_cast<int>(getNumUnplaced())
+               << " events dropped with every source slot busy\n";
+
+    return report;
+}
+
+//------------------------------------------------------------------------------
+void FairScheduler::writeSnapshot(const char* route, std::function<juce::String(juce::uint64)> describeSource,
+                                  std::function<void(const char*, int)> sendPacket) const
+{
+    OscBundleWriter bundle;
+    OscMessageWriter message;
+
+    for (auto& entry : getStats())
+    {
+        message.begin("/bridge/stats/source");
+        message.addString(route);
+        message.addString(describeSource(entry.source).toRawUTF8());
+        message.addInt32(entry.weight);
+        message.addInt32(static_cast<juce::int32>(entry.numReceived));
+        message.addInt32(static_cast<juce::int32>(entry.numSent));
+        message.addInt32(static_cast<juce::int32>(entry.numSuperseded));
+        message.addInt32(static_cast<juce::int32>(entry.numDropped));
+        message.addInt32(entry.peakQueued);
+
+        if (!bundle.addMessage(message))
+        {
+            sendPacket(bundle.getData(), bundle.getSize());
+            bundle.begin();
+            bundle.addMessage(message);
+        }
+    }
+
+    if (!bundle.isEmpty())
+        sendPacket(bundle.getData(), bundle.getSize());
+}
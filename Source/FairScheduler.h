@@ -0,0 +1,162 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <bitset>
+#include <functional>
+#include <vector>
+
+//==============================================================================
+// Per-source input queues for short MIDI messages, so one sender flooding
+// controller data can't hold up everyone else's notes. Each source (a remote
+// IP:port, a MIDI device...) gets its own bounded queue, and drain() takes from
+// them in weighted round-robin: every round a source may send as many events as
+// its weight. An optional per-source rate cap (token bucket, a tenth of a second
+// of burst) holds back what a source sends beyond it; held-back events wait in
+// its queue, and drain() says when to call again.
+//
+// Once a source is held back, only the latest queued value of each controller,
+// pitch bend or pressure (same channel and controller) is kept, and a new value
+// replaces the queued one; the same goes when its queue is full. It takes the
+// queued one's place unless a note was queued after that, in which case the old
+// value is removed and the new one joins the back, so values never overtake
+// notes (a sustain release stays after the note-on it follows). A full
+// queue then gives up its oldest controller value, and only if it holds nothing
+// but notes is a note dropped: the new note-on, or for a note-off the oldest
+// queued note-on.
+//
+// push(), drain() and the settings must be serialised by the caller; the
+// counters can be read from any thread.
+class FairScheduler
+{
+public:
+    struct Event
+    {
+        juce::int64 time = 0;        // caller's timestamp (e.g. ingress), passed through
+        juce::uint8 data[3] = {};
+        juce::uint8 size = 0;
+    };
+
+    FairScheduler();
+
+    // Events per second each source may send, 0 for no limit.
+    void setRateLimit(int eventsPerSecond) noexcept;
+    int getRateLimit() const noexcept { return rateLimit; }
+
+    // Events a source may send per round (1 to maxWeight), kept across reset().
+    void setWeight(juce::uint64 source, int weight) noexcept;
+    void clearWeights() noexcept;
+
+    // Forgets every source and what it had queued.
+    void reset() noexcept;
+
+    // Queues a 1-3 byte message. Returns false if it was dropped.
+    bool push(juce::uint64 source, const juce::uint8* data, int size, juce::int64 time) noexcept;
+
+    // Hands queued events to emit(source, event) in weighted round-robin order, as far as
+    // the rate limit allows. Returns how many nanoseconds after now held-back events may
+    // go, or -1 if nothing is held back.
+    template <typename Emit>
+    juce::int64 drain(juce::int64 now, Emit&& emit)
+    {
+        bool progress = true;
+        while (progress)
+        {
+            progress = false;
+
+            for (int i = 0; i < maxSources; ++i)
+            {
+                auto& source = sources[(firstSource + i) % maxSources];
+
+                for (int quantum = source.weight; quantum > 0 && source.count > 0; --quantum)
+                {
+                    if (!takeToken(source, now))
+                        break;
+
+                    emit(source.id.load(std::memory_order_relaxed), pop(source));
+                    progress = true;
+                }
+            }
+        }
+
+        // Whoever went first this time goes last next time
+        firstSource = (firstSource + 1) % maxSources;
+        return getHoldTime();
+    }
+
+    int getNumQueued() const noexcept { return numQueued.load(std::memory_order_relaxed); }
+
+    struct SourceStats
+    {
+        juce::uint64 source = 0;
+        int weight = 1;
+        juce::uint32 numReceived = 0, numSent = 0, numSuperseded = 0, numDropped = 0;
+        int peakQueued = 0;
+    };
+
+    std::vector<SourceStats> getStats() const;
+
+    // Events from new sources that found every slot busy with a backlog, and were dropped
+    juce::uint32 getNumUnplaced() const noexcept { return numUnplaced.load(std::memory_order_relaxed); }
+
+    // One line per source, named by describeSource
+    juce::String getReport(const juce::String& route, std::function<juce::String(juce::uint64)> describeSource) const;
+
+    // Encodes one /bridge/stats/source message per source as a bundle, for the stats snapshot:
+    // s route, s source, i weight, i received, i sent, i superseded, i dropped, i peak queued
+    void writeSnapshot(const char* route, std::function<juce::String(juce::uint64)> describeSource,
+                       std::function<void(const char*, int)> sendPacket) const;
+
+    static constexpr int maxSources = 16;
+    static constexpr int queueSize = 2048;
+    static constexpr int maxWeight = 64;
+
+private:
+    struct Source
+    {
+        std::atomic<juce::uint64> id { 0 };
+        juce::int64 lastSeen = 0;
+        int weight = 1;
+
+        Event* queue = nullptr;   // queueSize entries in the shared pool
+        int head = 0, count = 0;
+        bool heldBack = false;    // the rate limit stopped the last drain short
+
+        double tokens = 0.0;
+        juce::int64 lastRefill = 0;
+
+        std::atomic<juce::uint32> numReceived { 0 }, numSent { 0 }, numSuperseded { 0 }, numDropped { 0 };
+        std::atomic<int> peakQueued { 0 };
+    };
+
+    Source* findSource(juce::uint64 source, juce::int64 time) noexcept;
+    void resetSource(Source& source, juce::uint64 id, juce::int64 time) noexcept;
+    int getConfiguredWeight(juce::uint64 source) const noexcept;
+
+    Event& at(Source& source, int index) noexcept { return source.queue[(source.head + index) % queueSize]; }
+    Event pop(Source& source) noexcept;
+    void removeAt(Source& source, int index) noexcept;
+    void append(Source& source, const Event& event) noexcept;
+    bool makeRoom(Source& source, const Event& incoming) noexcept;
+    void removeSuperseded(Source& source) noexcept;
+
+    bool takeToken(Source& source, juce::int64 now) noexcept;
+    juce::int64 getHoldTime() noexcept;
+
+    // Controller-like messages that a newer one on the same key makes obsolete; the key
+    // is the status byte with, for CC and poly pressure, the controller or note number
+    static bool isSupersedable(const Event& event) noexcept;
+    static int getSupersedeKey(const Event& event) noexcept;
+
+    juce::HeapBlock<Event> pool { static_cast<size_t>(maxSources * queueSize) };
+    Source sources[maxSources];
+    int firstSource = 0;
+
+    int rateLimit = 0;
+    std::pair<juce::uint64, int> weights[maxSources] = {};
+
+    std::atomic<int> numQueued { 0 };
+    std::atomic<juce::uint32> numUnplaced { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FairScheduler)
+};
@@ -1,39 +1,53 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "MidiFilePlayer.h"
+#include "MidiSessionRecorder.h"
 
 class FileBrowserWindow : public juce::DocumentWindow
 {
 public:
     using FileSelectedCallback = std::function<void(const juce::File&)>;
 
-    FileBrowserWindow(FileSelectedCallback callback)
+    // Standard MIDI Files are loaded into the player; every selection is also reported to the callback.
+    // The recorder writes the session to a MIDI file chosen here.
+    FileBrowserWindow(MidiFilePlayer& player, MidiSessionRecorder& recorder, FileSelectedCallback callback)
         : DocumentWindow("File Browser",
             juce::Colours::lightgrey,
             DocumentWindow::allButtons),
+        contentComponent(player, recorder, callback),
         fileSelectedCallback(std::move(callback))
     {
         setUsingNativeTitleBar(true);
         setResizable(true, true);
         setResizeLimits(600, 400, 1200, 800);
 
-        setContentOwned(&contentComponent, true);
+        // The content is a member, so the window mustn't own (and delete) it
+        setContentNonOwned(&contentComponent, true);
         contentComponent.setSize(600, 400);
         centreWithSize(getWidth(), getHeight());
         setVisible(true);
     }
 
+    ~FileBrowserWindow() override
+    {
+        clearContentComponent();
+    }
+
     void closeButtonPressed() override
     {
         setVisible(false);
     }
 
 private:
-    class ContentComponent : public juce::Component
+    class ContentComponent : public juce::Component,
+                             private juce::Timer
     {
     public:
-        ContentComponent(FileSelectedCallback callback)
-            : fileSelectedCallback(std::move(callback))
+        ContentComponent(MidiFilePlayer& playerToControl, MidiSessionRecorder& recorderToControl, FileSelectedCallback callback)
+            : player(playerToControl),
+              recorder(recorderToControl),
+              fileSelectedCallback(std::move(callback))
         {
             addAndMakeVisible(openButton);
             openButton.setButtonText("Open File");
@@ -42,6 +56,50 @@ private:
             addAndMakeVisible(filePathLabel);
             filePathLabel.setText("No file selected", juce::dontSendNotification);
             filePathLabel.setJustificationType(juce::Justification::centredLeft);
+
+            addAndMakeVisible(playButton);
+            playButton.setEnabled(player.isLoaded());
+            playButton.onClick = [this]()
+                {
+                    if (player.isPlaying())
+                        player.stop();
+                    else
+                        player.play();
+                    updateTransport();
+                };
+
+            addAndMakeVisible(loopButton);
+            loopButton.setToggleState(player.isLooping(), juce::dontSendNotification);
+            loopButton.onClick = [this]() { player.setLooping(loopButton.getToggleState()); };
+
+            addAndMakeVisible(tempoLabel);
+            tempoLabel.setText("Tempo", juce::dontSendNotification);
+
+            addAndMakeVisible(tempoSlider);
+            tempoSlider.setRange(MidiFilePlayer::minTempo, MidiFilePlayer::maxTempo, 0.01);
+            tempoSlider.setSkewFactorFromMidPoint(1.0);
+            tempoSlider.setTextValueSuffix("x");
+            tempoSlider.setValue(player.getTempo(), juce::dontSendNotification);
+            tempoSlider.onValueChange = [this]() { player.setTempo(tempoSlider.getValue()); };
+
+            addAndMakeVisible(positionLabel);
+            positionLabel.setJustificationType(juce::Justification::centredLeft);
+
+            addAndMakeVisible(recordButton);
+            recordButton.onClick = [this]()
+                {
+                    if (recorder.isRecording())
+                        recorder.stop();
+                    else
+                        chooseRecordingFile();
+                    updateTransport();
+                };
+
+            addAndMakeVisible(recordLabel);
+            recordLabel.setJustificationType(juce::Justification::centredLeft);
+
+            updateTransport();
+            startTimerHz(10);
         }
 
         void resized() override
@@ -49,6 +107,19 @@ private:
             auto area = getLocalBounds().reduced(10);
             openButton.setBounds(area.removeFromTop(40).reduced(0, 5));
             filePathLabel.setBounds(area.removeFromTop(30));
+
+            auto transport = area.removeFromTop(40).reduced(0, 5);
+            playButton.setBounds(transport.removeFromLeft(100));
+            transport.removeFromLeft(10);
+            loopButton.setBounds(transport.removeFromLeft(80));
+            tempoLabel.setBounds(transport.removeFromLeft(60));
+            tempoSlider.setBounds(transport);
+
+            positionLabel.setBounds(area.removeFromTop(30));
+
+            area.removeFromTop(10);
+            recordButton.setBounds(area.removeFromTop(40).reduced(0, 5));
+            recordLabel.setBounds(area.removeFromTop(30));
         }
 
         void openFile()
@@ -65,6 +136,8 @@ private:
                     if (result.existsAsFile())
                     {
                         filePathLabel.setText(result.getFullPathName(), juce::dontSendNotification);
+                        if (result.hasFileExtension("mid;midi;smf"))
+                            loadMidiFile(result);
                         if (fileSelectedCallback)
                             fileSelectedCallback(result);
                     }
@@ -77,13 +150,85 @@ private:
                 });
         }
 
+        void chooseRecordingFile()
+        {
+            auto* chooser = new juce::FileChooser(
+                "Record session to MIDI file...",
+                juce::File(),
+                "*.mid");
+
+            chooser->launchAsync(juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::canSelectFiles
+                                     | juce::FileBrowserComponent::warnAboutOverwriting,
+                [this, chooser](const juce::FileChooser&)
+                {
+                    auto result = chooser->getResult();
+                    // Refused while the previous recording is still being written, which the label shows
+                    if (result != juce::File())
+                        recorder.start(result.withFileExtension("mid"));
+
+                    updateTransport();
+                    delete chooser;
+                });
+        }
+
     private:
+        void loadMidiFile(const juce::File& file)
+        {
+            auto error = player.load(file);
+            if (error.isNotEmpty())
+                filePathLabel.setText(error, juce::dontSendNotification);
+
+            updateTransport();
+        }
+
+        void updateTransport()
+        {
+            recordButton.setButtonText(recorder.isRecording() ? "Stop Recording" : "Record to MIDI File");
+            if (recorder.isRecording())
+                recordLabel.setText("Recording to " + recorder.getFile().getFileName() + ": "
+                    + juce::String(recorder.getNumRecorded()) + " events", juce::dontSendNotification);
+            else if (recorder.isWriting())
+                recordLabel.setText("Writing " + recorder.getFile().getFileName() + "...", juce::dontSendNotification);
+            else if (recorder.getFile() != juce::File())
+                recordLabel.setText("Recorded " + juce::String(recorder.getNumRecorded()) + " events to "
+                    + recorder.getFile().getFileName(), juce::dontSendNotification);
+
+            playButton.setEnabled(player.isLoaded());
+            playButton.setButtonText(player.isPlaying() ? "Stop" : "Play");
+
+            if (!player.isLoaded())
+            {
+                positionLabel.setText("No MIDI file loaded", juce::dontSendNotification);
+                return;
+            }
+
+            positionLabel.setText(player.getFile().getFileName() + ": "
+                + juce::String(player.getPosition(), 1) + " / " + juce::String(player.getLength(), 1) + " s, "
+                + juce::String(player.getNumEvents()) + " events", juce::dontSendNotification);
+        }
+
+        void timerCallback() override
+        {
+            if (isShowing())
+                updateTransport();
+        }
+
+        MidiFilePlayer& player;
+        MidiSessionRecorder& recorder;
+
         juce::TextButton openButton{ "Open" };
         juce::Label filePathLabel{ "Path", "No file selected" };
+        juce::TextButton playButton{ "Play" };
+        juce::ToggleButton loopButton{ "Loop" };
+        juce::Label tempoLabel;
+        juce::Slider tempoSlider{ juce::Slider::LinearHorizontal, juce::Slider::TextBoxRight };
+        juce::Label positionLabel;
+        juce::TextButton recordButton{ "Record to MIDI File" };
+        juce::Label recordLabel;
         FileSelectedCallback fileSelectedCallback;
     };
 
-    ContentComponent contentComponent{ fileSelectedCallback };
+    ContentComponent contentComponent;
     FileSelectedCallback fileSelectedCallback;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FileBrowserWindow)
@@ -0,0 +1,200 @@
+#include "JitterBuffer.h"
+#include "OscPacket.h"
+#include "OscReceiver.h"
+
+//==============================================================================
+void JitterBuffer::setEnabled(bool shouldBeEnabled) noexcept
+{
+    if (shouldBeEnabled && !isEnabled())
+        reset();
+
+    enabled.store(shouldBeEnabled, std::memory_order_relaxed);
+}
+
+void JitterBuffer::setMaxDelayMs(int milliseconds) noexcept
+{
+    maxDelay = juce::jmax(minDelay, static_cast<juce::int64>(milliseconds) * 1000000);
+}
+
+void JitterBuffer::reset() noexcept
+{
+    for (auto& source : sources)
+    {
+        source.id.store(0, std::memory_order_relaxed);
+        source.lastSeen = 0;
+        source.numEvents.store(0, std::memory_order_relaxed);
+        source.numLate.store(0, std::memory_order_relaxed);
+        source.numDropped.store(0, std::memory_order_relaxed);
+    }
+}
+
+//------------------------------------------------------------------------------
+juce::int64 JitterBuffer::schedule(juce::uint64 sourceId, juce::uint64 timeTag, juce::int64 arrivalTime, bool canDrop) noexcept
+{
+    auto& source = findSource(sourceId, arrivalTime);
+
+    // Both clocks only ever appear as differences, so the sender's needn't match ours
+    auto transit = arrivalTime - OscPacket::timeTagToNanoseconds(timeTag);
+
+    // The messages of one bundle share its tag and arrival, and count once
+    if (timeTag != source.lastTimeTag || arrivalTime != source.lastArrival)
+    {
+        update(source, transit, arrivalTime);
+        source.lastTimeTag = timeTag;
+        source.lastArrival = arrivalTime;
+    }
+
+    source.numEvents.fetch_add(1, std::memory_order_relaxed);
+
+    auto wait = source.delay.load(std::memory_order_relaxed) - (transit - source.baseTransit);
+    if (wait >= 0)
+        return wait;
+
+    if (canDrop)
+    {
+        source.numDropped.fetch_add(1, std::memory_order_relaxed);
+        return -1;
+    }
+
+    source.numLate.fetch_add(1, std::memory_order_relaxed);
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+JitterBuffer::Source& JitterBuffer::findSource(juce::uint64 sourceId, juce::int64 arrivalTime) noexcept
+{
+    // A handful of senders at most, so a linear search; a new one takes over the longest idle slot
+    Source* oldest = &sources[0];
+
+    for (auto& source : sources)
+    {
+        auto id = source.id.load(std::memory_order_relaxed);
+        if (id == sourceId && source.lastSeen != 0)
+        {
+            source.lastSeen = arrivalTime;
+            return source;
+        }
+
+        if (source.lastSeen < oldest->lastSeen || id == 0)
+            oldest = &source;
+    }
+
+    auto& source = *oldest;
+    source.id.store(sourceId, std::memory_order_relaxed);
+    source.lastSeen = arrivalTime;
+    source.windowStart = 0;
+    source.lastTimeTag = 0;
+    source.lastArrival = 0;
+    source.mean = 0;
+    source.deviation = 0;
+    source.delay.store(juce::jmin(initialDelay, maxDelay), std::memory_order_relaxed);
+    source.jitter.store(0, std::memory_order_relaxed);
+    source.numEvents.store(0, std::memory_order_relaxed);
+    source.numLate.store(0, std::memory_order_relaxed);
+    source.numDropped.store(0, std::memory_order_relaxed);
+    return source;
+}
+
+//------------------------------------------------------------------------------
+void JitterBuffer::update(Source& source, juce::int64 transit, juce::int64 arrivalTime) noexcept
+{
+    // The base follows the smallest transit of the last one to two windows, so it
+    // drifts along with the sender's clock and settles after a route change
+    if (source.windowStart == 0)
+    {
+        source.windowStart = arrivalTime;
+        source.currentMinimum = source.previousMinimum = transit;
+    }
+    else if (arrivalTime - source.windowStart >= windowLength)
+    {
+        source.windowStart = arrivalTime;
+        source.previousMinimum = source.currentMinimum;
+        source.currentMinimum = transit;
+    }
+    else
+    {
+        source.currentMinimum = juce::jmin(source.currentMinimum, transit);
+    }
+
+    source.baseTransit = juce::jmin(source.previousMinimum, source.currentMinimum);
+
+    // Running mean and mean deviation of the transit above the base, gain 1/16
+    auto excess = transit - source.baseTransit;
+    source.mean += (excess - source.mean) / 16;
+    source.deviation += (std::abs(excess - source.mean) - source.deviation) / 16;
+    source.jitter.store(source.deviation, std::memory_order_relaxed);
+
+    // Grow straight away so a run of late packets stays short; shrink over a few
+    // hundred packets so a quiet moment doesn't undo it
+    auto target = juce::jlimit(minDelay, maxDelay, source.mean + 4 * source.deviation);
+    auto delay = source.delay.load(std::memory_order_relaxed);
+    source.delay.store(target > delay ? target : delay - (delay - target) / 256, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+std::vector<JitterBuffer::SourceStats> JitterBuffer::getStats() const
+{
+    std::vector<SourceStats> stats;
+
+    for (auto& source : sources)
+    {
+        SourceStats entry;
+        entry.source = source.id.load(std::memory_order_relaxed);
+        entry.numEvents = source.numEvents.load(std::memory_order_relaxed);
+
+        if (entry.source == 0 && entry.numEvents == 0)
+            continue;
+
+        entry.delay = source.delay.load(std::memory_order_relaxed);
+        entry.jitter = source.jitter.load(std::memory_order_relaxed);
+        entry.numLate = source.numLate.load(std::memory_order_relaxed);
+        entry.numDropped = source.numDropped.load(std::memory_order_relaxed);
+        stats.push_back(entry);
+    }
+
+    return stats;
+}
+
+juce::String JitterBuffer::getReport() const
+{
+    juce::String report;
+
+    for (auto& entry : getStats())
+        report << "Jitter buffer " << OscReceiver::sourceToString(entry.source)
+               << ": delay " << juce::String(static_cast<double>(entry.delay) / 1.0e6, 1) << " ms"
+               << ", jitter " << juce::String(static_cast<double>(entry.jitter) / 1.0e6, 2) << " ms"
+               << ", " << static_cast<int>(entry.numEvents) << " events"
+               << ", " << static_cast<int>(entry.numLate) << " late"
+               << ", " << static_cast<int>(entry.numDropped) << " dropped\n";
+
+    return report;
+}
+
+//------------------------------------------------------------------------------
+void JitterBuffer::writeSnapshot(std::function<void(const char*, int)> sendPacket) const
+{
+    OscBundleWriter bundle;
+    OscMessageWriter message;
+    auto toMicroseconds = [](juce::int64 ns) { return static_cast<juce::int32>(ns / 1000); };
+
+    for (auto& entry : getStats())
+    {
+        message.begin("/bridge/stats/jitter");
+        message.addString(OscReceiver::sourceToString(entry.source).toRawUTF8());
+        message.addInt32(toMicroseconds(entry.delay));
+        message.addInt32(toMicroseconds(entry.jitter));
+        message.addInt32(static_cast<juce::int32>(entry.numEvents));
+        message.addInt32(static_cast<juce::int32>(entry.numLate));
+        message.addInt32(static_cast<juce::int32>(entry.numDropped));
+
+        if (!bundle.addMessage(message))
+        {
+            sendPacket(bundle.getData(), bundle.getSize());
+            bundle.begin();
+            bundle.addMessage(message);
+        }
+    }
+
+    if (!bundle.isEmpty())
+        sendPacket(bundle.getData(), bundle.getSize());
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <functional>
+#include <vector>
+
+//==============================================================================
+// Playout timing for time-tagged OSC arriving over a jittery network (Wi-Fi).
+// For each source it compares bundle time tags with arrival times: the
+// smallest recent transit (arrival - tag) stands for the clock offset plus the
+// fixed part of the network delay, and anything above it is jitter. Events are
+// then played at tag + that base + a small delay, which tracks the jitter
+// (mean + 4 deviations, RFC 3550-style running estimates) between 1 ms and the
+// configured maximum: it grows as soon as packets start arriving later than
+// it allows and shrinks slowly once they settle. The result keeps the sender's
+// spacing between events at the cost of a few milliseconds of fixed latency.
+//
+// schedule() is for the OSC receiver thread only; settings and reset() must be
+// serialised with it by the caller. The reported figures can be read from any
+// thread.
+class JitterBuffer
+{
+public:
+    JitterBuffer() = default;
+
+    // Off by default, and every source starts afresh when it's turned on.
+    void setEnabled(bool shouldBeEnabled) noexcept;
+    bool isEnabled() const noexcept { return enabled.load(std::memory_order_relaxed); }
+
+    void setMaxDelayMs(int milliseconds) noexcept;
+    int getMaxDelayMs() const noexcept { return static_cast<int>(maxDelay / 1000000); }
+
+    void reset() noexcept;
+
+    // How many nanoseconds after arrivalTime (LatencyMonitor::now()) an event sent
+    // at timeTag should play. An event whose playout time has already passed plays
+    // at once and counts as late, or if canDrop is set (say, a controller value the
+    // next one supersedes) returns -1 and counts as dropped.
+    juce::int64 schedule(juce::uint64 source, juce::uint64 timeTag, juce::int64 arrivalTime, bool canDrop) noexcept;
+
+    struct SourceStats
+    {
+        juce::uint64 source = 0;   // OscReceiver::SourceId
+        juce::int64 delay = 0;     // current playout delay, ns
+        juce::int64 jitter = 0;    // mean deviation of the transit, ns
+        juce::uint32 numEvents = 0, numLate = 0, numDropped = 0;
+    };
+
+    std::vector<SourceStats> getStats() const;
+    juce::String getReport() const;
+
+    // Encodes one /bridge/stats/jitter message per source as a bundle, for the stats snapshot:
+    // s source, i delay (us), i jitter (us), i events, i late, i dropped
+    void writeSnapshot(std::function<void(const char*, int)> sendPacket) const;
+
+    static constexpr int maxSources = 16;
+
+private:
+    struct Source
+    {
+        std::atomic<juce::uint64> id { 0 };
+        juce::int64 lastSeen = 0;
+
+        // Transit minimum over the current and previous window
+        juce::int64 windowStart = 0, currentMinimum = 0, previousMinimum = 0, baseTransit = 0;
+        juce::int64 mean = 0, deviation = 0;
+        juce::uint64 lastTimeTag = 0;
+        juce::int64 lastArrival = 0;
+
+        std::atomic<juce::int64> delay { 0 }, jitter { 0 };
+        std::atomic<juce::uint32> numEvents { 0 }, numLate { 0 }, numDropped { 0 };
+    };
+
+    Source& findSource(juce::uint64 source, juce::int64 arrivalTime) noexcept;
+    void update(Source& source, juce::int64 transit, juce::int64 arrivalTime) noexcept;
+
+    std::atomic<bool> enabled { false };
+    juce::int64 maxDelay = 40000000;
+
+    Source sources[maxSources];
+
+    static constexpr juce::int64 minDelay = 1000000;       // 1 ms
+    static constexpr juce::int64 initialDelay = 10000000;  // until the estimates have settled
+    static constexpr juce::int64 windowLength = 2000000000; // transit minimum window, 2 s
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(JitterBuffer)
+};
@@ -0,0 +1,105 @@
+#include "LatencyMonitor.h"
+
+//==============================================================================
+juce::uint32 LatencyHistogram::getPercentile(double fraction) const noexcept
+{
+    auto total = getCount();
+    if (total == 0)
+        return 0;
+
+    auto target = static_cast<juce::uint64>(std::ceil(juce::jlimit(0.0, 1.0, fraction) * static_cast<double>(total)));
+    target = juce::jmax<juce::uint64>(1, target);
+
+    juce::uint64 seen = 0;
+    for (int i = 0; i < numBuckets; ++i)
+    {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen >= target)
+            return juce::jmin(getBucketValue(i), getMax());
+    }
+
+    return getMax();
+}
+
+//------------------------------------------------------------------------------
+void LatencyHistogram::reset() noexcept
+{
+    for (auto& bucket : buckets)
+        bucket.store(0, std::memory_order_relaxed);
+
+    count.store(0, std::memory_order_relaxed);
+    maxValue.store(0, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+juce::uint32 LatencyHistogram::getBucketValue(int index) noexcept
+{
+    if (index < subBucketCount)
+        return static_cast<juce::uint32>(index);
+
+    int shift = index / subBucketCount - 1;
+    auto lowest = static_cast<juce::uint64>(index % subBucketCount + subBucketCount) << shift;
+    auto width = static_cast<juce::uint64>(1) << shift;
+
+    return static_cast<juce::uint32>(juce::jmin<juce::uint64>(0xffffffff, lowest + width / 2));
+}
+
+//==============================================================================
+void LatencyMonitor::reset() noexcept
+{
+    for (auto& route : histograms)
+        for (auto& histogram : route)
+            histogram.reset();
+}
+
+//------------------------------------------------------------------------------
+juce::String LatencyMonitor::getReport() const
+{
+    auto micros = [](juce::uint32 nanoseconds)
+        {
+            return juce::String(static_cast<double>(nanoseconds) / 1000.0, 1).paddedLeft(' ', 10);
+        };
+
+    juce::String report;
+
+    for (int route = 0; route < numRoutes; ++route)
+    {
+        report << getRouteName(route) << " (us)\n"
+               << juce::String("stage").paddedRight(' ', 14)
+               << juce::String("count").paddedLeft(' ', 10)
+               << juce::String("p50").paddedLeft(' ', 10)
+               << juce::String("p99").paddedLeft(' ', 10)
+               << juce::String("p99.9").paddedLeft(' ', 10)
+               << juce::String("max").paddedLeft(' ', 10) << "\n";
+
+        for (int stage = 0; stage < numStages; ++stage)
+        {
+            auto& histogram = histograms[route][stage];
+
+            report << juce::String(getStageName(stage)).paddedRight(' ', 14)
+                   << juce::String(static_cast<juce::int64>(histogram.getCount())).paddedLeft(' ', 10)
+                   << micros(histogram.getPercentile(0.5))
+                   << micros(histogram.getPercentile(0.99))
+                   << micros(histogram.getPercentile(0.999))
+                   << micros(histogram.getMax()) << "\n";
+        }
+
+        report << "\n";
+    }
+
+    return report;
+}
+
+//------------------------------------------------------------------------------
+const char* LatencyMonitor::getRouteName(int route) noexcept
+{
+    static const char* const names[numRoutes] = { "MIDI -> OSC", "OSC -> MIDI" };
+    return names[route];
+}
+
+//------------------------------------------------------------------------------
+const char* LatencyMonitor::getStageName(int stage) noexcept
+{
+    static const char* const names[numStages] = { "queue", "drain", "transform", "encode/decode", "send", "end-to-end" };
+    return names[stage];
+}
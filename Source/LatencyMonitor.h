@@ -0,0 +1,121 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <chrono>
+
+//==============================================================================
+// Log-linear latency histogram in the style of HdrHistogram: 32 linear
+// sub-buckets per power of two, so any recorded value is within ~3% of its
+// bucket. Values are nanoseconds, saturating at ~4.3 s. Recording is a couple
+// of relaxed atomic increments, so it's safe from any thread; percentiles are
+// computed by scanning the buckets and are only approximate while writers run.
+class LatencyHistogram
+{
+public:
+    static constexpr int subBucketBits = 5;
+    static constexpr int subBucketCount = 1 << subBucketBits;
+    static constexpr int numBuckets = (32 - subBucketBits + 1) * subBucketCount;
+
+    LatencyHistogram() = default;
+
+    void record(juce::int64 nanoseconds) noexcept
+    {
+        auto value = static_cast<juce::uint32>(juce::jlimit<juce::int64>(0, 0xffffffff, nanoseconds));
+
+        buckets[getBucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+
+        auto previousMax = maxValue.load(std::memory_order_relaxed);
+        while (value > previousMax && !maxValue.compare_exchange_weak(previousMax, value, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    juce::uint64 getCount() const noexcept      { return count.load(std::memory_order_relaxed); }
+    juce::uint32 getMax() const noexcept        { return maxValue.load(std::memory_order_relaxed); }
+
+    // Value (ns) at or below which the given fraction (0-1) of recorded values fall.
+    juce::uint32 getPercentile(double fraction) const noexcept;
+
+    void reset() noexcept;
+
+private:
+    static int getBucketIndex(juce::uint32 value) noexcept
+    {
+        if (value < static_cast<juce::uint32>(subBucketCount))
+            return static_cast<int>(value);
+
+        int highestBit = juce::findHighestSetBit(value);
+        int shift = highestBit - subBucketBits;
+        return (shift + 1) * subBucketCount + static_cast<int>((value >> shift) - subBucketCount);
+    }
+
+    // Midpoint of the range of values that land in a bucket
+    static juce::uint32 getBucketValue(int index) noexcept;
+
+    std::atomic<juce::uint32> buckets[numBuckets] = {};
+    std::atomic<juce::uint64> count { 0 };
+    std::atomic<juce::uint32> maxValue { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LatencyHistogram)
+};
+
+//==============================================================================
+// One histogram per route and pipeline stage. Events are stamped with now() at
+// ingress and each stage records how long it took, plus the total once the
+// event has left the bridge.
+class LatencyMonitor
+{
+public:
+    LatencyMonitor() = default;
+
+    // Indexed like TransformWindow::Route
+    static constexpr int numRoutes = 2;
+
+    enum Stage
+    {
+        queue = 0,   // ingress -> picked up by the message thread
+        drain,       // picked up -> processing starts (waiting behind earlier events in the batch)
+        transform,   // route transform tables
+        encode,      // OSC encode (MIDI -> OSC) or OSC decode (OSC -> MIDI)
+        send,        // socket write or MIDI output send
+        endToEnd,    // ingress -> sent
+        numStages
+    };
+
+    // Nanosecond timestamp; JUCE's high resolution ticks are only microseconds on Linux.
+    static juce::int64 now() noexcept
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void record(int route, Stage stage, juce::int64 nanoseconds) noexcept
+    {
+        histograms[route][stage].record(nanoseconds);
+    }
+
+    // Records the time since startTime and returns the current time, for chaining stages.
+    juce::int64 recordSince(int route, Stage stage, juce::int64 startTime) noexcept
+    {
+        auto time = now();
+        record(route, stage, time - startTime);
+        return time;
+    }
+
+    const LatencyHistogram& getHistogram(int route, Stage stage) const noexcept { return histograms[route][stage]; }
+
+    void reset() noexcept;
+
+    // Table of count / p50 / p99 / p99.9 / max per route and stage, in microseconds.
+    juce::String getReport() const;
+
+    static const char* getRouteName(int route) noexcept;
+    static const char* getStageName(int stage) noexcept;
+
+private:
+    LatencyHistogram histograms[numRoutes][numStages];
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LatencyMonitor)
+};
@@ -0,0 +1,57 @@
+#include "LatencyWindow.h"
+
+LatencyWindow::LatencyWindow(LatencyMonitor& monitor)
+    : DocumentWindow("Latency", juce::Colours::darkgrey, DocumentWindow::allButtons),
+      latencyComponent(monitor)
+{
+    setUsingNativeTitleBar(true);
+    setContentNonOwned(&latencyComponent, true);
+    latencyComponent.setSize(620, 400);
+    setResizable(true, true);
+    setResizeLimits(500, 300, 1200, 900);
+    centreWithSize(getWidth(), getHeight());
+}
+
+LatencyWindow::~LatencyWindow()
+{
+    clearContentComponent();
+}
+
+void LatencyWindow::closeButtonPressed()
+{
+    setVisible(false);
+}
+
+//==============================================================================
+LatencyWindow::LatencyComponent::LatencyComponent(LatencyMonitor& monitorToShow)
+    : monitor(monitorToShow)
+{
+    reportText.setMultiLine(true);
+    reportText.setReadOnly(true);
+    reportText.setFont(juce::FontOptions(juce::Font::getDefaultMonospacedFontName(), 14.0f, juce::Font::plain));
+    addAndMakeVisible(reportText);
+
+    resetButton.onClick = [this]()
+        {
+            monitor.reset();
+            timerCallback();
+        };
+    addAndMakeVisible(resetButton);
+
+    timerCallback();
+    startTimerHz(4);
+}
+
+void LatencyWindow::LatencyComponent::timerCallback()
+{
+    if (isShowing() || reportText.isEmpty())
+        reportText.setText(monitor.getReport(), false);
+}
+
+void LatencyWindow::LatencyComponent::resized()
+{
+    auto area = getLocalBounds().reduced(10);
+    resetButton.setBounds(area.removeFromTop(30).removeFromRight(100));
+    area.removeFromTop(5);
+    reportText.setBounds(area);
+}
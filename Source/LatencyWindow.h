@@ -0,0 +1,38 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "LatencyMonitor.h"
+
+// Pop-up window showing the per-stage latency percentiles of both routes.
+class LatencyWindow : public juce::DocumentWindow
+{
+public:
+    explicit LatencyWindow(LatencyMonitor& monitor);
+    ~LatencyWindow() override;
+
+    void closeButtonPressed() override;
+
+private:
+    class LatencyComponent : public juce::Component,
+                             private juce::Timer
+    {
+    public:
+        explicit LatencyComponent(LatencyMonitor& monitor);
+
+        void resized() override;
+
+    private:
+        void timerCallback() override;
+
+        LatencyMonitor& monitor;
+
+        juce::TextEditor reportText;
+        juce::TextButton resetButton{ "Reset" };
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LatencyComponent)
+    };
+
+    LatencyComponent latencyComponent;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LatencyWindow)
+};
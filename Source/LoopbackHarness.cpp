@@ -0,0 +1,371 @@
+#include "LoopbackHarness.h"
+#include "SocketOptions.h"
+#include <iostream>
+
+namespace
+{
+    const char* const routeNames[LoopbackHarness::numRoutes] = { "midi2osc", "osc2midi" };
+}
+
+//==============================================================================
+LoopbackHarness::LoopbackHarness(const juce::StringArray& args)
+    : juce::Thread("Loopback generator")
+{
+    auto getOption = [&args](const char* name)
+        {
+            int index = args.indexOf(name);
+            return index >= 0 && index + 1 < args.size() ? args[index + 1] : juce::String();
+        };
+
+    auto route = getOption("--loopback-route");
+    for (int i = 0; i < numRoutes; ++i)
+        if (route.isEmpty() || route == routeNames[i])
+            routes.push_back(i);
+
+    if (getOption("--loopback-start-rate").isNotEmpty())
+        startRate = juce::jmax(1.0, getOption("--loopback-start-rate").getDoubleValue());
+    if (getOption("--loopback-max-rate").isNotEmpty())
+        maxRate = juce::jmax(startRate, getOption("--loopback-max-rate").getDoubleValue());
+    if (getOption("--loopback-step").isNotEmpty())
+        stepSeconds = juce::jmax(0.1, getOption("--loopback-step").getDoubleValue());
+    if (getOption("--loopback-json").isNotEmpty())
+        jsonFile = juce::File::getCurrentWorkingDirectory().getChildFile(getOption("--loopback-json"));
+
+    juce::String error;
+    if (routes.empty())
+        error = "Unknown loopback route: " + route;
+
+    // Multicast over the loopback interface: the generator and the bridge both send to the group
+    multicastGroup = getOption("--loopback-multicast");
+    if (multicastGroup.isNotEmpty())
+    {
+        if (!SocketOptions::isMulticastAddress(multicastGroup)
+            || !SocketOptions::setMulticastInterface(generatorSocket, "127.0.0.1"))
+            error = "Not a usable multicast group: " + multicastGroup;
+
+        bridgeAddress = multicastGroup;
+    }
+
+    // Let the OS pick a free port for the bridge's input, then hand it over
+    {
+        juce::DatagramSocket probe;
+        if (probe.bindToPort(0, "127.0.0.1"))
+            bridgePort = probe.getBoundPort();
+    }
+
+    sink = std::make_unique<Sink>(*this, profile, multicastGroup);
+    if (bridgePort <= 0 || sink->getPort() <= 0)
+        error = "Couldn't bind loopback sockets";
+
+    bridge.setMidiOutputStandIn([this](const juce::MidiMessage& message)
+        {
+            if (message.isController())
+                eventArrived(oscToMidi, idFor(message.getControllerNumber(), message.getControllerValue()));
+        });
+
+    if (error.isEmpty())
+    {
+        juce::StringArray bridgeArgs;
+        bridgeArgs.add("--osc-in-port");
+        bridgeArgs.add(juce::String(bridgePort));
+        bridgeArgs.add("--osc-out");
+        bridgeArgs.add(bridgeAddress + ":" + juce::String(sink->getPort()));
+
+        if (multicastGroup.isNotEmpty())
+        {
+            bridgeArgs.add("--osc-in-group");
+            bridgeArgs.add(multicastGroup);
+            bridgeArgs.add("--multicast-if");
+            bridgeArgs.add("127.0.0.1");
+        }
+
+        error = bridge.startHeadless(bridgeArgs);
+    }
+
+    if (error.isNotEmpty())
+    {
+        std::cerr << error << std::endl;
+        juce::JUCEApplication::getInstance()->setApplicationReturnValue(1);
+        juce::JUCEApplication::quit();
+        return;
+    }
+
+    startThread(juce::Thread::Priority::high);
+}
+
+LoopbackHarness::~LoopbackHarness()
+{
+    stopThread(5000);
+    bridge.setMidiOutputStandIn(nullptr);
+    sink.reset();
+}
+
+//------------------------------------------------------------------------------
+void LoopbackHarness::run()
+{
+    // Give the bridge's receiver a moment to start listening
+    juce::Thread::sleep(200);
+
+    std::vector<RouteResult> results;
+    for (auto route : routes)
+    {
+        if (threadShouldExit())
+            return;
+
+        results.push_back(runRoute(route));
+    }
+
+    juce::MessageManager::callAsync([this, results]()
+        {
+            std::cout << getReport(results) << std::flush;
+
+            if (jsonFile != juce::File())
+                writeJson(jsonFile, results);
+
+            juce::JUCEApplication::quit();
+        });
+}
+
+//------------------------------------------------------------------------------
+LoopbackHarness::RouteResult LoopbackHarness::runRoute(int route)
+{
+    RouteResult result;
+    result.route = route;
+
+    // Grow the rate by half each step until something is lost
+    for (auto rate = startRate; rate <= maxRate && !threadShouldExit(); rate *= 1.5)
+    {
+        auto step = runStep(route, rate);
+        result.steps.push_back(step);
+
+        if (step.received < step.sent || step.overrun)
+            break;
+
+        result.sustainableRate = rate;
+    }
+
+    return result;
+}
+
+//------------------------------------------------------------------------------
+LoopbackHarness::StepResult LoopbackHarness::runStep(int route, double rate)
+{
+    for (auto& sendTime : sendTimes)
+        sendTime.store(0, std::memory_order_relaxed);
+
+    numReceived.store(0, std::memory_order_relaxed);
+    latency.reset();
+    activeRoute.store(route, std::memory_order_release);
+
+    StepResult result;
+    result.rate = rate;
+
+    auto numEvents = static_cast<juce::int64>(rate * stepSeconds);
+    auto interval = 1.0e9 / rate;
+    auto startTime = LatencyMonitor::now();
+
+    for (juce::int64 i = 0; i < numEvents && !threadShouldExit(); ++i)
+    {
+        // Sleep while the next event is far off, then yield; when behind, send straight away
+        auto due = startTime + static_cast<juce::int64>(static_cast<double>(i) * interval);
+        for (auto remaining = due - LatencyMonitor::now(); remaining > 0; remaining = due - LatencyMonitor::now())
+        {
+            if (remaining > 2000000)
+                juce::Thread::sleep(static_cast<int>((remaining - 2000000) / 1000000) + 1);
+            else
+                juce::Thread::yield();
+        }
+
+        if (!sendEvent(route, static_cast<int>(i % numIds)))
+        {
+            result.overrun = true;
+            break;
+        }
+
+        ++result.sent;
+    }
+
+    // Wait for stragglers, but not forever: whatever hasn't arrived within a second is lost
+    for (int i = 0; i < 100 && numReceived.load(std::memory_order_relaxed) < result.sent; ++i)
+        juce::Thread::sleep(10);
+
+    activeRoute.store(-1, std::memory_order_release);
+
+    result.received = numReceived.load(std::memory_order_relaxed);
+    result.p50 = latency.getPercentile(0.5);
+    result.p99 = latency.getPercentile(0.99);
+    result.p999 = latency.getPercentile(0.999);
+    result.max = latency.getMax();
+    return result;
+}
+
+//------------------------------------------------------------------------------
+bool LoopbackHarness::sendEvent(int route, int id)
+{
+    int number = id >> 7;
+    int value = id & 127;
+
+    // Reusing an id whose event hasn't arrived would time the old one against the new send
+    juce::int64 inFlight = 0;
+    if (!sendTimes[id].compare_exchange_strong(inFlight, LatencyMonitor::now(), std::memory_order_relaxed))
+        return false;
+
+    if (route == midiToOsc)
+    {
+        bridge.injectMidiInput(juce::MidiMessage::controllerEvent(1, number, value));
+        return true;
+    }
+
+    ProtocolProfile::Event event;
+    event.type = ProtocolProfile::EventType::ControlChange;
+    event.channel = 1;
+    event.number = number;
+    event.value = value;
+
+    profile->encode(event, [this](const char* data, int size)
+        {
+            generatorSocket.write(bridgeAddress, bridgePort, data, size);
+        });
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// Called on the sink thread (midi2osc) or the bridge's OSC receiver thread (osc2midi).
+// Only the first arrival of an id counts, so echoes and duplicates aren't timed twice.
+void LoopbackHarness::eventArrived(int route, int id) noexcept
+{
+    if (activeRoute.load(std::memory_order_acquire) != route)
+        return;
+
+    auto sendTime = sendTimes[id].exchange(0, std::memory_order_relaxed);
+    if (sendTime == 0)
+        return;
+
+    latency.record(LatencyMonitor::now() - sendTime);
+    numReceived.fetch_add(1, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+juce::String LoopbackHarness::getReport(const std::vector<RouteResult>& results) const
+{
+    auto toMicroseconds = [](juce::uint32 ns) { return juce::String(ns / 1000.0, 1).paddedLeft(' ', 11); };
+
+    juce::String report;
+    report << "Loopback test on 127.0.0.1, " << juce::String(stepSeconds, 1) << " s steps"
+           << (multicastGroup.isNotEmpty() ? ", OSC via multicast group " + multicastGroup : juce::String()) << "\n";
+
+    for (auto& result : results)
+    {
+        report << "\n" << routeNames[result.route] << ": sustainable "
+               << juce::String(static_cast<juce::int64>(result.sustainableRate)) << " events/s\n"
+               << juce::String("rate").paddedLeft(' ', 10) << juce::String("sent").paddedLeft(' ', 11)
+               << juce::String("received").paddedLeft(' ', 11) << juce::String("p50 us").paddedLeft(' ', 11)
+               << juce::String("p99 us").paddedLeft(' ', 11) << juce::String("p99.9 us").paddedLeft(' ', 11)
+               << juce::String("max us").paddedLeft(' ', 11) << "\n";
+
+        for (auto& step : result.steps)
+            report << juce::String(static_cast<juce::int64>(step.rate)).paddedLeft(' ', 10)
+                   << juce::String(static_cast<juce::int64>(step.sent)).paddedLeft(' ', 11)
+                   << juce::String(static_cast<juce::int64>(step.received)).paddedLeft(' ', 11)
+                   << toMicroseconds(step.p50) << toMicroseconds(step.p99)
+                   << toMicroseconds(step.p999) << toMicroseconds(step.max)
+                   << (step.overrun ? "  id overrun" : "") << "\n";
+    }
+
+    return report;
+}
+
+//------------------------------------------------------------------------------
+void LoopbackHarness::writeJson(const juce::File& file, const std::vector<RouteResult>& results) const
+{
+    juce::Array<juce::var> routeResults;
+    for (auto& result : results)
+    {
+        juce::Array<juce::var> steps;
+        for (auto& step : result.steps)
+        {
+            auto* entry = new juce::DynamicObject();
+            entry->setProperty("rate", step.rate);
+            entry->setProperty("sent", static_cast<juce::int64>(step.sent));
+            entry->setProperty("received", static_cast<juce::int64>(step.received));
+            entry->setProperty("overrun", step.overrun);
+            entry->setProperty("p50Ns", static_cast<juce::int64>(step.p50));
+            entry->setProperty("p99Ns", static_cast<juce::int64>(step.p99));
+            entry->setProperty("p999Ns", static_cast<juce::int64>(step.p999));
+            entry->setProperty("maxNs", static_cast<juce::int64>(step.max));
+            steps.add(juce::var(entry));
+        }
+
+        auto* entry = new juce::DynamicObject();
+        entry->setProperty("route", routeNames[result.route]);
+        entry->setProperty("sustainableRate", result.sustainableRate);
+        entry->setProperty("steps", steps);
+        routeResults.add(juce::var(entry));
+    }
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty("version", ProjectInfo::versionString);
+    root->setProperty("time", juce::Time::getCurrentTime().toISO8601(true));
+    root->setProperty("stepSeconds", stepSeconds);
+    root->setProperty("multicastGroup", multicastGroup);
+    root->setProperty("routes", routeResults);
+
+    file.replaceWithText(juce::JSON::toString(juce::var(root)));
+}
+
+//==============================================================================
+LoopbackHarness::Sink::Sink(LoopbackHarness& ownerToNotify, ProtocolProfile::Ptr profileToDecode,
+                           const juce::String& multicastGroup)
+    : juce::Thread("Loopback sink"),
+      owner(ownerToNotify),
+      profile(std::move(profileToDecode))
+{
+    // A group's datagrams are addressed to the group, so a socket bound to 127.0.0.1 wouldn't see them
+    if (multicastGroup.isEmpty())
+    {
+        if (socket.bindToPort(0, "127.0.0.1"))
+            startThread(juce::Thread::Priority::high);
+    }
+    else if (socket.bindToPort(0) && SocketOptions::joinMulticastGroup(socket, multicastGroup, "127.0.0.1"))
+    {
+        startThread(juce::Thread::Priority::high);
+    }
+    else
+    {
+        socket.shutdown();   // getPort() reports the failure
+    }
+}
+
+LoopbackHarness::Sink::~Sink()
+{
+    signalThreadShouldExit();
+    socket.shutdown();
+    stopThread(2000);
+}
+
+//------------------------------------------------------------------------------
+void LoopbackHarness::Sink::run()
+{
+    char buffer[OscPacket::maxPacketSize];
+    OscMessageReader reader;
+    ProtocolProfile::DecoderState state;
+    ProtocolProfile::Event event;
+    float arguments[ProtocolProfile::maxArguments];
+
+    while (!threadShouldExit())
+    {
+        if (socket.waitUntilReady(true, 50) <= 0)
+            continue;
+
+        int size = socket.read(buffer, sizeof(buffer), false);
+        if (size <= 0 || !reader.parse(buffer, size))
+            continue;
+
+        int numArguments = ProtocolProfile::readArguments(reader, arguments);
+
+        if (profile->decode(reader.getAddress(), arguments, numArguments, state, event)
+            && event.type == ProtocolProfile::EventType::ControlChange)
+            owner.eventArrived(midiToOsc, idFor(event.number, event.value));
+    }
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <vector>
+#include "MainComponent.h"
+
+//==============================================================================
+// End-to-end throughput and latency harness, run with --loopback-test. The
+// bridge runs in-process against a traffic generator and a sink on 127.0.0.1,
+// with the bridge's virtual MIDI port standing in for MIDI hardware:
+//
+//   midi2osc   generator -> virtual MIDI input -> bridge -> UDP -> sink
+//   osc2midi   generator -> UDP -> bridge -> virtual MIDI output
+//
+// Each route is driven with CC messages at a rate that grows step by step until
+// events are lost. The report gives the highest rate with no loss and the
+// latency distribution at each step. The CC number and value identify each
+// event (16384 in flight at most), so every event is timed individually. A step
+// that would reuse an id still in flight stops there and is reported as an id
+// overrun, the same as a loss, rather than timing the wrong event.
+//
+//   --loopback-test                   run both routes, print the report and exit
+//   --loopback-route <name>           only midi2osc or osc2midi
+//   --loopback-start-rate <events/s>  first step (default 1000)
+//   --loopback-max-rate <events/s>    highest step (default 500000)
+//   --loopback-step <seconds>         length of each step (default 2)
+//   --loopback-json <file>            also write the results as JSON
+//   --loopback-multicast <group>      send the OSC of both routes to a multicast group
+//                                     on the loopback interface instead of unicast
+class LoopbackHarness : private juce::Thread
+{
+public:
+    explicit LoopbackHarness(const juce::StringArray& args);
+    ~LoopbackHarness() override;
+
+    enum Route
+    {
+        midiToOsc = 0,
+        oscToMidi,
+        numRoutes
+    };
+
+private:
+    struct StepResult
+    {
+        double rate = 0.0;
+        juce::uint64 sent = 0, received = 0;
+        bool overrun = false;   // stopped early: the next id was still in flight
+        juce::uint32 p50 = 0, p99 = 0, p999 = 0, max = 0;   // ns
+    };
+
+    struct RouteResult
+    {
+        int route = midiToOsc;
+        double sustainableRate = 0.0;
+        std::vector<StepResult> steps;
+    };
+
+    // Receives the bridge's OSC output and decodes it back to CC ids
+    class Sink : private juce::Thread
+    {
+    public:
+        // Listens on 127.0.0.1, or in the multicast group on the loopback interface if one is given
+        Sink(LoopbackHarness& owner, ProtocolProfile::Ptr profile, const juce::String& multicastGroup);
+        ~Sink() override;
+
+        int getPort() const { return socket.getBoundPort(); }
+
+    private:
+        void run() override;
+
+        LoopbackHarness& owner;
+        ProtocolProfile::Ptr profile;
+        juce::DatagramSocket socket;
+    };
+
+    void run() override;
+    RouteResult runRoute(int route);
+    StepResult runStep(int route, double rate);
+    bool sendEvent(int route, int id);   // false, sending nothing, if the id is still in flight
+    void eventArrived(int route, int id) noexcept;
+    juce::String getReport(const std::vector<RouteResult>& results) const;
+    void writeJson(const juce::File& file, const std::vector<RouteResult>& results) const;
+
+    static int idFor(int number, int value) noexcept { return ((number & 127) << 7) | (value & 127); }
+    static constexpr int numIds = 16384;
+
+    MainComponent bridge;
+    ProtocolProfile::Ptr profile = ProtocolProfile::createPatchworld();
+    std::unique_ptr<Sink> sink;
+    juce::DatagramSocket generatorSocket;
+    int bridgePort = 0;
+    juce::String multicastGroup, bridgeAddress { "127.0.0.1" };
+
+    std::vector<int> routes;
+    double startRate = 1000.0, maxRate = 500000.0, stepSeconds = 2.0;
+    juce::File jsonFile;
+
+    // Send time of each id still in flight (0 when none), read by whichever thread sees it arrive
+    std::atomic<juce::int64> sendTimes[numIds] = {};
+    std::atomic<int> activeRoute { -1 };
+    std::atomic<juce::uint64> numReceived { 0 };
+    LatencyHistogram latency;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LoopbackHarness)
+};
@@ -7,7 +7,13 @@
 */
 
 #include <JuceHeader.h>
+#include <iostream>
 #include "MainComponent.h"
+#include "Benchmarks.h"
+#include "LoopbackHarness.h"
+#include "TrafficGenerator.h"
+#include "AllocationCheck.h"
+#include "SessionHost.h"
 
 //==============================================================================
 class secondApplication  : public juce::JUCEApplication
@@ -25,6 +31,61 @@ public:
     {
         // This method is where you should put your application's initialisation code..
 
+        auto args = getCommandLineParameterArray();
+
+        if (args.contains ("--benchmark"))
+        {
+            setApplicationReturnValue (Benchmarks::run (args));
+            quit();
+            return;
+        }
+
+       #if JUCE_UNIT_TESTS
+        if (args.contains ("--unit-tests"))
+        {
+            juce::UnitTestRunner runner;
+            runner.runAllTests();
+
+            int failures = 0;
+            for (int i = 0; i < runner.getNumResults(); ++i)
+                failures += runner.getResult (i)->failures;
+
+            setApplicationReturnValue (failures > 0 ? 1 : 0);
+            quit();
+            return;
+        }
+       #endif
+
+        if (args.contains ("--loopback-test"))
+        {
+            loopbackHarness.reset (new LoopbackHarness (args));
+            return;
+        }
+
+        if (args.contains ("--generate"))
+        {
+            trafficGenerator.reset (new TrafficGenerator (args));
+            return;
+        }
+
+        if (args.contains ("--allocation-check"))
+        {
+            allocationCheck.reset (new AllocationCheck (args));
+            return;
+        }
+
+        if (args.contains ("--sessions"))
+        {
+            sessionHost.reset (new SessionHost (args));
+            return;
+        }
+
+        if (args.contains ("--headless"))
+        {
+            headlessBridge.reset (new HeadlessBridge (args));
+            return;
+        }
+
         mainWindow.reset (new MainWindow (getApplicationName()));
     }
 
@@ -32,6 +93,11 @@ public:
     {
         // Add your application's shutdown code here..
 
+        headlessBridge = nullptr;
+        sessionHost = nullptr;
+        loopbackHarness = nullptr;
+        trafficGenerator = nullptr;
+        allocationCheck = nullptr;
         mainWindow = nullptr; // (deletes our window)
     }
 
@@ -96,8 +162,71 @@ public:
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MainWindow)
     };
 
+    //==============================================================================
+    /*
+        Runs the bridge without a window, configured from the command line, e.g.
+
+          --headless --osc-in-port 3330 --osc-out 192.168.1.20:3331 --protocol native
+                     --midi-in "IAC" --midi-out "IAC" --latency-dump latency.txt --dump-interval 10
+
+        The latency report is rewritten every dump interval and on exit.
+    */
+    class HeadlessBridge    : private juce::Timer
+    {
+    public:
+        HeadlessBridge (const juce::StringArray& args)
+        {
+            // A replay run exits once the replay report has been written
+            if (args.contains ("--replay"))
+                bridge.onReplayFinished = [] { JUCEApplication::quit(); };
+
+            auto error = bridge.startHeadless (args);
+
+            if (error.isNotEmpty())
+            {
+                std::cerr << error << std::endl;
+                JUCEApplication::getInstance()->setApplicationReturnValue (1);
+                JUCEApplication::quit();
+                return;
+            }
+
+            int dumpIndex = args.indexOf ("--latency-dump");
+            if (dumpIndex >= 0 && dumpIndex + 1 < args.size())
+            {
+                latencyDumpFile = juce::File::getCurrentWorkingDirectory().getChildFile (args[dumpIndex + 1]);
+
+                int intervalIndex = args.indexOf ("--dump-interval");
+                int intervalSeconds = intervalIndex >= 0 ? args[intervalIndex + 1].getIntValue() : 10;
+                startTimer (juce::jmax (1, intervalSeconds) * 1000);
+            }
+        }
+
+        ~HeadlessBridge() override
+        {
+            stopTimer();
+            timerCallback();
+        }
+
+    private:
+        void timerCallback() override
+        {
+            if (latencyDumpFile != juce::File())
+                bridge.writeLatencyReport (latencyDumpFile);
+        }
+
+        MainComponent bridge;
+        juce::File latencyDumpFile;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (HeadlessBridge)
+    };
+
 private:
     std::unique_ptr<MainWindow> mainWindow;
+    std::unique_ptr<HeadlessBridge> headlessBridge;
+    std::unique_ptr<SessionHost> sessionHost;
+    std::unique_ptr<LoopbackHarness> loopbackHarness;
+    std::unique_ptr<TrafficGenerator> trafficGenerator;
+    std::unique_ptr<AllocationCheck> allocationCheck;
 };
 
 //==============================================================================
@@ -2,7 +2,10 @@
 #include "CCControlWindow.h"
 #include "FileBrowserWindow.h"
 #include "MixerControlWindow.h"
+#include "MidiFilterWindow.h"
 #include "CustomLookAndFeel.h"
+#include "SocketOptions.h"
+#include "SessionHost.h"
 
 //==============================================================================
 MainComponent::MainComponent()
@@ -39,6 +42,33 @@ MainComponent::MainComponent()
     addAndMakeVisible(portOutEntry);
     portOutEntry.setText("3330");
 
+    //========================================================
+    // OSC Protocol (address profile or native MIDI)
+    addAndMakeVisible(protocolLabel);
+
+    addAndMakeVisible(protocolComboBox);
+    loadProtocolProfiles();
+    protocolComboBox.onChange = [this]()
+        {
+            selectProtocol(protocolComboBox.getSelectedId());
+        };
+
+    // Route transforms start out as identity tables
+    for (auto& transform : routeTransforms)
+        transform = MidiTransform::compile({});
+
+    statsPushTimer.onTimer = [this]()
+        {
+            sendStatsSnapshot(statsPushHost, statsPushPort);
+        };
+
+    // One-shot, for MIDI input held back by a source's rate limit (message thread drain only)
+    drainRetryTimer.onTimer = [this]()
+        {
+            drainRetryTimer.stopTimer();
+            drainMidiEvents();
+        };
+
     //========================================================
     // Start/Stop Button
     addAndMakeVisible(startButton);
@@ -236,19 +266,17 @@ MainComponent::MainComponent()
         };
 
     //========================================================
-    // Register for incoming OSC messages
-    oscReceiver.addListener(this, "/ch1noteon");
-    oscReceiver.addListener(this, "/ch1noteoff");
-    oscReceiver.addListener(this, "/ch1nvalue");
-    oscReceiver.addListener(this, "/ch1cc");
-    oscReceiver.addListener(this, "/ch1ccvalue");
-    oscReceiver.addListener(this, "/ch1pitch");
-    oscReceiver.addListener(this, "/ch1pressure");
+    pendingNativeMidi.begin(OscPacket::nativeMidiAddress);
 
     //========================================================
     // Initialize MIDI devices
     updateMidiDevices();
 
+    //========================================================
+    // Room for incoming OSC MIDI, so a receive batch doesn't allocate
+    oscMidiBlock.ensureSize(oscMidiBlockBytes);
+    scheduledOscMidi.ensureSize(oscMidiBlockBytes);
+
     //========================================================
     // Automatically start the OSC server on launch
     startOSCServer();
@@ -302,9 +330,34 @@ MainComponent::~MainComponent()
     // Clean up look and feel
     hamburgerButton.setLookAndFeel(nullptr);
 
+    statsPushTimer.stopTimer();
+    drainRetryTimer.stopTimer();
+    captureReplayer.stop();
+    midiFilePlayer.stop();
+    sessionRecorder.stop();
+
+    // Let a recording finish writing while its callback can still log
+    sessionRecorder.waitForWrite(10000);
+
+    stopCapture();
     stopOSCServer();
     midiKeyboardState.removeListener(this);
 
+    // Its thread sends under midiOutputLock, so it's stopped before the lock is taken below
+    std::unique_ptr<MidiOutputScheduler> outputScheduler;
+    {
+        const juce::ScopedLock lock(midiOutputLock);
+        outputScheduler = std::move(midiOutputScheduler);
+    }
+
+    if (outputScheduler != nullptr)
+        outputScheduler->flushNotes([this](const juce::MidiMessage& message) { deliverMidiOutput(message); });
+
+    outputScheduler.reset();
+
+    if (traceFile != juce::File())
+        writeTrace(traceFile);
+
     stopTimer(); // stop ARP timer if running
 
     if (currentMidiInput)
@@ -313,6 +366,7 @@ MainComponent::~MainComponent()
         currentMidiInput.reset();
     }
 
+    const juce::ScopedLock lock(midiOutputLock);
     if (currentMidiOutput)
     {
         currentMidiOutput.reset();
@@ -322,6 +376,7 @@ MainComponent::~MainComponent()
 //------------------------------------------------------------------------------
 void MainComponent::logMessage(const juce::String& message)
 {
+    AllocationCounter::ScopedStage allocationStage(AllocationCounter::log);
     {
         juce::ScopedLock lock(logLock);
         pendingLogMessages += message + "\n";
@@ -406,6 +461,10 @@ void MainComponent::resized()
     portOutLabel.setBounds(area.removeFromTop(labelHeight));
     portOutEntry.setBounds(area.removeFromTop(entryHeight));
 
+    // OSC Protocol
+    protocolLabel.setBounds(area.removeFromTop(labelHeight));
+    protocolComboBox.setBounds(area.removeFromTop(comboBoxHeight));
+
     // Start/Stop button
     startButton.setBounds(area.removeFromTop(buttonHeight));
 
@@ -426,21 +485,211 @@ void MainComponent::resized()
     hamburgerButton.toFront(true);
 }
 
+//------------------------------------------------------------------------------
+juce::String MainComponent::startHeadless(const juce::StringArray& args)
+{
+    auto getOption = [&args](const char* name)
+        {
+            int index = args.indexOf(name);
+            return index >= 0 && index + 1 < args.size() ? args[index + 1] : juce::String();
+        };
+
+    // Picks the first combo box item whose name contains the given text
+    auto findItem = [](juce::ComboBox& comboBox, const juce::String& name)
+        {
+            for (int i = 0; i < comboBox.getNumItems(); ++i)
+                if (comboBox.getItemText(i).containsIgnoreCase(name))
+                    return comboBox.getItemId(i);
+            return 0;
+        };
+
+    auto portIn = getOption("--osc-in-port");
+    if (portIn.isNotEmpty())
+        portInEntry.setText(portIn);
+
+    auto oscOut = getOption("--osc-out");
+    if (oscOut.isNotEmpty())
+    {
+        ipOutEntry.setText(oscOut.upToLastOccurrenceOf(":", false, false));
+        portOutEntry.setText(oscOut.fromLastOccurrenceOf(":", false, false));
+    }
+
+    auto protocol = getOption("--protocol");
+    if (protocol.isNotEmpty())
+    {
+        int itemId = protocol == "native" ? nativeMidiProtocolId : findItem(protocolComboBox, protocol);
+        if (itemId == 0 || itemId == loadProfileItemId)
+            return "Unknown OSC protocol: " + protocol;
+
+        protocolComboBox.setSelectedId(itemId, juce::dontSendNotification);
+        selectProtocol(itemId);
+    }
+
+    auto midiIn = getOption("--midi-in");
+    if (midiIn.isNotEmpty())
+    {
+        int itemId = findItem(midiInputComboBox, midiIn);
+        if (itemId == 0)
+            return "No MIDI input matching: " + midiIn;
+
+        midiInputComboBox.setSelectedId(itemId, juce::dontSendNotification);
+        setMidiInput(midiInputIdentifiers[itemId - 1]);
+    }
+
+    auto midiOut = getOption("--midi-out");
+    if (midiOut.isNotEmpty())
+    {
+        int itemId = findItem(midiOutputComboBox, midiOut);
+        if (itemId == 0)
+            return "No MIDI output matching: " + midiOut;
+
+        midiOutputComboBox.setSelectedId(itemId, juce::dontSendNotification);
+        setMidiOutput(midiOutputIdentifiers[itemId - 1]);
+    }
+
+    // Kernel socket buffer sizes in bytes, for bursts the bridge can't drain as fast as they arrive
+    auto receiveBuffer = getOption("--osc-rcvbuf");
+    if (receiveBuffer.isNotEmpty())
+        oscReceiver.setReceiveBufferSize(receiveBuffer.getIntValue());
+
+    auto sendBuffer = getOption("--osc-sndbuf");
+    if (sendBuffer.isNotEmpty() && !oscSender.setSendBufferSize(sendBuffer.getIntValue()))
+        return "Couldn't set the OSC send buffer to " + sendBuffer + " bytes";
+
+    // --osc-in-group <group> receives from a multicast group, and --osc-out may name one;
+    // --multicast-if <address>, --multicast-ttl <hops> and --multicast-loopback on|off apply to both
+    auto inputGroup = getOption("--osc-in-group");
+    if (inputGroup.isNotEmpty())
+    {
+        if (!SocketOptions::isMulticastAddress(inputGroup))
+            return "Not a multicast group: " + inputGroup;
+
+        ipInEntry.setText(inputGroup);
+    }
+
+    multicastInterface = getOption("--multicast-if");
+
+    auto ttl = getOption("--multicast-ttl");
+    if (ttl.isNotEmpty())
+        multicastTtl = ttl.getIntValue();
+
+    auto loopback = getOption("--multicast-loopback");
+    if (loopback.isNotEmpty())
+        multicastLoopback = loopback != "off";
+
+    startOSCServer();
+    startButton.setButtonText("Stop");
+
+    auto captureFile = getOption("--capture");
+    if (captureFile.isNotEmpty() && !startCapture(juce::File::getCurrentWorkingDirectory().getChildFile(captureFile)))
+        return "Couldn't open capture file: " + captureFile;
+
+    // --replay <file> [--replay-speed <factor>|max] [--replay-report <file>]
+    auto replay = getOption("--replay");
+    if (replay.isNotEmpty())
+    {
+        auto speed = getOption("--replay-speed");
+        auto report = getOption("--replay-report");
+
+        if (report.isNotEmpty())
+            replayReportFile = juce::File::getCurrentWorkingDirectory().getChildFile(report);
+
+        if (!startReplay(juce::File::getCurrentWorkingDirectory().getChildFile(replay),
+                         speed == "max" ? 0.0 : speed.isNotEmpty() ? speed.getDoubleValue() : 1.0))
+            return "Couldn't replay " + replay;
+    }
+
+    auto trace = getOption("--trace");
+    if (trace.isNotEmpty())
+    {
+        traceFile = juce::File::getCurrentWorkingDirectory().getChildFile(trace);
+        PipelineTrace::start();
+    }
+
+    // --jitter-buffer <max delay ms>
+    auto jitterMaxDelay = getOption("--jitter-buffer");
+    if (jitterMaxDelay.isNotEmpty())
+        setJitterBuffer(true, jitterMaxDelay.getIntValue());
+
+    // --midi-out-rate <bytes/s>|din paces the MIDI output to its wire
+    auto midiOutRate = getOption("--midi-out-rate");
+    if (midiOutRate.isNotEmpty())
+        setMidiOutputPacing(midiOutRate == "din" ? MidiOutputScheduler::dinBytesPerSecond : midiOutRate.getIntValue());
+
+    // --source-rate <events/s> caps each source on both routes; --source-weights <source>=<weight>,...
+    auto sourceRate = getOption("--source-rate");
+    auto sourceWeights = getOption("--source-weights");
+    if (sourceRate.isNotEmpty() || sourceWeights.isNotEmpty())
+    {
+        auto error = setSourceFairness(sourceRate.getIntValue(), sourceWeights);
+        if (error.isNotEmpty())
+            return error;
+    }
+
+    statsAllowRedirect = args.contains("--stats-allow-redirect");
+
+    auto statsInterval = getOption("--stats-interval");
+    if (statsInterval.isNotEmpty())
+        setStatsPush(statsInterval.getIntValue(), oscDestination.host, oscDestination.port);
+
+    if (!oscConnected)
+        return "Couldn't start OSC to " + ipOutEntry.getText() + ":" + portOutEntry.getText();
+
+    return {};
+}
+
+//------------------------------------------------------------------------------
+bool MainComponent::writeLatencyReport(const juce::File& file) const
+{
+    auto report = juce::Time::getCurrentTime().toISO8601(true) + "\n\n" + latencyMonitor.getReport();
+
+    if (midiOutputScheduler != nullptr)
+        report << "\n" << midiOutputScheduler->getReport();
+
+    return file.replaceWithText(report);
+}
+
 //------------------------------------------------------------------------------
 void MainComponent::startOSCServer()
 {
+    const juce::ScopedLock outputLock(oscOutputLock);
     oscConnected = false;
 
+    oscDestination.host = ipOutEntry.getText();
+    oscDestination.port = portOutEntry.getText().getIntValue();
+
+    auto interfaceName = multicastInterface.isNotEmpty() ? multicastInterface : juce::String("the default interface");
+
+    // A multicast group as the OSC In address is joined; otherwise the receiver takes unicast on all interfaces
+    auto inputGroup = ipInEntry.getText().trim();
+    bool multicastInput = SocketOptions::isMulticastAddress(inputGroup);
+    oscReceiver.setMulticastGroup(multicastInput ? inputGroup : juce::String(), multicastInterface);
+
     // Try to connect the OSC receiver
     if (oscReceiver.connect(portInEntry.getText().getIntValue()))
-        logMessage("OSC receiver connected on port " + portInEntry.getText());
+        logMessage("OSC receiver connected on port " + portInEntry.getText()
+            + (multicastInput ? " in multicast group " + inputGroup + " on " + interfaceName : juce::String())
+            + " (receive buffer " + juce::String(oscReceiver.getReceiveBufferSize()) + " bytes)");
     else
-        logMessage("Failed to connect OSC receiver on port " + portInEntry.getText());
+        logMessage("Failed to connect OSC receiver on port " + portInEntry.getText()
+            + (multicastInput ? " in multicast group " + inputGroup + " on " + interfaceName : juce::String()));
+
+    bridgeStats.setSocketBufferSizes(oscReceiver.getReceiveBufferSize(), oscSender.getSendBufferSize());
 
-    // Connect the OSC sender
-    if (oscSender.connect(ipOutEntry.getText(), portOutEntry.getText().getIntValue()))
+    // A group is just another destination once the socket knows how to send to it
+    bool multicastOutput = SocketOptions::isMulticastAddress(oscDestination.host);
+    if (multicastOutput && !oscSender.setMulticastOptions(multicastInterface, multicastTtl, multicastLoopback))
     {
-        logMessage("OSC sender connected to " + ipOutEntry.getText() + ":" + portOutEntry.getText());
+        logMessage("Failed to set up multicast output to " + oscDestination.host + " on " + interfaceName
+            + " (TTL " + juce::String(multicastTtl) + ")");
+    }
+    // Outgoing packets are written straight to the destination, so just validate (and resolve) it
+    else if (oscSender.setDestination(oscDestination.host, oscDestination.port))
+    {
+        logMessage("OSC output to " + ipOutEntry.getText() + ":" + portOutEntry.getText()
+            + (multicastOutput ? " (multicast on " + interfaceName + ", TTL " + juce::String(multicastTtl)
+                                 + (multicastLoopback ? ", looped back to this host)" : ")")
+                               : juce::String()));
         oscConnected = true;
     }
     else
@@ -452,8 +701,9 @@ void MainComponent::startOSCServer()
 //------------------------------------------------------------------------------
 void MainComponent::stopOSCServer()
 {
+    const juce::ScopedLock outputLock(oscOutputLock);
+    flushNativeMidi();
     oscReceiver.disconnect();
-    oscSender.disconnect();
     oscConnected = false;
     logMessage("OSC server stopped.");
 }
@@ -508,9 +758,18 @@ void MainComponent::setMidiInput(const juce::String& identifier)
         logMessage("MIDI Input stopped.");
     }
 
+    // The callback reads currentMidiInputFilter, so it must be in place before the device starts
+    auto& filter = midiInputFilters[identifier];
+    if (filter == nullptr)
+        filter = std::make_unique<MidiInputFilter>();
+
+    currentMidiInputFilter = filter.get();
+    currentMidiInputName = identifier;
+
     currentMidiInput = juce::MidiInput::openDevice(identifier, this);
     if (currentMidiInput)
     {
+        currentMidiInputName = currentMidiInput->getName();
         currentMidiInput->start();
         logMessage("MIDI Input set: " + identifier);
     }
@@ -518,20 +777,32 @@ void MainComponent::setMidiInput(const juce::String& identifier)
     {
         logMessage("Failed to set MIDI Input: " + identifier);
     }
+
+    if (midiFilterWindow)
+        midiFilterWindow->setFilter(currentMidiInput ? currentMidiInputFilter : nullptr, currentMidiInputName);
 }
 
 //------------------------------------------------------------------------------
 void MainComponent::setMidiOutput(const juce::String& identifier)
 {
+    // The OSC receiver thread may be sending to the old device
+    const juce::ScopedLock lock(midiOutputLock);
+
     if (currentMidiOutput)
     {
         currentMidiOutput.reset();
         logMessage("MIDI Output stopped.");
     }
 
+    // Whatever was waiting for the old port's wire is dropped
+    if (midiOutputScheduler != nullptr)
+        midiOutputScheduler->clear();
+
     currentMidiOutput = juce::MidiOutput::openDevice(identifier);
     if (currentMidiOutput)
     {
+        // Plays out time-tagged OSC bundles scheduled with sendBlockOfMessages
+        currentMidiOutput->startBackgroundThread();
         logMessage("MIDI Output set: " + identifier);
     }
     else
@@ -540,6 +811,109 @@ void MainComponent::setMidiOutput(const juce::String& identifier)
     }
 }
 
+//------------------------------------------------------------------------------
+void MainComponent::setMidiOutputStandIn(std::function<void(const juce::MidiMessage&)> standIn)
+{
+    const juce::ScopedLock lock(midiOutputLock);
+    midiOutputStandIn = std::move(standIn);
+}
+
+//------------------------------------------------------------------------------
+void MainComponent::sendMidiOutput(const juce::MidiMessage& message)
+{
+    AllocationCounter::ScopedStage allocationStage(AllocationCounter::send);
+    PipelineTrace::ScopedSpan span("midi send");
+    const juce::ScopedLock lock(midiOutputLock);
+
+    if (midiOutputScheduler == nullptr)
+        deliverMidiOutput(message);
+    else if (!midiOutputScheduler->push(message))
+        bridgeStats.countDrop(BridgeStats::outputLane);
+}
+
+void MainComponent::deliverMidiOutput(const juce::MidiMessage& message)
+{
+    const juce::ScopedLock lock(midiOutputLock);
+
+    if (midiOutputStandIn)
+        midiOutputStandIn(message);
+    else if (currentMidiOutput)
+        currentMidiOutput->sendMessageNow(message);
+}
+
+//------------------------------------------------------------------------------
+// Sends a block in one call: now, or if startMillisecondCounter is set, with each event's
+// sample position taken as milliseconds after it (timed by the device's background thread,
+// or by the scheduler when the port is paced).
+void MainComponent::sendMidiOutputBlock(const juce::MidiBuffer& block, juce::uint32 startMillisecondCounter)
+{
+    AllocationCounter::ScopedStage allocationStage(AllocationCounter::send);
+    PipelineTrace::ScopedSpan span("midi send");
+    const juce::ScopedLock lock(midiOutputLock);
+
+    if (midiOutputScheduler != nullptr)
+    {
+        juce::int64 startTime = 0;
+        if (startMillisecondCounter != 0)
+        {
+            auto startOffsetMs = static_cast<juce::int32>(startMillisecondCounter - juce::Time::getMillisecondCounter());
+            startTime = LatencyMonitor::now() + static_cast<juce::int64>(startOffsetMs) * 1000000;
+        }
+
+        for (const auto metadata : block)
+        {
+            auto dueTime = startTime != 0 ? startTime + static_cast<juce::int64>(metadata.samplePosition) * 1000000 : 0;
+            if (!midiOutputScheduler->push(metadata.getMessage(), dueTime))
+                bridgeStats.countDrop(BridgeStats::outputLane);
+        }
+    }
+    else if (midiOutputStandIn)
+    {
+        for (const auto metadata : block)
+            midiOutputStandIn(metadata.getMessage());
+    }
+    else if (currentMidiOutput && startMillisecondCounter != 0)
+    {
+        currentMidiOutput->sendBlockOfMessages(block, startMillisecondCounter, 1000.0);
+    }
+    else if (currentMidiOutput)
+    {
+        currentMidiOutput->sendBlockOfMessagesNow(block);
+    }
+}
+
+//------------------------------------------------------------------------------
+void MainComponent::setMidiOutputPacing(int bytesPerSecond)
+{
+    std::unique_ptr<MidiOutputScheduler> oldScheduler;
+    {
+        const juce::ScopedLock lock(midiOutputLock);
+        oldScheduler = std::move(midiOutputScheduler);
+
+        if (bytesPerSecond > 0)
+            midiOutputScheduler = std::make_unique<MidiOutputScheduler>([this](const juce::MidiMessage& message)
+                {
+                    deliverMidiOutput(message);
+                }, bytesPerSecond);
+    }
+
+    // Stopped with the lock released. Queued notes go straight out, so none is left hanging;
+    // controllers it still had queued are dropped.
+    if (oldScheduler != nullptr)
+    {
+        oldScheduler->flushNotes([this](const juce::MidiMessage& message) { deliverMidiOutput(message); });
+
+        for (auto& line : juce::StringArray::fromLines(oldScheduler->getReport()))
+            if (line.isNotEmpty())
+                logMessage(line);
+
+        oldScheduler.reset();
+    }
+
+    logMessage(bytesPerSecond > 0 ? "MIDI output paced to " + juce::String(bytesPerSecond) + " bytes/s"
+                                  : juce::String("MIDI output pacing off"));
+}
+
 //------------------------------------------------------------------------------
 void MainComponent::sendOSCMessage(int midiNote, bool noteOn)
 {
@@ -547,54 +921,212 @@ void MainComponent::sendOSCMessage(int midiNote, bool noteOn)
         return;
 
     midiNote = juce::jlimit(0, 127, midiNote);
-    juce::String address = "/ch" + juce::String(currentOSCChannel) + (noteOn ? "note" : "noteoff");
-    oscSender.send(juce::OSCMessage(address, midiNote));
 
-    juce::Logger::writeToLog("OSC Sent: " + address + " " + juce::String(midiNote));
+    if (isNativeMidiDestination())
+    {
+        // No velocity here; note-ons with a velocity go through sendOSCNoteOn()
+        sendNativeMidi((noteOn ? 0x90 : 0x80) | (currentOSCChannel - 1), midiNote, noteOn ? 127 : 0);
+        return;
+    }
+
+    sendOSCEvent(noteOn ? ProtocolProfile::EventType::NoteOn : ProtocolProfile::EventType::NoteOff,
+                 currentOSCChannel, midiNote, noteOn ? 127 : 0);
+
+    juce::Logger::writeToLog("OSC Sent: " + juce::String(noteOn ? "Note On " : "Note Off ") + juce::String(midiNote));
 }
 
 //------------------------------------------------------------------------------
-void MainComponent::sendVelocityMessage(int midiNote, float velocity)
+void MainComponent::sendOSCNoteOn(int midiNote, int velocity)
 {
     if (!oscConnected)
         return;
 
     midiNote = juce::jlimit(0, 127, midiNote);
-    juce::String address = "/ch" + juce::String(currentOSCChannel) + "nvalue";
-    oscSender.send(juce::OSCMessage(address, midiNote, velocity));
+    int midiVelocity = juce::jlimit(1, 127, velocity);
+
+    if (isNativeMidiDestination())
+    {
+        sendNativeMidi(0x90 | (currentOSCChannel - 1), midiNote, midiVelocity);
+        return;
+    }
+
+    sendOSCEvent(ProtocolProfile::EventType::NoteOn, currentOSCChannel, midiNote, midiVelocity);
+
+    logMessage("Sent OSC note " + juce::String(midiNote) + " velocity = " + juce::String(velocity));
+}
+
+//------------------------------------------------------------------------------
+void MainComponent::sendOSCEvent(ProtocolProfile::EventType type, int channel, int number, int value)
+{
+    AllocationCounter::ScopedStage allocationStage(AllocationCounter::encode);
+    PipelineTrace::ScopedSpan span("encode");
+    if (!oscConnected || oscDestination.profile == nullptr)
+        return;
+
+    ProtocolProfile::Event event;
+    event.type = type;
+    event.channel = channel;
+    event.number = number;
+    event.value = value;
+
+    auto startTime = LatencyMonitor::now();
+    auto writeTimeBefore = socketWriteTime;
+
+    oscDestination.profile->encode(event, [this](const char* data, int size)
+        {
+            sendOSCPacket(data, size);
+        });
+
+    latencyMonitor.record(TransformWindow::midiToOsc, LatencyMonitor::encode,
+                          LatencyMonitor::now() - startTime - (socketWriteTime - writeTimeBefore));
+}
+
+//------------------------------------------------------------------------------
+void MainComponent::sendOSCPacket(const char* data, int size)
+{
+    AllocationCounter::ScopedStage allocationStage(AllocationCounter::send);
+    const juce::ScopedLock outputLock(oscOutputLock);
+
+    // During a drain pass packets are only copied aside, and go out together in flushOSCOutput()
+    if (batchingOscOutput)
+    {
+        oscSender.queue(data, size);
+        return;
+    }
+
+    PipelineTrace::ScopedSpan span("socket send");
+    auto startTime = LatencyMonitor::now();
+    auto result = oscSender.send(data, size);
+    auto elapsed = LatencyMonitor::now() - startTime;
+
+    latencyMonitor.record(TransformWindow::midiToOsc, LatencyMonitor::send, elapsed);
+    socketWriteTime += elapsed;
+
+    bridgeStats.countPacketsSent(result.packets, result.bytes, result.calls);
+
+    if (result.failed > 0)
+    {
+        bridgeStats.countSendError(result.failed);
+        logMessage("Failed to send OSC packet to " + oscDestination.host + ":" + juce::String(oscDestination.port));
+    }
+}
+
+//------------------------------------------------------------------------------
+void MainComponent::flushOSCOutput()
+{
+    const juce::ScopedLock outputLock(oscOutputLock);
+    flushNativeMidi();
+
+    AllocationCounter::ScopedStage allocationStage(AllocationCounter::send);
+    if (oscSender.getNumQueued() == 0)
+        return;
+
+    PipelineTrace::ScopedSpan span("socket send");
+    auto startTime = LatencyMonitor::now();
+    auto result = oscSender.flush();
+    auto elapsed = LatencyMonitor::now() - startTime;
+
+    latencyMonitor.record(TransformWindow::midiToOsc, LatencyMonitor::send, elapsed);
+    socketWriteTime += elapsed;
+
+    bridgeStats.countPacketsSent(result.packets, result.bytes, result.calls);
+
+    if (result.failed > 0)
+    {
+        bridgeStats.countSendError(result.failed);
+        logMessage("Failed to send " + juce::String(result.failed) + " OSC packets to "
+            + oscDestination.host + ":" + juce::String(oscDestination.port));
+    }
+}
+
+//------------------------------------------------------------------------------
+bool MainComponent::isNativeMidiDestination() const noexcept
+{
+    return oscDestination.format == OscDestination::Format::MidiMessage;
+}
+
+//------------------------------------------------------------------------------
+void MainComponent::sendNativeMidi(int status, int data1, int data2)
+{
+    AllocationCounter::ScopedStage allocationStage(AllocationCounter::encode);
+    PipelineTrace::ScopedSpan span("encode");
+    const juce::ScopedLock outputLock(oscOutputLock);
+    auto add = [&]
+        {
+            return pendingNativeMidi.addMidi(0,
+                                             static_cast<juce::uint8>(status),
+                                             static_cast<juce::uint8>(data1 & 0x7f),
+                                             static_cast<juce::uint8>(data2 & 0x7f));
+        };
+
+    auto startTime = LatencyMonitor::now();
+    auto writeTimeBefore = socketWriteTime;
+
+    // A full message goes out straight away and packing starts again in a fresh one
+    if (!add())
+    {
+        flushNativeMidi();
+        add();
+    }
+
+    latencyMonitor.record(TransformWindow::midiToOsc, LatencyMonitor::encode,
+                          LatencyMonitor::now() - startTime - (socketWriteTime - writeTimeBefore));
+
+    if (!batchingOscOutput)
+        flushNativeMidi();
+}
+
+//------------------------------------------------------------------------------
+void MainComponent::flushNativeMidi()
+{
+    AllocationCounter::ScopedStage allocationStage(AllocationCounter::encode);
+    PipelineTrace::ScopedSpan span("encode");
+    const juce::ScopedLock outputLock(oscOutputLock);
+    if (pendingNativeMidi.isEmpty())
+        return;
+
+    char packet[OscPacket::maxPacketSize];
+    int size = pendingNativeMidi.write(packet, sizeof(packet));
+    int numEvents = pendingNativeMidi.getNumArguments();
+    pendingNativeMidi.begin(OscPacket::nativeMidiAddress);
 
-    logMessage("Sent OSC velocity for note " + juce::String(midiNote) + " = " + juce::String(velocity));
+    if (!oscConnected || size <= 0)
+        return;
+
+    sendOSCPacket(packet, size);
+
+    AllocationCounter::ScopedStage logStage(AllocationCounter::log);
+    juce::Logger::writeToLog("OSC Sent: " + juce::String(OscPacket::nativeMidiAddress)
+            + " (" + juce::String(numEvents) + " MIDI events, " + juce::String(size) + " bytes)");
 }
 
 //------------------------------------------------------------------------------
-void MainComponent::sendCCMessage(int channel, int ccNumber, int ccValue)
+void MainComponent::sendCCMessage(int channel, int ccNumber, int ccValue, bool toMidiOutput)
 {
     channel = juce::jlimit(1, 16, channel);
     ccNumber = juce::jlimit(0, 127, ccNumber);
     ccValue = juce::jlimit(0, 127, ccValue);
 
     // MIDI CC
-    if (currentMidiOutput)
-        currentMidiOutput->sendMessageNow(juce::MidiMessage::controllerEvent(channel, ccNumber, ccValue));
+    if (toMidiOutput)
+        sendMidiOutput(juce::MidiMessage::controllerEvent(channel, ccNumber, ccValue));
 
-    // OSC: /chXcc & /chXccvalue
-    if (oscConnected)
+    // OSC: /chXcc & /chXccvalue, or a single 'm' argument
+    if (oscConnected && isNativeMidiDestination())
     {
-        juce::String ccAddr = "/ch" + juce::String(channel) + "cc";
-        juce::String ccValueAddr = "/ch" + juce::String(channel) + "ccvalue";
-
-        oscSender.send(juce::OSCMessage(ccAddr, ccNumber));
-
-        float normalizedVal = static_cast<float>(ccValue) / 127.0f;
-        oscSender.send(juce::OSCMessage(ccValueAddr, normalizedVal));
+        sendNativeMidi(0xb0 | (channel - 1), ccNumber, ccValue);
+    }
+    else if (oscConnected)
+    {
+        sendOSCEvent(ProtocolProfile::EventType::ControlChange, channel, ccNumber, ccValue);
 
         logMessage("Sent OSC CC channel " + juce::String(channel) + ": CC#" + juce::String(ccNumber)
-            + " Value: " + juce::String(normalizedVal));
+            + " Value: " + juce::String(ccValue));
     }
 }
 
 //------------------------------------------------------------------------------
-void MainComponent::sendPitchBendMessage(int channel, float pitchValue)
+void MainComponent::sendPitchBendMessage(int channel, float pitchValue, bool toMidiOutput)
 {
     channel = juce::jlimit(1, 16, channel);
     pitchValue = juce::jlimit(0.0f, 1.0f, pitchValue);
@@ -603,42 +1135,43 @@ void MainComponent::sendPitchBendMessage(int channel, float pitchValue)
     int midiPB = static_cast<int>(pitchValue * 16383.0f + 0.5f);
     midiPB = juce::jlimit(0, 16383, midiPB);
 
-    // Convert to float range [-8400..+8400] for OSC
-    float oscPitchBend = ((static_cast<float>(midiPB) / 16383.0f) * 2.0f - 1.0f) * 8400.0f;
-
     // Send MIDI pitch bend
-    if (currentMidiOutput)
-    {
-        juce::MidiMessage pitchMsg = juce::MidiMessage::pitchWheel(channel, midiPB);
-        currentMidiOutput->sendMessageNow(pitchMsg);
-    }
+    if (toMidiOutput)
+        sendMidiOutput(juce::MidiMessage::pitchWheel(channel, midiPB));
 
     // Send OSC
-    if (oscConnected)
+    if (oscConnected && isNativeMidiDestination())
+    {
+        sendNativeMidi(0xe0 | (channel - 1), midiPB & 0x7f, midiPB >> 7);
+    }
+    else if (oscConnected)
     {
-        juce::String pitchAddress = "/ch" + juce::String(channel) + "pitch";
-        oscSender.send(juce::OSCMessage(pitchAddress, oscPitchBend));
+        // The profile scales 0..16383 to its own range (Patchworld: -8400..+8400)
+        sendOSCEvent(ProtocolProfile::EventType::PitchBend, channel, 0, midiPB);
 
         logMessage("Sent OSC Pitch Bend on channel " + juce::String(channel)
-            + ": " + juce::String(oscPitchBend));
+            + ": " + juce::String(midiPB));
     }
 }
 
 //------------------------------------------------------------------------------
-void MainComponent::sendAftertouchMessage(int channel, int pressureValue)
+void MainComponent::sendAftertouchMessage(int channel, int pressureValue, bool toMidiOutput)
 {
     channel = juce::jlimit(1, 16, channel);
     pressureValue = juce::jlimit(0, 127, pressureValue);
 
     // MIDI aftertouch
-    if (currentMidiOutput)
-        currentMidiOutput->sendMessageNow(juce::MidiMessage::channelPressureChange(channel, pressureValue));
+    if (toMidiOutput)
+        sendMidiOutput(juce::MidiMessage::channelPressureChange(channel, pressureValue));
 
     // OSC
-    if (oscConnected)
+    if (oscConnected && isNativeMidiDestination())
     {
-        juce::String pressureAddress = "/ch" + juce::String(channel) + "pressure";
-        oscSender.send(juce::OSCMessage(pressureAddress, pressureValue));
+        sendNativeMidi(0xd0 | (channel - 1), pressureValue, 0);
+    }
+    else if (oscConnected)
+    {
+        sendOSCEvent(ProtocolProfile::EventType::ChannelPressure, channel, 0, pressureValue);
 
         logMessage("Sent OSC Channel Pressure on channel " + juce::String(channel)
             + ": " + juce::String(pressureValue));
@@ -646,81 +1179,841 @@ void MainComponent::sendAftertouchMessage(int channel, int pressureValue)
 }
 
 //------------------------------------------------------------------------------
-void MainComponent::oscMessageReceived(const juce::OSCMessage& message)
+// Called on the OSC receiver thread for every datagram.
+void MainComponent::oscPacketReceived(const char* data, int size, juce::int64 receiveTime)
 {
-    handleIncomingOSCMessage(message);
+    bridgeStats.countPacketReceived();
+    captureRecorder.record(SessionCapture::Source::oscMessage, data, size, receiveTime);
 }
 
 //------------------------------------------------------------------------------
-void MainComponent::handleIncomingOSCMessage(const juce::OSCMessage& message)
+// Called on the OSC receiver thread around each batch of datagrams. The batch's messages
+// (a whole bundle, or several) are decoded into oscMidiBlock, which goes out in one send
+// when the batch finishes. oscInputLock is held throughout.
+void MainComponent::oscBatchStarted(juce::int64 receiveTime)
+{
+    oscInputLock.enter();
+
+    oscBatchReceiveTime = receiveTime;
+    oscBatchUnixMillis = juce::Time::currentTimeMillis();
+    oscBatchMillisecondCounter = juce::Time::getMillisecondCounter();
+    oscBatchMessages = 0;
+}
+
+int MainComponent::oscBatchFinished()
 {
-    logMessage("OSC Received: " + message.getAddressPattern().toString());
-    // Currently no direct ARP logic from incoming OSC
+    auto holdTimeMs = flushOSCMidi();
+    oscInputLock.exit();
+    return holdTimeMs;
 }
 
 //------------------------------------------------------------------------------
-void MainComponent::handleNoteOn(juce::MidiKeyboardState*, int /*midiChannel*/, int midiNoteNumber, float velocity)
+// Called on the OSC receiver thread for each message, bundles already unpacked.
+// MIDI is decoded and sent from here, so it never waits for the message thread;
+// only stats requests, which reply and start timers, are queued for it.
+void MainComponent::oscMessageReceived(OscMessageReader& message, OscReceiver::SourceId source,
+                                       juce::uint64 timeTag, juce::int64 receiveTime)
 {
-    {
-        juce::ScopedLock lock(queueLock);
-        MidiEvent event;
-        event.type = MidiEvent::Type::NoteOn;
-        event.channel = currentOSCChannel;
-        event.parameter = midiNoteNumber;
-        event.value = velocity;
-        midiEventsQueue.add(event);
-    }
-    triggerAsyncUpdate();
-    logMessage("Keyboard Note On: " + juce::String(midiNoteNumber)
-        + " Velocity: " + juce::String(velocity));
+    AllocationCounter::ScopedStage allocationStage(AllocationCounter::oscInput);
+    PipelineTrace::ScopedSpan span("osc receive");
+
+    if (std::strncmp(message.getAddress(), BridgeStats::queryAddress, std::strlen(BridgeStats::queryAddress)) == 0)
+        queueOSCMessage(message, source, receiveTime);
+    else if (std::strchr(message.getTypeTags(), 'm') != nullptr)
+        handleNativeMidiMessage(message, source, timeTag);
+    else
+        handleIncomingOSCMessage(message, source, timeTag);
 }
 
 //------------------------------------------------------------------------------
-void MainComponent::handleNoteOff(juce::MidiKeyboardState*, int /*midiChannel*/, int midiNoteNumber, float /*velocity*/)
+void MainComponent::oscPacketMalformed(const char* /*data*/, int size)
 {
-    {
-        juce::ScopedLock lock(queueLock);
-        MidiEvent event;
-        event.type = MidiEvent::Type::NoteOff;
-        event.channel = currentOSCChannel;
-        event.parameter = midiNoteNumber;
-        event.value = 0.0f;
-        midiEventsQueue.add(event);
-    }
-    triggerAsyncUpdate();
-    logMessage("Keyboard Note Off: " + juce::String(midiNoteNumber));
+    bridgeStats.countDrop(BridgeStats::malformedPacket);
+    logMessage("Dropped malformed OSC packet (" + juce::String(size) + " bytes)");
 }
 
 //------------------------------------------------------------------------------
-void MainComponent::handleIncomingMidiMessage(juce::MidiInput*, const juce::MidiMessage& message)
+// Called on the OSC receiver thread each time the kernel's receive queue counters are read.
+void MainComponent::oscReceiveQueueRead(juce::uint32 newDrops, int queuedBytes)
 {
-    if (message.isNoteOn())
+    bridgeStats.updateQueueSize(BridgeStats::oscReceiveBuffer, queuedBytes);
+
+    if (newDrops == 0)
+        return;
+
+    bridgeStats.countDrop(BridgeStats::kernelReceive, newDrops);
+    logMessage("Kernel dropped " + juce::String(newDrops) + " OSC packets: receive buffer full ("
+        + juce::String(oscReceiver.getReceiveBufferSize()) + " bytes)");
+}
+
+//------------------------------------------------------------------------------
+// Copies a message into oscMessageFifo (receiver thread). Messages that don't fit are dropped.
+void MainComponent::queueOSCMessage(const OscMessageReader& message, OscReceiver::SourceId source, juce::int64 receiveTime)
+{
+    char record[sizeof(OscMessageRecord) + OscReceiver::maxDatagramSize];
+
+    OscMessageRecord header;
+    header.receiveTime = receiveTime;
+    header.source = source;
+    header.size = message.getSize();
+
+    auto recordSize = static_cast<int>(sizeof(header)) + header.size;
+    if (oscMessageFifo.getFreeSpace() < recordSize)
     {
-        midiKeyboardState.noteOn(message.getChannel(), message.getNoteNumber(), message.getFloatVelocity());
+        bridgeStats.countDrop(BridgeStats::queueFull);
+        return;
+    }
+
+    std::memcpy(record, &header, sizeof(header));
+    std::memcpy(record + sizeof(header), message.getData(), static_cast<size_t>(header.size));
+
+    int start1, size1, start2, size2;
+    oscMessageFifo.prepareToWrite(recordSize, start1, size1, start2, size2);
+    std::memcpy(oscMessageBuffer + start1, record, static_cast<size_t>(size1));
+    std::memcpy(oscMessageBuffer + start2, record + size1, static_cast<size_t>(size2));
+    oscMessageFifo.finishedWrite(size1 + size2);
+
+    bridgeStats.updateQueueSize(BridgeStats::oscMessageQueue, oscMessageFifo.getNumReady());
+    triggerAsyncUpdate();
+}
+
+//------------------------------------------------------------------------------
+// Handles everything in oscMessageFifo (message thread). Each message is parsed
+// in place from a stack copy.
+void MainComponent::drainOSCMessages()
+{
+    char record[sizeof(OscMessageRecord) + OscReceiver::maxDatagramSize];
+
+    // Copies the next size bytes out of the FIFO without consuming them
+    auto peek = [this, &record](int size)
         {
-            juce::ScopedLock lock(queueLock);
-            MidiEvent event;
-            event.type = MidiEvent::Type::NoteOn;
-            event.channel = message.getChannel();
-            event.parameter = message.getNoteNumber();
-            event.value = message.getFloatVelocity();
-            midiEventsQueue.add(event);
+            int start1, size1, start2, size2;
+            oscMessageFifo.prepareToRead(size, start1, size1, start2, size2);
+            std::memcpy(record, oscMessageBuffer + start1, static_cast<size_t>(size1));
+            std::memcpy(record + size1, oscMessageBuffer + start2, static_cast<size_t>(size2));
+        };
+
+    while (oscMessageFifo.getNumReady() >= static_cast<int>(sizeof(OscMessageRecord)))
+    {
+        OscMessageRecord header;
+        peek(static_cast<int>(sizeof(header)));
+        std::memcpy(&header, record, sizeof(header));
+
+        auto recordSize = static_cast<int>(sizeof(header)) + header.size;
+        peek(recordSize);
+        oscMessageFifo.finishedRead(recordSize);
+
+        OscMessageReader message;
+        if (message.parse(record + sizeof(header), header.size))
+            handleStatsRequest(message, header.source);
+    }
+}
+
+//------------------------------------------------------------------------------
+// Decodes a message with the active profile and forwards it (receiver thread, in a batch).
+void MainComponent::handleIncomingOSCMessage(OscMessageReader& message, OscReceiver::SourceId source, juce::uint64 timeTag)
+{
+    AllocationCounter::ScopedStage allocationStage(AllocationCounter::oscInput);
+    PipelineTrace::ScopedSpan span("osc input");
+
+    auto* address = message.getAddress();
+    if (oscBatchMessages++ == 0)
+        std::strncpy(oscBatchAddress, address, sizeof(oscBatchAddress) - 1);
+
+    if (oscDestination.profile == nullptr)
+        return;
+
+    float arguments[ProtocolProfile::maxArguments];
+    int numArguments = ProtocolProfile::readArguments(message, arguments);
+
+    auto decodeTime = LatencyMonitor::now();
+    ProtocolProfile::Event event;
+    bool decoded = oscDestination.profile->decode(address, arguments, numArguments, oscDecoderState, event);
+    latencyMonitor.recordSince(TransformWindow::oscToMidi, LatencyMonitor::encode, decodeTime);
+
+    if (!decoded)
+    {
+        // Not decoding is normal for messages that only latch part of an event
+        if (!oscDestination.profile->acceptsAddress(address))
+            bridgeStats.countDrop(BridgeStats::unknownAddress);
+        return;
+    }
+
+    switch (event.type)
+    {
+    case ProtocolProfile::EventType::NoteOn:
+        forwardOSCMidi(juce::MidiMessage::noteOn(event.channel, event.number, static_cast<juce::uint8>(event.value)), source, timeTag);
+        break;
+
+    case ProtocolProfile::EventType::NoteOff:
+        forwardOSCMidi(juce::MidiMessage::noteOff(event.channel, event.number, static_cast<juce::uint8>(event.value)), source, timeTag);
+        break;
+
+    case ProtocolProfile::EventType::ControlChange:
+        forwardOSCMidi(juce::MidiMessage::controllerEvent(event.channel, event.number, event.value), source, timeTag);
+        break;
+
+    case ProtocolProfile::EventType::PitchBend:
+        forwardOSCMidi(juce::MidiMessage::pitchWheel(event.channel, event.value), source, timeTag);
+        break;
+
+    case ProtocolProfile::EventType::ChannelPressure:
+        forwardOSCMidi(juce::MidiMessage::channelPressureChange(event.channel, event.value), source, timeTag);
+        break;
+    }
+}
+
+//------------------------------------------------------------------------------
+void MainComponent::handleStatsRequest(OscMessageReader& message, OscReceiver::SourceId source)
+{
+    juce::String address(message.getAddress());
+
+    // Replies go to the OSC destination unless the request names a host and port
+    juce::String host = oscDestination.host;
+    int port = oscDestination.port;
+    juce::int32 intervalSeconds = 0;
+
+    // Push takes the interval first
+    if (address == BridgeStats::pushAddress && message.getNextType() == 'i')
+        message.readInt32(intervalSeconds);
+
+    const char* requestedHost = nullptr;
+    juce::int32 requestedPort = 0;
+    if (message.readString(requestedHost) && message.readInt32(requestedPort))
+    {
+        // Anyone can send a request, so unless redirects are allowed the named target has to
+        // be the requester itself or the OSC destination; otherwise the bridge would reflect
+        // (and amplify) traffic onto third parties
+        juce::IPAddress requestedAddress(requestedHost);
+        auto requestedSource = OscReceiver::makeSourceId(juce::ByteOrder::makeInt(requestedAddress.address[3], requestedAddress.address[2],
+                                                                                 requestedAddress.address[1], requestedAddress.address[0]),
+                                                         requestedPort);
+        bool isRequester = source != 0 && !requestedAddress.isNull() && requestedSource == source;
+        bool isDestination = juce::String(requestedHost) == oscDestination.host && requestedPort == oscDestination.port;
+
+        if (!statsAllowRedirect && !isRequester && !isDestination)
+        {
+            logMessage("Refused stats reply to " + juce::String(requestedHost) + ":" + juce::String(requestedPort)
+                + " requested by " + OscReceiver::sourceToString(source) + " (see --stats-allow-redirect)");
+            return;
         }
-        triggerAsyncUpdate();
+
+        host = requestedHost;
+        port = requestedPort;
     }
-    else if (message.isNoteOff())
+
+    if (address == BridgeStats::queryAddress)
     {
-        midiKeyboardState.noteOff(message.getChannel(), message.getNoteNumber(), 0.0f);
+        sendStatsSnapshot(host, port);
+    }
+    else if (address == BridgeStats::pushAddress)
+    {
+        setStatsPush(intervalSeconds, host, port);
+    }
+    else if (address == BridgeStats::resetAddress)
+    {
+        bridgeStats.reset();
+        latencyMonitor.reset();
+        logMessage("Bridge stats reset");
+    }
+}
+
+//------------------------------------------------------------------------------
+void MainComponent::setStatsPush(int intervalSeconds, const juce::String& host, int port)
+{
+    statsPushHost = host;
+    statsPushPort = port;
+
+    if (intervalSeconds > 0)
+    {
+        statsPushTimer.startTimer(intervalSeconds * 1000);
+        logMessage("Pushing bridge stats to " + host + ":" + juce::String(port)
+            + " every " + juce::String(intervalSeconds) + " s");
+    }
+    else
+    {
+        statsPushTimer.stopTimer();
+        logMessage("Bridge stats push stopped");
+    }
+}
+
+//------------------------------------------------------------------------------
+void MainComponent::setJitterBuffer(bool shouldBeEnabled, int maxDelayMs)
+{
+    if (!shouldBeEnabled && jitterBuffer.isEnabled())
+        for (auto& line : juce::StringArray::fromLines(jitterBuffer.getReport()))
+            if (line.isNotEmpty())
+                logMessage(line);
+
+    {
+        const juce::ScopedLock lock(oscInputLock);
+        jitterBuffer.setMaxDelayMs(maxDelayMs);
+        jitterBuffer.setEnabled(shouldBeEnabled);
+    }
+
+    logMessage(shouldBeEnabled ? "Jitter buffer on, up to " + juce::String(maxDelayMs) + " ms"
+                               : juce::String("Jitter buffer off"));
+}
+
+//------------------------------------------------------------------------------
+juce::String MainComponent::setSourceFairness(int eventsPerSecond, const juce::String& weights)
+{
+    // Parsed in full before anything changes
+    std::vector<std::pair<juce::uint64, int>> oscWeights, midiWeights;
+
+    for (auto& entry : juce::StringArray::fromTokens(weights, ",", ""))
+    {
+        auto name = entry.upToFirstOccurrenceOf("=", false, false).trim();
+        auto weight = entry.fromFirstOccurrenceOf("=", false, false).getIntValue();
+
+        if (weight <= 0)
+            return "Bad source weight: " + entry;
+
+        if (name == "midi" || name == "keyboard" || name == "virtual" || name == "file")
         {
-            juce::ScopedLock lock(queueLock);
-            MidiEvent event;
-            event.type = MidiEvent::Type::NoteOff;
-            event.channel = message.getChannel();
-            event.parameter = message.getNoteNumber();
-            event.value = 0.0f;
-            midiEventsQueue.add(event);
+            auto source = name == "midi" ? midiDeviceSource : name == "keyboard" ? keyboardSource
+                        : name == "virtual" ? virtualInputSource : midiFileSource;
+            midiWeights.push_back({ source, weight });
+            continue;
         }
-        triggerAsyncUpdate();
+
+        juce::IPAddress address(name.upToLastOccurrenceOf(":", false, false));
+        auto port = name.fromLastOccurrenceOf(":", false, false).getIntValue();
+        if (address.isNull() || port <= 0 || port > 65535)
+            return "Unknown source: " + name;
+
+        oscWeights.push_back({ OscReceiver::makeSourceId(juce::ByteOrder::makeInt(address.address[3], address.address[2],
+                                                                                 address.address[1], address.address[0]), port),
+                               weight });
+    }
+
+    {
+        const juce::ScopedLock lock(oscInputLock);
+        oscSourceQueues.setRateLimit(eventsPerSecond);
+        oscSourceQueues.clearWeights();
+        for (auto& weight : oscWeights)
+            oscSourceQueues.setWeight(weight.first, weight.second);
+    }
+    {
+        const juce::ScopedLock lock(queueLock);
+        midiSourceQueues.setRateLimit(eventsPerSecond);
+        midiSourceQueues.clearWeights();
+        for (auto& weight : midiWeights)
+            midiSourceQueues.setWeight(weight.first, weight.second);
+    }
+
+    logMessage("Source queues: " + (eventsPerSecond > 0 ? juce::String(eventsPerSecond) + " events/s per source"
+                                                        : juce::String("no rate limit"))
+               + (weights.isNotEmpty() ? ", weights " + weights : juce::String()));
+    return {};
+}
+
+juce::String MainComponent::describeMidiSource(juce::uint64 source)
+{
+    return source == midiDeviceSource ? "midi input" : source == keyboardSource ? "keyboard"
+         : source == virtualInputSource ? "virtual input" : "midi file";
+}
+
+//------------------------------------------------------------------------------
+void MainComponent::sendStatsSnapshot(const juce::String& host, int port)
+{
+    if (host.isEmpty() || port <= 0 || port > 65535)
+        return;
+
+    const juce::ScopedLock outputLock(oscOutputLock);
+    auto sendPacket = [this, &host, port](const char* data, int size)
+        {
+            auto result = oscSender.sendTo(host, port, data, size);
+            bridgeStats.countPacketsSent(result.packets, result.bytes, result.calls);
+            if (result.failed > 0)
+                bridgeStats.countSendError(result.failed);
+        };
+
+    bridgeStats.writeSnapshot(latencyMonitor, sendPacket);
+
+    // Per-source playout delays follow in their own bundle
+    if (jitterBuffer.isEnabled())
+        jitterBuffer.writeSnapshot(sendPacket);
+
+    // Then the input queues of every source seen on either route
+    oscSourceQueues.writeSnapshot("osc2midi", OscReceiver::sourceToString, sendPacket);
+    midiSourceQueues.writeSnapshot("midi2osc", describeMidiSource, sendPacket);
+
+    if (midiOutputScheduler != nullptr)
+        midiOutputScheduler->writeSnapshot(sendPacket);
+}
+
+//------------------------------------------------------------------------------
+bool MainComponent::startCapture(const juce::File& file)
+{
+    if (!captureRecorder.start(file))
+    {
+        logMessage("Failed to open capture file " + file.getFullPathName());
+        return false;
+    }
+
+    logMessage("Capturing ingress traffic to " + file.getFullPathName());
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void MainComponent::stopCapture()
+{
+    if (!captureRecorder.isRecording())
+        return;
+
+    captureRecorder.stop();
+    logMessage("Capture stopped: " + juce::String(static_cast<juce::int64>(captureRecorder.getNumRecorded())) + " events, "
+        + juce::String(static_cast<juce::int64>(captureRecorder.getNumDropped())) + " dropped");
+}
+
+//------------------------------------------------------------------------------
+bool MainComponent::startReplay(const juce::File& file, double speed)
+{
+    auto error = captureReplayer.open(file);
+    if (error.isNotEmpty())
+    {
+        logMessage(error);
+        return false;
+    }
+
+    replayFile = file;
+    replayPort = portInEntry.getText().getIntValue();
+    if (!oscConnected)
+        logMessage("OSC server isn't running; OSC records in the capture won't reach the bridge");
+
+    // Each replay is measured on its own
+    latencyMonitor.reset();
+    bridgeStats.reset();
+
+    juce::Component::SafePointer<MainComponent> safeThis(this);
+    captureReplayer.start(speed,
+        [this](SessionCapture::Source source, const char* data, int size)
+        {
+            replayEvent(source, data, size);
+        },
+        [safeThis]()
+        {
+            juce::MessageManager::callAsync([safeThis]()
+                {
+                    if (safeThis != nullptr)
+                        safeThis->finishReplay();
+                });
+        });
+
+    logMessage("Replaying " + file.getFileName() + " (" + juce::String(captureReplayer.getCapturedSeconds(), 1) + " s captured, "
+        + (speed > 0.0 ? "speed x" + juce::String(speed) : juce::String("as fast as possible")) + ")");
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// Called on the replay thread; feeds each record in where the live traffic would arrive.
+void MainComponent::replayEvent(SessionCapture::Source source, const char* data, int size)
+{
+    if (size <= 0)
+        return;
+
+    switch (source)
+    {
+    case SessionCapture::Source::midiInput:
+        handleIncomingMidiMessage(nullptr, juce::MidiMessage(data, size));
+        break;
+
+    case SessionCapture::Source::keyboard:
+    {
+        juce::MidiMessage midi(data, size);
+        if (midi.isNoteOn())
+            handleNoteOn(&midiKeyboardState, midi.getChannel(), midi.getNoteNumber(), midi.getFloatVelocity());
+        else if (midi.isNoteOff())
+            handleNoteOff(&midiKeyboardState, midi.getChannel(), midi.getNoteNumber(), 0.0f);
+    }
+    break;
+
+    case SessionCapture::Source::oscMessage:
+        if (replayPort > 0)
+            replaySocket.write("127.0.0.1", replayPort, data, size);
+        break;
+    }
+}
+
+//------------------------------------------------------------------------------
+void MainComponent::finishReplay()
+{
+    // Give the message thread a moment to drain what the replay queued before reporting
+    juce::Component::SafePointer<MainComponent> safeThis(this);
+    juce::Timer::callAfterDelay(250, [safeThis]()
+        {
+            if (safeThis == nullptr)
+                return;
+
+            auto& replayer = safeThis->captureReplayer;
+            auto seconds = juce::jmax(1.0e-9, replayer.getElapsedSeconds());
+            auto events = static_cast<double>(replayer.getNumReplayed());
+
+            juce::String report;
+            report << "Replay of " << safeThis->replayFile.getFileName() << ": "
+                   << static_cast<juce::int64>(events) << " events in " << juce::String(seconds, 3) << " s ("
+                   << juce::String(replayer.getCapturedSeconds(), 3) << " s captured), "
+                   << juce::String(events / seconds, 0) << " events/s\n"
+                   << "Drops: input filter " << static_cast<int>(safeThis->bridgeStats.getDrops(BridgeStats::inputFilter))
+                   << ", transform " << static_cast<int>(safeThis->bridgeStats.getDrops(BridgeStats::transform))
+                   << ", malformed " << static_cast<int>(safeThis->bridgeStats.getDrops(BridgeStats::malformedPacket))
+                   << ", unknown address " << static_cast<int>(safeThis->bridgeStats.getDrops(BridgeStats::unknownAddress))
+                   << ", queue full " << static_cast<int>(safeThis->bridgeStats.getDrops(BridgeStats::queueFull))
+                   << ", kernel receive buffer " << static_cast<int>(safeThis->bridgeStats.getDrops(BridgeStats::kernelReceive))
+                   << ", jitter buffer late " << static_cast<int>(safeThis->bridgeStats.getDrops(BridgeStats::jitterLate))
+                   << ", source queue " << static_cast<int>(safeThis->bridgeStats.getDrops(BridgeStats::sourceQueue))
+                   << ", MIDI output lane " << static_cast<int>(safeThis->bridgeStats.getDrops(BridgeStats::outputLane)) << "\n"
+                   << safeThis->jitterBuffer.getReport() << "\n"
+                   << safeThis->midiSourceQueues.getReport("midi -> osc", describeMidiSource)
+                   << safeThis->oscSourceQueues.getReport("osc -> midi", OscReceiver::sourceToString)
+                   << (safeThis->midiOutputScheduler != nullptr ? safeThis->midiOutputScheduler->getReport() : juce::String()) << "\n"
+                   << safeThis->latencyMonitor.getReport();
+
+            for (auto& line : juce::StringArray::fromLines(report))
+                if (line.isNotEmpty())
+                    safeThis->logMessage(line);
+
+            if (safeThis->replayReportFile != juce::File())
+                safeThis->replayReportFile.replaceWithText(report);
+
+            if (safeThis->onReplayFinished)
+                safeThis->onReplayFinished();
+        });
+}
+
+//------------------------------------------------------------------------------
+void MainComponent::playMidiFileEvent(const juce::MidiMessage& message)
+{
+    // Not the live input: the input filter and the session capture don't apply
+    PipelineTrace::ScopedSpan span("midi file");
+
+    if (!(message.isNoteOnOrOff() || message.isController() || message.isPitchWheel() || message.isAftertouch()))
+        return;
+
+    bridgeStats.countEvent(TransformWindow::midiToOsc, BridgeStats::in, message.getRawData()[0]);
+    queueMidiInput(midiFileSource, message, LatencyMonitor::now());
+}
+
+//------------------------------------------------------------------------------
+void MainComponent::writeTrace(const juce::File& file)
+{
+    if (PipelineTrace::writeChromeTrace(file))
+        logMessage("Pipeline trace written to " + file.getFullPathName());
+    else
+        logMessage("Failed to write pipeline trace " + file.getFullPathName());
+}
+
+//------------------------------------------------------------------------------
+// Transforms decoded OSC MIDI and queues it in its sender's queue for the batch's block
+// (receiver thread, with oscInputLock held). Events time-tagged for later, or held back by
+// the jitter buffer, are scheduled instead; SysEx goes straight into the block.
+void MainComponent::forwardOSCMidi(const juce::MidiMessage& midi, OscReceiver::SourceId source, juce::uint64 timeTag)
+{
+    AllocationCounter::ScopedStage allocationStage(AllocationCounter::transform);
+    PipelineTrace::ScopedSpan span("transform");
+    auto startTime = LatencyMonitor::now();
+    juce::MidiMessage transformed(midi);
+
+    // Channel messages go through the OSC -> MIDI route transform
+    if (midi.getRawDataSize() <= 3)
+    {
+        juce::uint8 data[3] = {};
+        int size = midi.getRawDataSize();
+        std::memcpy(data, midi.getRawData(), static_cast<size_t>(size));
+        bridgeStats.countEvent(TransformWindow::oscToMidi, BridgeStats::in, data[0]);
+
+        if (!routeTransforms[TransformWindow::oscToMidi]->apply(data, size))
+        {
+            bridgeStats.countDrop(BridgeStats::transform);
+            return;
+        }
+
+        bridgeStats.countEvent(TransformWindow::oscToMidi, BridgeStats::out, data[0]);
+        sessionRecorder.record(TransformWindow::oscToMidi, data, size);
+
+        transformed = juce::MidiMessage(data, size);
+    }
+
+    juce::int64 delayMs = 0;
+
+    if (timeTag != OscPacket::immediateTimeTag && jitterBuffer.isEnabled())
+    {
+        // Late notes still play; a late controller, bend or pressure value is dropped,
+        // since the next one supersedes it anyway
+        auto status = transformed.getRawData()[0] & 0xf0;
+        bool canDrop = status == 0xa0 || status == 0xb0 || status == 0xd0 || status == 0xe0;
+
+        auto wait = jitterBuffer.schedule(source, timeTag, oscBatchReceiveTime, canDrop);
+        if (wait < 0)
+        {
+            bridgeStats.countDrop(BridgeStats::jitterLate);
+            return;
+        }
+
+        delayMs = (wait + 500000) / 1000000;
+    }
+    else if (timeTag != OscPacket::immediateTimeTag)
+    {
+        // Tags already past, or implausibly far ahead, are played now
+        delayMs = OscPacket::timeTagToUnixMillis(timeTag) - oscBatchUnixMillis;
+    }
+
+    if (delayMs > 0 && delayMs <= maxScheduleAheadMs)
+        scheduledOscMidi.addEvent(transformed, static_cast<int>(delayMs));
+    else if (transformed.getRawDataSize() > 3)
+        oscMidiBlock.addEvent(transformed, 0);
+    else if (!oscSourceQueues.push(source, transformed.getRawData(), transformed.getRawDataSize(), oscBatchReceiveTime))
+        bridgeStats.countDrop(BridgeStats::sourceQueue);
+
+    latencyMonitor.recordSince(TransformWindow::oscToMidi, LatencyMonitor::transform, startTime);
+}
+
+//------------------------------------------------------------------------------
+// Sends what the senders' queues let through in one block, and hands scheduled events to
+// the device's timing thread (receiver thread, with oscInputLock held). Returns how many
+// milliseconds until events held back by a sender's rate limit may go, or -1.
+int MainComponent::flushOSCMidi()
+{
+    numOscBlockIngressTimes = 0;
+    auto holdTime = oscSourceQueues.drain(LatencyMonitor::now(), [this](juce::uint64, const FairScheduler::Event& event)
+        {
+            oscMidiBlock.addEvent(event.data, event.size, 0);
+            oscBlockIngressTimes[numOscBlockIngressTimes++] = event.time;
+        });
+
+    int numEvents = oscMidiBlock.getNumEvents();
+    int numScheduled = scheduledOscMidi.getNumEvents();
+
+    if (numEvents > 0)
+    {
+        auto sendTime = LatencyMonitor::now();
+        sendMidiOutputBlock(oscMidiBlock);
+
+        // SysEx, added to the block directly and so ahead of the drained events, is from this batch
+        auto sentTime = latencyMonitor.recordSince(TransformWindow::oscToMidi, LatencyMonitor::send, sendTime);
+        int numSysEx = numEvents - numOscBlockIngressTimes;
+        for (int i = 0; i < numEvents; ++i)
+            latencyMonitor.record(TransformWindow::oscToMidi, LatencyMonitor::endToEnd,
+                                  sentTime - (i < numSysEx ? oscBatchReceiveTime : oscBlockIngressTimes[i - numSysEx]));
+    }
+
+    if (numScheduled > 0)
+        sendMidiOutputBlock(scheduledOscMidi, oscBatchMillisecondCounter);
+
+    // One log line per batch rather than per message
+    if (oscBatchMessages == 1 && numEvents + numScheduled <= 1)
+    {
+        logMessage("OSC Received: " + juce::String(oscBatchAddress));
+
+        for (const auto metadata : numEvents > 0 ? oscMidiBlock : scheduledOscMidi)
+            logMessage("OSC MIDI Received: " + metadata.getMessage().getDescription());
+    }
+    else if (oscBatchMessages > 1)
+    {
+        logMessage("OSC Received: " + juce::String(oscBatchMessages) + " messages -> "
+            + juce::String(numEvents) + " MIDI events sent as one block"
+            + (numScheduled > 0 ? ", " + juce::String(numScheduled) + " scheduled" : juce::String()));
+    }
+
+    oscMidiBlock.clear();
+    scheduledOscMidi.clear();
+
+    return holdTime < 0 ? -1 : static_cast<int>((holdTime + 999999) / 1000000);
+}
+
+//------------------------------------------------------------------------------
+bool MainComponent::beginMidiEvent(MidiEvent& event, juce::int64 dequeueTime)
+{
+    AllocationCounter::ScopedStage allocationStage(AllocationCounter::transform);
+    PipelineTrace::ScopedSpan span("transform");
+    auto startTime = LatencyMonitor::now();
+
+    if (event.ingressTime != 0)
+    {
+        latencyMonitor.record(TransformWindow::midiToOsc, LatencyMonitor::queue, dequeueTime - event.ingressTime);
+        PipelineTrace::recordAsync("queue wait midi->osc", event.ingressTime, dequeueTime);
+    }
+    latencyMonitor.record(TransformWindow::midiToOsc, LatencyMonitor::drain, startTime - dequeueTime);
+
+    bool keep = transformMidiEvent(event);
+    latencyMonitor.recordSince(TransformWindow::midiToOsc, LatencyMonitor::transform, startTime);
+
+    if (!keep)
+    {
+        event.ingressTime = 0;
+        bridgeStats.countDrop(BridgeStats::transform);
+        return false;
+    }
+
+    static const juce::uint8 statusForType[] = { 0x90, 0x80, 0xb0, 0xe0, 0xd0 };   // in MidiEvent::Type order
+    auto status = static_cast<juce::uint8>(statusForType[static_cast<int>(event.type)] | (event.channel - 1));
+    bridgeStats.countEvent(TransformWindow::midiToOsc, BridgeStats::out, status);
+
+    if (sessionRecorder.isRecording())
+    {
+        juce::uint8 data[3] = { status, static_cast<juce::uint8>(event.parameter & 0x7f), static_cast<juce::uint8>(event.value & 0x7f) };
+        int size = 3;
+
+        if (event.type == MidiEvent::Type::PitchBend)
+        {
+            data[1] = static_cast<juce::uint8>(event.value & 0x7f);
+            data[2] = static_cast<juce::uint8>((event.value >> 7) & 0x7f);
+        }
+        else if (event.type == MidiEvent::Type::Aftertouch)
+        {
+            data[1] = static_cast<juce::uint8>(event.value & 0x7f);
+            size = 2;
+        }
+
+        sessionRecorder.record(TransformWindow::midiToOsc, data, size);
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool MainComponent::transformMidiEvent(MidiEvent& event) const noexcept
+{
+    auto& transform = *routeTransforms[TransformWindow::midiToOsc];
+
+    event.channel = transform.mapChannel(event.channel);
+    if (event.channel < 0)
+        return false;
+
+    switch (event.type)
+    {
+    case MidiEvent::Type::NoteOn:
+        event.value = transform.mapVelocity(event.value);
+        event.parameter = transform.mapNote(event.parameter);
+        break;
+
+    case MidiEvent::Type::NoteOff:
+        event.parameter = transform.mapNote(event.parameter);
+        break;
+
+    case MidiEvent::Type::ControlChange:
+    case MidiEvent::Type::Aftertouch:
+        event.value = transform.mapController(event.value);
+        break;
+
+    case MidiEvent::Type::PitchBend:
+        event.value = transform.mapPitchBend(event.value);
+        break;
+    }
+
+    return event.parameter >= 0;
+}
+
+//------------------------------------------------------------------------------
+// Native MIDI: each 'm' argument is one MIDI event for the batch's block (receiver thread).
+void MainComponent::handleNativeMidiMessage(OscMessageReader& message, OscReceiver::SourceId source, juce::uint64 timeTag)
+{
+    if (std::strcmp(message.getAddress(), OscPacket::nativeMidiAddress) != 0)
+    {
+        bridgeStats.countDrop(BridgeStats::malformedPacket);
+        logMessage("Dropped OSC MIDI for unknown address " + juce::String(message.getAddress()));
+        return;
+    }
+
+    if (oscBatchMessages++ == 0)
+        std::strncpy(oscBatchAddress, message.getAddress(), sizeof(oscBatchAddress) - 1);
+
+    juce::uint8 midi[4];
+
+    while (message.getNextType() != 0)
+    {
+        auto decodeTime = LatencyMonitor::now();
+
+        if (!message.readMidi(midi))
+        {
+            // skip() doesn't advance past truncated data or an unknown type tag
+            if (!message.skip())
+            {
+                bridgeStats.countDrop(BridgeStats::malformedPacket);
+                break;
+            }
+
+            continue;
+        }
+
+        // Byte 0 is the port id; only complete channel/system messages are forwarded
+        if (midi[1] < 0x80 || midi[1] == 0xf0 || midi[1] == 0xf7)
+            continue;
+
+        juce::MidiMessage decoded(midi + 1, juce::MidiMessage::getMessageLengthFromFirstByte(midi[1]));
+        latencyMonitor.recordSince(TransformWindow::oscToMidi, LatencyMonitor::encode, decodeTime);
+        forwardOSCMidi(decoded, source, timeTag);
+    }
+}
+
+//------------------------------------------------------------------------------
+void MainComponent::handleNoteOn(juce::MidiKeyboardState*, int /*midiChannel*/, int midiNoteNumber, float velocity)
+{
+    AllocationCounter::ScopedStage allocationStage(AllocationCounter::midiInput);
+    PipelineTrace::ScopedSpan span("keyboard input");
+    auto ingressTime = LatencyMonitor::now();
+    bridgeStats.countEvent(TransformWindow::midiToOsc, BridgeStats::in, static_cast<juce::uint8>(0x90 | (currentOSCChannel - 1)));
+
+    // Notes from the MIDI input are echoed here through midiKeyboardState on the MIDI
+    // thread and are already captured there; only on-screen keyboard notes are captured here
+    if (captureRecorder.isRecording() && juce::MessageManager::existsAndIsCurrentThread())
+    {
+        auto midi = juce::MidiMessage::noteOn(currentOSCChannel, midiNoteNumber, velocity);
+        captureRecorder.record(SessionCapture::Source::keyboard, midi.getRawData(), midi.getRawDataSize(), ingressTime);
+    }
+
+    auto midiVelocity = static_cast<juce::uint8>(juce::jlimit(1, 127, juce::roundToInt(velocity * 127.0f)));
+    queueMidiInput(keyboardSource, juce::MidiMessage::noteOn(currentOSCChannel, midiNoteNumber, midiVelocity), ingressTime);
+    logMessage("Keyboard Note On: " + juce::String(midiNoteNumber)
+        + " Velocity: " + juce::String(velocity));
+}
+
+//------------------------------------------------------------------------------
+void MainComponent::handleNoteOff(juce::MidiKeyboardState*, int /*midiChannel*/, int midiNoteNumber, float /*velocity*/)
+{
+    AllocationCounter::ScopedStage allocationStage(AllocationCounter::midiInput);
+    PipelineTrace::ScopedSpan span("keyboard input");
+    auto ingressTime = LatencyMonitor::now();
+    bridgeStats.countEvent(TransformWindow::midiToOsc, BridgeStats::in, static_cast<juce::uint8>(0x80 | (currentOSCChannel - 1)));
+
+    if (captureRecorder.isRecording() && juce::MessageManager::existsAndIsCurrentThread())
+    {
+        auto midi = juce::MidiMessage::noteOff(currentOSCChannel, midiNoteNumber);
+        captureRecorder.record(SessionCapture::Source::keyboard, midi.getRawData(), midi.getRawDataSize(), ingressTime);
+    }
+
+    queueMidiInput(keyboardSource, juce::MidiMessage::noteOff(currentOSCChannel, midiNoteNumber), ingressTime);
+    logMessage("Keyboard Note Off: " + juce::String(midiNoteNumber));
+}
+
+//------------------------------------------------------------------------------
+void MainComponent::handleIncomingMidiMessage(juce::MidiInput* input, const juce::MidiMessage& message)
+{
+    AllocationCounter::ScopedStage allocationStage(AllocationCounter::midiInput);
+    PipelineTrace::ScopedSpan span("midi input");
+    auto ingressTime = LatencyMonitor::now();
+    auto source = input != nullptr ? midiDeviceSource : virtualInputSource;
+    captureRecorder.record(SessionCapture::Source::midiInput, message.getRawData(), message.getRawDataSize(), ingressTime);
+
+    // Drop filtered traffic on the raw status byte, before any classification, logging or locking
+    if (currentMidiInputFilter != nullptr && !currentMidiInputFilter->accept(message.getRawData()[0]))
+    {
+        bridgeStats.countDrop(BridgeStats::inputFilter);
+        return;
+    }
+
+    bridgeStats.countEvent(TransformWindow::midiToOsc, BridgeStats::in, message.getRawData()[0]);
+
+    if (message.isNoteOn())
+    {
+        midiKeyboardState.noteOn(message.getChannel(), message.getNoteNumber(), message.getFloatVelocity());
+        queueMidiInput(source, message, ingressTime);
+    }
+    else if (message.isNoteOff())
+    {
+        midiKeyboardState.noteOff(message.getChannel(), message.getNoteNumber(), 0.0f);
+        queueMidiInput(source, message, ingressTime);
     }
     else if (message.isController())
     {
@@ -731,16 +2024,7 @@ void MainComponent::handleIncomingMidiMessage(juce::MidiInput*, const juce::Midi
             + ": CC#" + juce::String(ccNumber)
             + " Value: " + juce::String(ccValue));
 
-        {
-            juce::ScopedLock lock(queueLock);
-            MidiEvent event;
-            event.type = MidiEvent::Type::ControlChange;
-            event.channel = channel;
-            event.parameter = ccNumber;
-            event.value = static_cast<float>(ccValue);
-            midiEventsQueue.add(event);
-        }
-        triggerAsyncUpdate();
+        queueMidiInput(source, message, ingressTime);
     }
     else if (message.isPitchWheel())
     {
@@ -749,17 +2033,7 @@ void MainComponent::handleIncomingMidiMessage(juce::MidiInput*, const juce::Midi
         logMessage("Received Pitch Bend on channel " + juce::String(channel)
             + ": " + juce::String(pitchValue));
 
-        float normalizedPitch = static_cast<float>(pitchValue) / 16383.0f;
-        {
-            juce::ScopedLock lock(queueLock);
-            MidiEvent event;
-            event.type = MidiEvent::Type::PitchBend;
-            event.channel = channel;
-            event.parameter = 0;
-            event.value = normalizedPitch;
-            midiEventsQueue.add(event);
-        }
-        triggerAsyncUpdate();
+        queueMidiInput(source, message, ingressTime);
     }
     else if (message.isAftertouch())
     {
@@ -768,16 +2042,7 @@ void MainComponent::handleIncomingMidiMessage(juce::MidiInput*, const juce::Midi
         logMessage("Received Aftertouch on channel " + juce::String(channel)
             + ": " + juce::String(pressureValue));
 
-        {
-            juce::ScopedLock lock(queueLock);
-            MidiEvent event;
-            event.type = MidiEvent::Type::Aftertouch;
-            event.channel = channel;
-            event.parameter = 0;
-            event.value = static_cast<float>(pressureValue);
-            midiEventsQueue.add(event);
-        }
-        triggerAsyncUpdate();
+        queueMidiInput(source, message, ingressTime);
     }
     // Add more MIDI handling logic if needed...
 }
@@ -785,9 +2050,12 @@ void MainComponent::handleIncomingMidiMessage(juce::MidiInput*, const juce::Midi
 //------------------------------------------------------------------------------
 void MainComponent::handleAsyncUpdate()
 {
+    PipelineTrace::ScopedSpan span("drain");
+
     // First flush pending log messages
     juce::String logsToAdd;
     {
+        AllocationCounter::ScopedStage allocationStage(AllocationCounter::ui);
         juce::ScopedLock lock(logLock);
         logsToAdd = pendingLogMessages;
         pendingLogMessages.clear();
@@ -795,6 +2063,7 @@ void MainComponent::handleAsyncUpdate()
 
     if (!logsToAdd.isEmpty())
     {
+        AllocationCounter::ScopedStage allocationStage(AllocationCounter::ui);
         juce::StringArray lines = juce::StringArray::fromLines(logsToAdd);
         for (auto& line : lines)
         {
@@ -803,23 +2072,103 @@ void MainComponent::handleAsyncUpdate()
         }
     }
 
+    // Stats requests; OSC MIDI has already been forwarded by the receiver thread
+    drainOSCMessages();
+
+    if (sessionWorker == nullptr)
+        drainMidiEvents();
+
+    // Update log UI
+    AllocationCounter::ScopedStage uiStage(AllocationCounter::ui);
+    log_list_box.updateContent();
+    int totalRows = logListModel.getNumRows();
+    if (totalRows > 0)
+        log_list_box.scrollToEnsureRowIsOnscreen(totalRows - 1);
+}
+
+//------------------------------------------------------------------------------
+void MainComponent::queueMidiInput(juce::uint64 source, const juce::MidiMessage& message, juce::int64 ingressTime)
+{
+    {
+        juce::ScopedLock lock(queueLock);
+        if (!midiSourceQueues.push(source, message.getRawData(), message.getRawDataSize(), ingressTime))
+            bridgeStats.countDrop(BridgeStats::sourceQueue);
+
+        bridgeStats.updateQueueSize(BridgeStats::midiEventQueue, midiSourceQueues.getNumQueued());
+    }
+
+    requestDrain();
+}
+
+void MainComponent::requestDrain()
+{
+    if (sessionWorker == nullptr)
+    {
+        triggerAsyncUpdate();
+        return;
+    }
+
+    drainPending.store(true, std::memory_order_release);
+    sessionWorker->wake();
+}
+
+int MainComponent::drainIfPending()
+{
+    bool heldBackDue = midiHeldBackUntil != 0 && LatencyMonitor::now() >= midiHeldBackUntil;
+
+    if (drainPending.exchange(false, std::memory_order_acquire) || heldBackDue)
+        drainMidiEvents();
+
+    if (midiHeldBackUntil == 0)
+        return -1;
+
+    return static_cast<int>((juce::jmax<juce::int64>(0, midiHeldBackUntil - LatencyMonitor::now()) + 999999) / 1000000);
+}
+
+//------------------------------------------------------------------------------
+// Runs on the message thread, or on the session's worker when hosted.
+void MainComponent::drainMidiEvents()
+{
+    PipelineTrace::ScopedSpan span("drain midi");
+
     // Process queued MIDI events
+    AllocationCounter::ScopedStage allocationStage(AllocationCounter::drain);
     juce::Array<MidiEvent> eventsToProcess;
+    auto dequeueTime = LatencyMonitor::now();
+    juce::int64 holdTime = -1;
     {
         juce::ScopedLock lock(queueLock);
-        eventsToProcess = midiEventsQueue;
-        midiEventsQueue.clear();
+        holdTime = midiSourceQueues.drain(dequeueTime, [&eventsToProcess](juce::uint64 source, const FairScheduler::Event& queued)
+            {
+                auto event = toMidiEvent(queued);
+                event.toMidiOutput = source != midiFileSource;
+                eventsToProcess.add(event);
+            });
     }
 
+    // Whatever a source's rate limit held back goes on a later pass
+    midiHeldBackUntil = holdTime < 0 ? 0 : dequeueTime + juce::jmax<juce::int64>(1, holdTime);
+
+    if (holdTime >= 0 && sessionWorker == nullptr)
+        drainRetryTimer.startTimer(juce::jmax(1, static_cast<int>((holdTime + 999999) / 1000000)));
+
+    // Everything sent during this pass is queued, with native MIDI packed together,
+    // and written to the socket in one batch at the end
+    const juce::ScopedLock outputLock(oscOutputLock);
+    batchingOscOutput = true;
+
     if (!arpEnabled)
     {
         // ARP disabled: process them directly
         for (auto& event : eventsToProcess)
         {
+            if (!beginMidiEvent(event, dequeueTime))
+                continue;
+
             juce::ScopedLock noteLock(activeNotesLock);
             int channel = juce::jlimit(1, 16, event.channel);
             int param = juce::jlimit(0, 127, event.parameter);
-            float value = juce::jlimit(0.0f, 1.0f, event.value);
+            int value = event.value;
 
             switch (event.type)
             {
@@ -830,16 +2179,15 @@ void MainComponent::handleAsyncUpdate()
                 {
                     sendOSCMessage(param, false);
                     logMessage("Duplicate Note On -> forced Note Off for " + juce::String(param));
-                    if (currentMidiOutput)
-                        currentMidiOutput->sendMessageNow(juce::MidiMessage::noteOff(channel, param));
+                    if (event.toMidiOutput)
+                        sendMidiOutput(juce::MidiMessage::noteOff(channel, param));
                 }
 
-                sendOSCMessage(param, true);
-                sendVelocityMessage(param, value);
+                sendOSCNoteOn(param, value);
                 activeNotes.insert(param);
 
-                if (currentMidiOutput)
-                    currentMidiOutput->sendMessageNow(juce::MidiMessage::noteOn(channel, param, value));
+                if (event.toMidiOutput)
+                    sendMidiOutput(juce::MidiMessage::noteOn(channel, param, static_cast<juce::uint8>(juce::jlimit(1, 127, value))));
             }
             break;
 
@@ -848,29 +2196,27 @@ void MainComponent::handleAsyncUpdate()
                 sendOSCMessage(param, false);
                 activeNotes.erase(param);
 
-                if (currentMidiOutput)
-                    currentMidiOutput->sendMessageNow(juce::MidiMessage::noteOff(channel, param));
+                if (event.toMidiOutput)
+                    sendMidiOutput(juce::MidiMessage::noteOff(channel, param));
             }
             break;
 
             case MidiEvent::Type::ControlChange:
             {
-                // Parameter is CC number, value is 0..1, scale to 0..127
-                int intValue = static_cast<int>(value * 127.0f);
-                sendCCMessage(currentCCChannel, param, intValue);
+                // Parameter is CC number, value is 0..127
+                sendCCMessage(currentCCChannel, param, value, event.toMidiOutput);
             }
             break;
 
             case MidiEvent::Type::PitchBend:
             {
-                sendPitchBendMessage(channel, value);
+                sendPitchBendMessage(channel, static_cast<float>(value) / 16383.0f, event.toMidiOutput);
             }
             break;
 
             case MidiEvent::Type::Aftertouch:
             {
-                int pressureVal = static_cast<int>(value);
-                sendAftertouchMessage(channel, pressureVal);
+                sendAftertouchMessage(channel, value, event.toMidiOutput);
             }
             break;
             }
@@ -881,9 +2227,16 @@ void MainComponent::handleAsyncUpdate()
         // ARP enabled: only add notes to the heldNotes set, do not immediately send them
         for (auto& event : eventsToProcess)
         {
+            if (!beginMidiEvent(event, dequeueTime))
+                continue;
+
             int channel = juce::jlimit(1, 16, event.channel);
             int param = juce::jlimit(0, 127, event.parameter);
-            float value = juce::jlimit(0.0f, 127.0f, event.value); // CC was 0..127
+            int value = event.value;
+
+            // Held notes leave the bridge later, from the ARP, so they aren't timed end-to-end
+            if (event.type == MidiEvent::Type::NoteOn || event.type == MidiEvent::Type::NoteOff)
+                event.ingressTime = 0;
 
             switch (event.type)
             {
@@ -901,28 +2254,67 @@ void MainComponent::handleAsyncUpdate()
                 break;
 
             case MidiEvent::Type::ControlChange:
-            {
-                int intValue = static_cast<int>(value); // CC was 0..127
-                sendCCMessage(currentCCChannel, param, intValue);
-            }
-            break;
+                sendCCMessage(currentCCChannel, param, value, event.toMidiOutput);
+                break;
 
             case MidiEvent::Type::PitchBend:
-                sendPitchBendMessage(channel, value);
+                sendPitchBendMessage(channel, static_cast<float>(value) / 16383.0f, event.toMidiOutput);
                 break;
 
             case MidiEvent::Type::Aftertouch:
-                sendAftertouchMessage(channel, static_cast<int>(value));
+                sendAftertouchMessage(channel, value, event.toMidiOutput);
                 break;
             }
         }
     }
 
-    // Update log UI
-    log_list_box.updateContent();
-    int totalRows = logListModel.getNumRows();
-    if (totalRows > 0)
-        log_list_box.scrollToEnsureRowIsOnscreen(totalRows - 1);
+    batchingOscOutput = false;
+    flushOSCOutput();
+
+    // Everything from this batch has now been written to the socket / MIDI output
+    auto sentTime = LatencyMonitor::now();
+    for (auto& event : eventsToProcess)
+        if (event.ingressTime != 0)
+            latencyMonitor.record(TransformWindow::midiToOsc, LatencyMonitor::endToEnd, sentTime - event.ingressTime);
+}
+
+//------------------------------------------------------------------------------
+MainComponent::MidiEvent MainComponent::toMidiEvent(const FairScheduler::Event& queued)
+{
+    MidiEvent event;
+    event.channel = (queued.data[0] & 0x0f) + 1;
+    event.parameter = queued.data[1];
+    event.value = queued.data[2];
+    event.ingressTime = queued.time;
+
+    switch (queued.data[0] & 0xf0)
+    {
+    case 0x90:
+        event.type = queued.data[2] > 0 ? MidiEvent::Type::NoteOn : MidiEvent::Type::NoteOff;
+        break;
+
+    case 0x80:
+        event.type = MidiEvent::Type::NoteOff;
+        event.value = 0;
+        break;
+
+    case 0xb0:
+        event.type = MidiEvent::Type::ControlChange;
+        break;
+
+    case 0xe0:
+        event.type = MidiEvent::Type::PitchBend;
+        event.parameter = 0;
+        event.value = queued.data[1] | (queued.data[2] << 7);
+        break;
+
+    default:   // poly aftertouch
+        event.type = MidiEvent::Type::Aftertouch;
+        event.parameter = 0;
+        break;
+    }
+
+    return event;
 }
 
 //------------------------------------------------------------------------------
@@ -957,6 +2349,9 @@ void MainComponent::timerCallback()
 
     if (arpEnabled)
     {
+        // The drain may be editing heldNotes on a session worker
+        const juce::ScopedLock outputLock(oscOutputLock);
+
         if (heldNotes.size() == 0)
         {
             if (lastArpNote >= 0)
@@ -1050,10 +2445,8 @@ void MainComponent::advanceArp()
 //------------------------------------------------------------------------------
 void MainComponent::sendArpNoteOn(int noteNumber, float velocity)
 {
-    sendOSCMessage(noteNumber, true);
-    sendVelocityMessage(noteNumber, velocity);
-    if (currentMidiOutput)
-        currentMidiOutput->sendMessageNow(juce::MidiMessage::noteOn(currentOSCChannel, noteNumber, velocity));
+    sendOSCNoteOn(noteNumber, juce::roundToInt(velocity * 127.0f));
+    sendMidiOutput(juce::MidiMessage::noteOn(currentOSCChannel, noteNumber, velocity));
 
     logMessage("ARP Note On: " + juce::String(noteNumber) + " velocity=" + juce::String(velocity));
 }
@@ -1062,12 +2455,116 @@ void MainComponent::sendArpNoteOn(int noteNumber, float velocity)
 void MainComponent::sendArpNoteOff(int noteNumber)
 {
     sendOSCMessage(noteNumber, false);
-    if (currentMidiOutput)
-        currentMidiOutput->sendMessageNow(juce::MidiMessage::noteOff(currentOSCChannel, noteNumber));
+    sendMidiOutput(juce::MidiMessage::noteOff(currentOSCChannel, noteNumber));
 
     logMessage("ARP Note Off: " + juce::String(noteNumber));
 }
 
+//------------------------------------------------------------------------------
+void MainComponent::loadProtocolProfiles()
+{
+    addProtocolProfile(ProtocolProfile::createPatchworld());
+
+    // Any *.json profiles in the user's profile folder are compiled at startup
+    auto profileFolder = juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+                             .getChildFile("OSC2MIDI")
+                             .getChildFile("Profiles");
+
+    for (auto& file : profileFolder.findChildFiles(juce::File::findFiles, false, "*.json"))
+    {
+        juce::String error;
+        if (auto profile = ProtocolProfile::loadFromFile(file, error))
+            addProtocolProfile(profile);
+        else
+            logMessage("Failed to load protocol profile " + error);
+    }
+
+    oscDestination.profile = protocolProfiles.getFirst();
+    refreshProtocolComboBox();
+}
+
+//------------------------------------------------------------------------------
+void MainComponent::addProtocolProfile(ProtocolProfile::Ptr profile)
+{
+    protocolProfiles.add(profile);
+    logMessage("Protocol profile loaded: " + profile->getName());
+}
+
+//------------------------------------------------------------------------------
+void MainComponent::refreshProtocolComboBox()
+{
+    protocolComboBox.clear(juce::dontSendNotification);
+
+    for (int i = 0; i < protocolProfiles.size(); ++i)
+        protocolComboBox.addItem(protocolProfiles[i]->getName(), i + 1);
+
+    protocolComboBox.addItem("Native MIDI ('m' on /midi)", nativeMidiProtocolId);
+    protocolComboBox.addSeparator();
+    protocolComboBox.addItem("Load profile...", loadProfileItemId);
+
+    protocolComboBox.setSelectedId(selectedProtocolId, juce::dontSendNotification);
+}
+
+//------------------------------------------------------------------------------
+void MainComponent::selectProtocol(int itemId)
+{
+    if (itemId == loadProfileItemId)
+    {
+        // Keep showing the current protocol until a profile has actually been loaded
+        protocolComboBox.setSelectedId(selectedProtocolId, juce::dontSendNotification);
+        chooseProfileFile();
+        return;
+    }
+
+    if (itemId != nativeMidiProtocolId && (itemId < 1 || itemId > protocolProfiles.size()))
+        return;
+
+    const juce::ScopedLock outputLock(oscOutputLock);
+    flushNativeMidi();
+    selectedProtocolId = itemId;
+
+    if (itemId == nativeMidiProtocolId)
+    {
+        oscDestination.format = OscDestination::Format::MidiMessage;
+    }
+    else
+    {
+        // Profiles are compiled when loaded, so switching is just a pointer swap
+        const juce::ScopedLock lock(oscInputLock);
+        oscDestination.format = OscDestination::Format::AddressProfile;
+        oscDestination.profile = protocolProfiles[itemId - 1];
+        oscDecoderState = {};
+    }
+
+    logMessage("OSC protocol changed to: " + protocolComboBox.getText());
+}
+
+//------------------------------------------------------------------------------
+void MainComponent::chooseProfileFile()
+{
+    profileChooser = std::make_unique<juce::FileChooser>("Select a protocol profile...", juce::File(), "*.json");
+
+    profileChooser->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+        [this](const juce::FileChooser& chooser)
+        {
+            auto file = chooser.getResult();
+            if (!file.existsAsFile())
+                return;
+
+            juce::String error;
+            auto profile = ProtocolProfile::loadFromFile(file, error);
+            if (profile == nullptr)
+            {
+                logMessage("Failed to load protocol profile " + error);
+                return;
+            }
+
+            addProtocolProfile(profile);
+            refreshProtocolComboBox();
+            protocolComboBox.setSelectedId(protocolProfiles.size());
+        });
+}
+
 //------------------------------------------------------------------------------
 void MainComponent::handleMenuItemClick(int menuItemId)
 {
@@ -1095,7 +2592,7 @@ void MainComponent::handleMenuItemClick(int menuItemId)
         logMessage("Menu Item 2 clicked -> Opening File Browser");
         if (!fileBrowserWindow)
         {
-            fileBrowserWindow = std::make_unique<FileBrowserWindow>(
+            fileBrowserWindow = std::make_unique<FileBrowserWindow>(midiFilePlayer, sessionRecorder,
                 [this](const juce::File& file)
                 {
                     logMessage("File selected: " + file.getFullPathName());
@@ -1125,6 +2622,123 @@ void MainComponent::handleMenuItemClick(int menuItemId)
         logMessage("Mixer Control Window is now visible.");
         break;
 
+    case 4:
+        logMessage("Menu Item 4 clicked -> Opening MIDI Filter Window");
+        if (!midiFilterWindow)
+        {
+            midiFilterWindow = std::make_unique<MidiFilterWindow>();
+            midiFilterWindow->setAlwaysOnTop(true);
+        }
+        midiFilterWindow->setFilter(currentMidiInput ? currentMidiInputFilter : nullptr, currentMidiInputName);
+        midiFilterWindow->setVisible(true);
+        midiFilterWindow->toFront(true);
+        logMessage("MIDI Filter Window is now visible.");
+        break;
+
+    case 5:
+        logMessage("Menu Item 5 clicked -> Opening Transform Window");
+        if (!transformWindow)
+        {
+            transformWindow = std::make_unique<TransformWindow>(
+                [this](int route, const MidiTransform::Settings& settings)
+                {
+                    // Tables are rebuilt once per edit, never per event
+                    auto transform = MidiTransform::compile(settings);
+                    const juce::ScopedLock outputLock(oscOutputLock);
+                    const juce::ScopedLock lock(oscInputLock);
+                    routeTransforms[route] = transform;
+                });
+            transformWindow->setAlwaysOnTop(true);
+
+            for (int route = 0; route < TransformWindow::numRoutes; ++route)
+                transformWindow->setRouteSettings(route, routeTransforms[route]->getSettings());
+        }
+        transformWindow->setVisible(true);
+        transformWindow->toFront(true);
+        logMessage("Transform Window is now visible.");
+        break;
+
+    case 6:
+        logMessage("Menu Item 6 clicked -> Opening Latency Window");
+        if (!latencyWindow)
+        {
+            latencyWindow = std::make_unique<LatencyWindow>(latencyMonitor);
+            latencyWindow->setAlwaysOnTop(true);
+        }
+        latencyWindow->setVisible(true);
+        latencyWindow->toFront(true);
+        logMessage("Latency Window is now visible.");
+        break;
+
+    case 7:
+        // Toggles capturing; starting asks where to save
+        if (captureRecorder.isRecording())
+        {
+            stopCapture();
+            break;
+        }
+
+        captureChooser = std::make_unique<juce::FileChooser>("Save capture as...", juce::File(), "*.o2mcap");
+        captureChooser->launchAsync(juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::canSelectFiles
+                                        | juce::FileBrowserComponent::warnAboutOverwriting,
+            [this](const juce::FileChooser& chooser)
+            {
+                auto file = chooser.getResult();
+                if (file != juce::File())
+                    startCapture(file);
+            });
+        break;
+
+    case 8:
+        // Toggles replay of a capture at its original timing
+        if (captureReplayer.isReplaying())
+        {
+            captureReplayer.stop();
+            break;
+        }
+
+        replayChooser = std::make_unique<juce::FileChooser>("Replay capture...", juce::File(), "*.o2mcap");
+        replayChooser->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+            [this](const juce::FileChooser& chooser)
+            {
+                auto file = chooser.getResult();
+                if (file.existsAsFile())
+                    startReplay(file, 1.0);
+            });
+        break;
+
+    case 9:
+        // Toggles tracing; stopping asks where to save the trace
+        if (!PipelineTrace::isEnabled())
+        {
+            PipelineTrace::start();
+            logMessage("Tracing pipeline spans");
+            break;
+        }
+
+        traceChooser = std::make_unique<juce::FileChooser>("Save trace as...", juce::File(), "*.json");
+        traceChooser->launchAsync(juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::canSelectFiles
+                                      | juce::FileBrowserComponent::warnAboutOverwriting,
+            [this](const juce::FileChooser& chooser)
+            {
+                auto file = chooser.getResult();
+                if (file != juce::File())
+                    writeTrace(file);
+
+                PipelineTrace::stop();
+            });
+        break;
+
+    case 10:
+        // Toggles the jitter buffer; turning it off logs what it settled on
+        setJitterBuffer(!jitterBuffer.isEnabled(), jitterBuffer.getMaxDelayMs());
+        break;
+
+    case 11:
+        // Toggles DIN pacing of the MIDI output; turning it off logs each lane's delays
+        setMidiOutputPacing(midiOutputScheduler != nullptr ? 0 : MidiOutputScheduler::dinBytesPerSecond);
+        break;
+
     default:
         logMessage("Unknown Menu Item Clicked: " + juce::String(menuItemId));
         break;
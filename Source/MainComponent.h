@@ -2,11 +2,33 @@
 
 #include <JuceHeader.h>
 #include <set>
+#include <map>
 #include "SideMenu.h"            // SideMenu UI
 #include "CustomLookAndFeel.h"   // Custom LookAndFeel for the Hamburger Button
 #include "CCControlWindow.h"     // Optional: Pop-up window for sending CC messages
 #include "FileBrowserWindow.h"   // Optional: Pop-up window with file browser
 #include "MixerControlWindow.h"  // Optional: Pop-up window for mixer controls
+#include "MidiFilterWindow.h"    // Optional: Pop-up window for MIDI input filter masks
+#include "MidiInputFilter.h"     // Channel x message-type masks applied at the MIDI callback
+#include "OscPacket.h"           // Raw OSC encoding for the native MIDI ('m') transport
+#include "OscReceiver.h"         // Batched UDP receive with in-place OSC parsing
+#include "OscSender.h"           // Batched UDP send (sendmmsg) of encoded OSC packets
+#include "JitterBuffer.h"        // Per-source playout delay for time-tagged OSC over Wi-Fi
+#include "FairScheduler.h"       // Per-source input queues drained in weighted round-robin
+#include "MidiOutputScheduler.h" // Wire-rate pacing and priority lanes for a MIDI output port
+#include "ProtocolProfile.h"     // Precompiled OSC address schemes (Patchworld, TouchOSC...)
+#include "MidiTransform.h"       // Per-route velocity/CC curves, transpose, scale and channel tables
+#include "TransformWindow.h"     // Optional: Pop-up window for editing route transforms
+#include "LatencyMonitor.h"      // Per-stage latency histograms
+#include "LatencyWindow.h"       // Optional: Pop-up window showing latency percentiles
+#include "BridgeStats.h"         // Counters answered over OSC at /bridge/stats
+#include "SessionCapture.h"      // Binary capture of ingress traffic
+#include "MidiFilePlayer.h"      // Standard MIDI File playback thread
+#include "MidiSessionRecorder.h" // Both directions of traffic recorded to a Standard MIDI File
+#include "AllocationCounter.h"   // Per-thread and per-stage heap allocation counts
+#include "PipelineTrace.h"       // Span tracing exported as Chrome trace JSON
+
+class SessionWorker;
 
 //==============================================================================
 // A custom ListBoxModel to display logs efficiently.
@@ -49,7 +71,7 @@ private:
 // MainComponent handles all GUI elements, MIDI I/O, OSC I/O, side menu, ARP, etc.
 class MainComponent
     : public juce::Component,
-    private juce::OSCReceiver::ListenerWithOSCAddress<juce::OSCReceiver::MessageLoopCallback>,
+    private OscReceiver::Listener,
     private juce::MidiKeyboardStateListener,
     private juce::MidiInputCallback,
     private juce::AsyncUpdater,
@@ -62,8 +84,29 @@ public:
     void paint(juce::Graphics&) override;
     void resized() override;
 
-    // Called when an OSC message is received
-    void oscMessageReceived(const juce::OSCMessage& message) override;
+    // Headless mode: configures OSC and MIDI from command-line options instead of
+    // the UI and starts the bridge. Returns an error message, or an empty string.
+    juce::String startHeadless(const juce::StringArray& args);
+
+    // Writes the current latency percentiles as a text table.
+    bool writeLatencyReport(const juce::File& file) const;
+
+    // Called once a capture replay has finished and its report has been written.
+    std::function<void()> onReplayFinished;
+
+    // Virtual MIDI port for machines without MIDI hardware: injectMidiInput feeds a
+    // message in as if it came from the MIDI input (from any thread), and when
+    // a stand-in is set everything for the MIDI output goes to it instead of the
+    // device, on whichever thread sends (OSC MIDI comes from the receiver thread).
+    void injectMidiInput(const juce::MidiMessage& message) { handleIncomingMidiMessage(nullptr, message); }
+    void setMidiOutputStandIn(std::function<void(const juce::MidiMessage&)> standIn);
+
+    // Multi-session hosting: queued MIDI is drained on the given worker thread instead of
+    // the message thread. Set it before startHeadless(), and stop the worker before the
+    // session is deleted. The worker calls drainIfPending() once woken, and again after the
+    // milliseconds it returns if some sources' events were held back by their rate limit.
+    void setSessionWorker(SessionWorker* worker) noexcept { sessionWorker = worker; }
+    int drainIfPending();
 
 private:
     //==================================================================
@@ -81,7 +124,26 @@ private:
 
         int channel;      // MIDI channel (1-16)
         int parameter;    // Note number or CC number, etc.
-        float value;      // Velocity, CC value, pitch bend value, aftertouch, etc.
+        int value;        // MIDI units: velocity/CC/aftertouch 0-127, pitch bend 0-16383
+
+        juce::int64 ingressTime = 0;   // LatencyMonitor::now() when received, 0 if not timed
+        bool toMidiOutput = true;      // false when the source has sent it to the MIDI output already
+    };
+
+    //==================================================================
+    // Where outgoing OSC goes and which wire format it expects.
+    struct OscDestination
+    {
+        enum class Format
+        {
+            AddressProfile,   // Addresses and scaling from a ProtocolProfile (Patchworld by default)
+            MidiMessage       // Raw MIDI as OSC 'm' arguments on a single address, several per message
+        };
+
+        juce::String host;
+        int port = 0;
+        Format format = Format::AddressProfile;
+        ProtocolProfile::Ptr profile;
     };
 
     //==================================================================
@@ -91,6 +153,10 @@ private:
     juce::Label     ipInLabel, portInLabel, ipOutLabel, portOutLabel;
     juce::TextEditor ipInEntry, portInEntry, ipOutEntry, portOutEntry;
 
+    // Protocol profile (or native MIDI) used for the OSC destination
+    juce::Label     protocolLabel{ "protocolLabel", "OSC Protocol:" };
+    juce::ComboBox  protocolComboBox;
+
     // Button to start/stop the OSC server
     juce::TextButton startButton;
 
@@ -134,10 +200,28 @@ private:
     juce::Label     channelPressureLabel{ "channelPressureLabel", "Channel Pressure:" };
     juce::Slider    channelPressureSlider;
 
-    // OSC sender and receiver
-    juce::OSCSender    oscSender;
-    juce::OSCReceiver  oscReceiver;
-    bool               oscConnected = false;
+    // OSC receiver, and the sender that pre-encoded outgoing packets are written to
+    OscReceiver            oscReceiver{ *this };
+    OscSender              oscSender;
+    bool                   oscConnected = false;
+
+    // Multicast settings, used when the OSC In or Out address is a group
+    juce::String           multicastInterface;   // address of the interface to use; empty lets routing decide
+    int                    multicastTtl = 1;     // router hops outgoing packets may cross; 1 stays on the LAN
+    bool                   multicastLoopback = true;
+
+    OscDestination         oscDestination;
+    OscMessageWriter       pendingNativeMidi;
+    bool                   batchingOscOutput = false;   // packets are queued until flushOSCOutput()
+
+    // Loaded protocol profiles; index i is protocolComboBox item id i + 1
+    juce::ReferenceCountedArray<ProtocolProfile> protocolProfiles;
+    ProtocolProfile::DecoderState oscDecoderState;
+    std::unique_ptr<juce::FileChooser> profileChooser;
+    int selectedProtocolId = 1;
+
+    static constexpr int nativeMidiProtocolId = 1000;
+    static constexpr int loadProfileItemId = 1001;
 
     // Currently chosen MIDI in/out devices
     std::unique_ptr<juce::MidiInput>  currentMidiInput;
@@ -147,11 +231,132 @@ private:
     juce::StringArray midiInputIdentifiers;
     juce::StringArray midiOutputIdentifiers;
 
+    // Input filters are kept per device identifier, so each device remembers its masks
+    std::map<juce::String, std::unique_ptr<MidiInputFilter>> midiInputFilters;
+    MidiInputFilter* currentMidiInputFilter = nullptr;
+    juce::String currentMidiInputName;
+
+    // Compiled transform for each route (TransformWindow::Route), applied to every routed event
+    MidiTransform::Ptr routeTransforms[TransformWindow::numRoutes];
+
+    // Latency of each pipeline stage, per route
+    LatencyMonitor latencyMonitor;
+    juce::int64 socketWriteTime = 0;   // accumulated by sendOSCPacket, so encode timing can leave it out
+
+    // Remote monitoring counters, and where periodic snapshots are pushed
+    struct CallbackTimer : public juce::Timer
+    {
+        std::function<void()> onTimer;
+        void timerCallback() override { onTimer(); }
+    };
+
+    BridgeStats    bridgeStats;
+    CallbackTimer  statsPushTimer;
+    juce::String   statsPushHost;
+    int            statsPushPort = 0;
+    bool           statsAllowRedirect = false;   // --stats-allow-redirect: replies may go to any host a request names
+
+    // Ingress capture to file (side menu "Capture" or --capture)
+    CaptureRecorder captureRecorder;
+    std::unique_ptr<juce::FileChooser> captureChooser;
+
+    // Capture replay: MIDI records go to the MIDI callbacks, OSC records to our own OSC input port
+    CaptureReplayer captureReplayer;
+
+    // Standard MIDI File playback, driven from the file browser
+    MidiFilePlayer midiFilePlayer{ [this](const juce::MidiBuffer& block, juce::uint32 startMillisecondCounter) { sendMidiOutputBlock(block, startMillisecondCounter); },
+                                   [this](const juce::MidiMessage& message) { playMidiFileEvent(message); } };
+
+    // Records what leaves the bridge on both routes, after the transforms
+    MidiSessionRecorder sessionRecorder{ [this](const juce::File& file, const juce::String& error)
+        {
+            logMessage(error.isNotEmpty() ? error : "Session recording written to " + file.getFullPathName());
+        } };
+    std::unique_ptr<juce::FileChooser> replayChooser;
+    juce::DatagramSocket replaySocket;
+    int replayPort = 0;
+    juce::File replayFile, replayReportFile;
+
+    // Pipeline tracing (side menu "Trace", or --trace <file> written on exit)
+    std::unique_ptr<juce::FileChooser> traceChooser;
+    juce::File traceFile;
+
     //==================================================================
     // Thread-safety and queues:
-    juce::Array<MidiEvent>  midiEventsQueue;
+    // MIDI input waiting for the drain, queued per source (MidiSource) so that a flood from
+    // one can't hold up the others
+    FairScheduler            midiSourceQueues;
     juce::CriticalSection    queueLock;
 
+    enum MidiSource : juce::uint64
+    {
+        midiDeviceSource = 1,
+        keyboardSource,
+        virtualInputSource,  // injected or replayed
+        midiFileSource       // played from a MIDI file; the player sends these to the MIDI output itself
+    };
+
+    // Set by the drain when sources were held back by their rate limit: when to drain again,
+    // from the retry timer on the message thread or from the session worker
+    juce::int64              midiHeldBackUntil = 0;
+    CallbackTimer            drainRetryTimer;
+
+    // Where the MIDI input queues are drained: the message thread, or a session worker when hosted.
+    // Either way the drain holds oscOutputLock, which guards the OSC sender, the native MIDI
+    // packing and the ARP notes against the message thread's timers and stats replies.
+    SessionWorker*           sessionWorker = nullptr;
+    std::atomic<bool>        drainPending { false };
+    juce::CriticalSection    oscOutputLock;
+
+    // Incoming OSC is decoded and forwarded to the MIDI output on the receiver thread, which
+    // holds oscInputLock for each receive batch; the message thread takes it to swap the profile,
+    // decoder state or route transforms. midiOutputLock serialises sends with device changes.
+    juce::CriticalSection    oscInputLock;
+    juce::CriticalSection    midiOutputLock;
+    std::function<void(const juce::MidiMessage&)> midiOutputStandIn;   // guarded by midiOutputLock
+
+    // Set while the MIDI output is paced to its wire rate (guarded by midiOutputLock, changed on
+    // the message thread). Its thread sends through deliverMidiOutput, taking midiOutputLock, so
+    // it is only ever stopped with the lock released.
+    std::unique_ptr<MidiOutputScheduler> midiOutputScheduler;
+
+    // MIDI decoded during a receive batch, sent as one block when the batch ends (guarded by
+    // oscInputLock). Events from bundles time-tagged for later go in scheduledOscMidi, positioned
+    // in milliseconds from the batch start. Both are preallocated in the constructor.
+    juce::MidiBuffer oscMidiBlock, scheduledOscMidi;
+    juce::int64 oscBatchReceiveTime = 0;
+    juce::int64 oscBatchUnixMillis = 0;
+    juce::uint32 oscBatchMillisecondCounter = 0;
+    int oscBatchMessages = 0;
+    char oscBatchAddress[64] = {};   // first message's address, for the log
+
+    // Optional playout smoothing of time-tagged OSC (settings changed under oscInputLock)
+    JitterBuffer jitterBuffer;
+
+    // Immediate OSC MIDI is queued per sender and drained into oscMidiBlock in weighted
+    // round-robin when the batch ends (guarded by oscInputLock). oscBlockIngressTimes holds
+    // the arrival time of each event drained, which may be from an earlier batch.
+    FairScheduler oscSourceQueues;
+    juce::HeapBlock<juce::int64> oscBlockIngressTimes { static_cast<size_t>(FairScheduler::maxSources * FairScheduler::queueSize) };
+    int numOscBlockIngressTimes = 0;
+
+    static constexpr int oscMidiBlockBytes = 1 << 16;
+    static constexpr juce::int64 maxScheduleAheadMs = 10000;   // later tags are taken as clock skew and sent now
+
+    // Incoming /bridge/stats requests, copied from the receiver thread for the message thread.
+    // Single producer, single consumer: each record is an OscMessageRecord then the message.
+    struct OscMessageRecord
+    {
+        juce::int64 receiveTime = 0;
+        OscReceiver::SourceId source = 0;
+        juce::int32 size = 0;
+        juce::int32 reserved = 0;
+    };
+
+    static constexpr int oscMessageFifoSize = 1 << 16;
+    juce::AbstractFifo oscMessageFifo{ oscMessageFifoSize };
+    juce::HeapBlock<char> oscMessageBuffer{ static_cast<size_t>(oscMessageFifoSize) };
+
     // Keep track of active notes so we avoid duplicates
     std::set<int> activeNotes;
     juce::CriticalSection activeNotesLock;
@@ -197,6 +402,9 @@ private:
     std::unique_ptr<CCControlWindow>    ccControlWindow;
     std::unique_ptr<FileBrowserWindow>  fileBrowserWindow;
     std::unique_ptr<MixerControlWindow> mixerControlWindow;
+    std::unique_ptr<MidiFilterWindow>   midiFilterWindow;
+    std::unique_ptr<TransformWindow>    transformWindow;
+    std::unique_ptr<LatencyWindow>      latencyWindow;
 
     //==================================================================
     // Internal helpers:
@@ -212,16 +420,85 @@ private:
     void updateMidiDevices();
     void setMidiInput(const juce::String& identifier);
     void setMidiOutput(const juce::String& identifier);
+    void sendMidiOutput(const juce::MidiMessage& message);   // the device, or midiOutputStandIn
+    void sendMidiOutputBlock(const juce::MidiBuffer& block, juce::uint32 startMillisecondCounter = 0);
+    void deliverMidiOutput(const juce::MidiMessage& message);   // now, bypassing any pacing
+
+    // Paces the MIDI output to the given wire rate (e.g. MidiOutputScheduler::dinBytesPerSecond),
+    // or sends straight to it with 0 (message thread)
+    void setMidiOutputPacing(int bytesPerSecond);
 
     // Sending messages
     void sendOSCMessage(int midiNote, bool noteOn);
-    void sendVelocityMessage(int midiNote, float velocity);
-    void sendCCMessage(int channel, int ccNumber, int ccValue);
-    void sendPitchBendMessage(int channel, float pitchValue);
-    void sendAftertouchMessage(int channel, int pressureValue);
-
-    // Handling incoming OSC
-    void handleIncomingOSCMessage(const juce::OSCMessage& message);
+    void sendCCMessage(int channel, int ccNumber, int ccValue, bool toMidiOutput = true);
+    void sendPitchBendMessage(int channel, float pitchValue, bool toMidiOutput = true);
+    void sendAftertouchMessage(int channel, int pressureValue, bool toMidiOutput = true);
+    void sendOSCNoteOn(int midiNote, int velocity);
+    void sendOSCEvent(ProtocolProfile::EventType type, int channel, int number, int value);
+    void sendOSCPacket(const char* data, int size);
+
+    // Protocol profiles
+    void loadProtocolProfiles();
+    void addProtocolProfile(ProtocolProfile::Ptr profile);
+    void refreshProtocolComboBox();
+    void selectProtocol(int itemId);
+    void chooseProfileFile();
+
+    // Native MIDI ('m') transport: events are packed into one message until flushed
+    bool isNativeMidiDestination() const noexcept;
+    void sendNativeMidi(int status, int data1, int data2);
+    void flushNativeMidi();
+    void flushOSCOutput();
+
+    // OscReceiver callbacks (receiver thread)
+    void oscBatchStarted(juce::int64 receiveTime) override;
+    int oscBatchFinished() override;
+    void oscPacketReceived(const char* data, int size, juce::int64 receiveTime) override;
+    void oscMessageReceived(OscMessageReader& message, OscReceiver::SourceId source, juce::uint64 timeTag, juce::int64 receiveTime) override;
+    void oscPacketMalformed(const char* data, int size) override;
+    void oscReceiveQueueRead(juce::uint32 newDrops, int queuedBytes) override;
+
+    // Handling incoming OSC: stats requests go through the FIFO to the message thread,
+    // everything else is decoded and forwarded on the receiver thread
+    void queueOSCMessage(const OscMessageReader& message, OscReceiver::SourceId source, juce::int64 receiveTime);
+    void drainOSCMessages();
+    void handleIncomingOSCMessage(OscMessageReader& message, OscReceiver::SourceId source, juce::uint64 timeTag);
+    void handleNativeMidiMessage(OscMessageReader& message, OscReceiver::SourceId source, juce::uint64 timeTag);
+    void forwardOSCMidi(const juce::MidiMessage& midi, OscReceiver::SourceId source, juce::uint64 timeTag);
+    int flushOSCMidi();
+    void setJitterBuffer(bool shouldBeEnabled, int maxDelayMs);   // message thread
+
+    // Per-source fairness on both routes: a rate cap per source (0 for none) and weights
+    // given as "<source>=<weight>,...", where a source is an OSC sender "a.b.c.d:port" or
+    // "midi", "keyboard" or "virtual". Returns an error for a weight it can't parse.
+    juce::String setSourceFairness(int eventsPerSecond, const juce::String& weights);
+    static juce::String describeMidiSource(juce::uint64 source);
+
+    // Remote monitoring: /bridge/stats query, push and reset
+    void handleStatsRequest(OscMessageReader& message, OscReceiver::SourceId source);
+    void setStatsPush(int intervalSeconds, const juce::String& host, int port);
+    void sendStatsSnapshot(const juce::String& host, int port);
+
+    // Capture
+    bool startCapture(const juce::File& file);
+    void stopCapture();
+
+    // Replay
+    bool startReplay(const juce::File& file, double speed);
+    void replayEvent(SessionCapture::Source source, const char* data, int size);
+
+    // Queues a MIDI file event for OSC only; the player has sent it to the MIDI output itself (player thread)
+    void playMidiFileEvent(const juce::MidiMessage& message);
+    void finishReplay();
+
+    // Tracing
+    void writeTrace(const juce::File& file);
+
+    // Route transforms; returns false if the event is dropped (e.g. quantised out of range)
+    bool transformMidiEvent(MidiEvent& event) const noexcept;
+
+    // Records queue/drain time and transforms a dequeued event; returns false if it's dropped
+    bool beginMidiEvent(MidiEvent& event, juce::int64 dequeueTime);
 
     // MIDI callbacks
     void handleNoteOn(juce::MidiKeyboardState*, int midiChannel, int midiNoteNumber, float velocity) override;
@@ -231,6 +508,12 @@ private:
     // AsyncUpdater callback
     void handleAsyncUpdate() override;
 
+    // Queues MIDI input in its source's queue, and wakes whichever thread drains them (any thread)
+    void queueMidiInput(juce::uint64 source, const juce::MidiMessage& message, juce::int64 ingressTime);
+    void requestDrain();
+    void drainMidiEvents();
+    static MidiEvent toMidiEvent(const FairScheduler::Event& queued);
+
     // Timer callback (ARP stepping + side menu animation)
     void timerCallback() override;
 
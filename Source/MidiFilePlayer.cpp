@@ -0,0 +1,282 @@
+#include "MidiFilePlayer.h"
+#include "LatencyMonitor.h"
+
+//==============================================================================
+MidiFilePlayer::MidiFilePlayer(BlockCallback outputCallback, EventCallback callback)
+    : juce::Thread("MIDI file player"),
+      blockCallback(std::move(outputCallback)),
+      eventCallback(std::move(callback))
+{
+    outputBlock.ensureSize(1024);
+}
+
+MidiFilePlayer::~MidiFilePlayer()
+{
+    stop();
+}
+
+//------------------------------------------------------------------------------
+juce::String MidiFilePlayer::load(const juce::File& file)
+{
+    stop();
+
+    juce::FileInputStream stream(file);
+    if (!stream.openedOk())
+        return "Couldn't open " + file.getFullPathName();
+
+    juce::MidiFile midiFile;
+    if (!midiFile.readFrom(stream))
+        return "Not a Standard MIDI File: " + file.getFullPathName();
+
+    midiFile.convertTimestampTicksToSeconds();
+
+    int numEvents = 0;
+    for (int track = 0; track < midiFile.getNumTracks(); ++track)
+        numEvents += midiFile.getTrack(track)->getNumEvents();
+
+    std::vector<Event> newEvents;
+    newEvents.reserve(static_cast<size_t>(numEvents));
+    double newLength = 0.0;
+
+    for (int track = 0; track < midiFile.getNumTracks(); ++track)
+    {
+        auto* sequence = midiFile.getTrack(track);
+
+        for (int i = 0; i < sequence->getNumEvents(); ++i)
+        {
+            auto& message = sequence->getEventPointer(i)->message;
+            newLength = juce::jmax(newLength, message.getTimeStamp());
+
+            auto* data = message.getRawData();
+            auto size = message.getRawDataSize();
+            if (size < 1 || size > 3 || data[0] < 0x80 || data[0] >= 0xf0)
+                continue;
+
+            Event event { message.getTimeStamp(), { 0, 0, 0 }, static_cast<juce::uint8>(size) };
+            std::memcpy(event.data, data, static_cast<size_t>(size));
+            newEvents.push_back(event);
+        }
+    }
+
+    // Tracks are each sorted already; a stable sort keeps their order for simultaneous events
+    std::stable_sort(newEvents.begin(), newEvents.end(),
+        [](const Event& a, const Event& b) { return a.time < b.time; });
+
+    events = std::move(newEvents);
+    length = newLength;
+    loadedFile = file;
+    position.store(0.0, std::memory_order_relaxed);
+    return {};
+}
+
+//------------------------------------------------------------------------------
+void MidiFilePlayer::play()
+{
+    stop();
+
+    if (events.empty())
+        return;
+
+    startThread(juce::Thread::Priority::high);
+}
+
+//------------------------------------------------------------------------------
+void MidiFilePlayer::stop()
+{
+    stopThread(2000);
+}
+
+//------------------------------------------------------------------------------
+void MidiFilePlayer::run()
+{
+    for (int channel = 0; channel < 16; ++channel)
+    {
+        heldNotes[channel].clear();
+        scheduledNotes[channel].clear();
+    }
+
+    // Times are measured in file seconds that keep counting across loops (pass * length +
+    // event time), from a base point that moves whenever the tempo changes, so a tempo
+    // change takes effect from the current position instead of jumping
+    double basePosition = 0.0;
+    double currentTempo = tempo.load(std::memory_order_relaxed);
+    auto baseTime = LatencyMonitor::now();
+
+    auto fileTimeAt = [&](juce::int64 time)
+        {
+            return basePosition + static_cast<double>(time - baseTime) / 1.0e9 * currentTempo;
+        };
+
+    auto dueTimeOf = [&](double fileTime)
+        {
+            return baseTime + static_cast<juce::int64>((fileTime - basePosition) / currentTempo * 1.0e9);
+        };
+
+    auto fileTimeOf = [this](const Cursor& cursor)
+        {
+            return cursor.pass * length + events[cursor.index].time;
+        };
+
+    // Moves a cursor that has run off the end of the file on to the next pass if looping;
+    // false if it has reached the end for good
+    auto wrap = [this](Cursor& cursor)
+        {
+            if (cursor.index < events.size())
+                return true;
+
+            if (!looping.load(std::memory_order_relaxed) || length <= 0.0)
+                return false;
+
+            cursor.index = 0;
+            ++cursor.pass;
+            return true;
+        };
+
+    Cursor scheduled, dispatched;
+    juce::int64 lastScheduledTime = baseTime;
+
+    while (!threadShouldExit())
+    {
+        auto now = LatencyMonitor::now();
+
+        auto newTempo = tempo.load(std::memory_order_relaxed);
+        if (newTempo != currentTempo)
+        {
+            basePosition = fileTimeAt(now);
+            baseTime = now;
+            currentTempo = newTempo;
+        }
+
+        position.store(juce::jlimit(0.0, length, fileTimeAt(now) - dispatched.pass * length), std::memory_order_relaxed);
+
+        // Send the output everything due within the lookahead, in one timestamped block. An
+        // event never goes out ahead of one already sent, even after a tempo change.
+        auto startMillisecondCounter = juce::Time::getMillisecondCounter();
+        auto scheduleUntil = now + static_cast<juce::int64>(lookaheadMs) * 1000000;
+        auto millisecondsAhead = [now](juce::int64 time) { return static_cast<int>(juce::jmax<juce::int64>(0, time - now) / 1000000); };
+        outputBlock.clear();
+
+        for (;;)
+        {
+            auto pass = scheduled.pass;
+            if (!wrap(scheduled))
+                break;
+
+            // Notes still on at the loop point are released there, before the next pass starts
+            if (scheduled.pass != pass)
+            {
+                lastScheduledTime = juce::jmax(lastScheduledTime, dueTimeOf(scheduled.pass * length));
+                scheduleNoteOffs(millisecondsAhead(lastScheduledTime));
+            }
+
+            auto due = juce::jmax(lastScheduledTime, dueTimeOf(fileTimeOf(scheduled)));
+            if (due > scheduleUntil)
+                break;
+
+            schedule(events[scheduled.index], millisecondsAhead(due));
+            lastScheduledTime = due;
+            ++scheduled.index;
+        }
+
+        if (!outputBlock.isEmpty())
+            blockCallback(outputBlock, startMillisecondCounter);
+
+        // Hand the callback everything that has come due. At the end of the file, it's the loop
+        // point that comes due next (from the end of the file rather than its last event, keeping
+        // the bar length), and notes still on are released there.
+        auto nextDispatchTime = [&]
+            {
+                return dispatched.index < events.size() ? dueTimeOf(fileTimeOf(dispatched))
+                                                        : dueTimeOf((dispatched.pass + 1) * length);
+            };
+
+        while (nextDispatchTime() <= now)
+        {
+            if (dispatched.index < events.size())
+            {
+                dispatch(events[dispatched.index]);
+                ++dispatched.index;
+            }
+            else if (wrap(dispatched))
+            {
+                releaseHeldNotes();
+            }
+            else
+            {
+                break;
+            }
+        }
+
+        if (dispatched.index >= events.size() && !(looping.load(std::memory_order_relaxed) && length > 0.0))
+            break;
+
+        // Sleep in short slices so tempo changes and stop requests are picked up quickly, and the
+        // output is kept a lookahead ahead
+        auto remaining = nextDispatchTime() - now;
+        if (remaining > 2000000)
+            juce::Thread::sleep(static_cast<int>(juce::jmin<juce::int64>(remaining - 2000000, lookaheadMs * 500000) / 1000000) + 1);
+        else
+            juce::Thread::yield();
+    }
+
+    // Notes already sent to the output are released after the last thing sent, so none is
+    // left hanging by a note-on still waiting to be played
+    outputBlock.clear();
+    scheduleNoteOffs(static_cast<int>(juce::jmax<juce::int64>(0, lastScheduledTime - LatencyMonitor::now()) / 1000000));
+    if (!outputBlock.isEmpty())
+        blockCallback(outputBlock, juce::Time::getMillisecondCounter());
+
+    releaseHeldNotes();
+    position.store(0.0, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+void MidiFilePlayer::dispatch(const Event& event)
+{
+    auto status = event.data[0] & 0xf0;
+    auto channel = event.data[0] & 0x0f;
+
+    if (status == 0x90 && event.data[2] > 0)
+        heldNotes[channel].setBit(event.data[1]);
+    else if (status == 0x80 || status == 0x90)
+        heldNotes[channel].clearBit(event.data[1]);
+
+    eventCallback(juce::MidiMessage(event.data, event.size));
+}
+
+//------------------------------------------------------------------------------
+void MidiFilePlayer::releaseHeldNotes()
+{
+    for (int channel = 0; channel < 16; ++channel)
+    {
+        for (int note = heldNotes[channel].findNextSetBit(0); note >= 0; note = heldNotes[channel].findNextSetBit(note + 1))
+            eventCallback(juce::MidiMessage::noteOff(channel + 1, note));
+
+        heldNotes[channel].clear();
+    }
+}
+
+//------------------------------------------------------------------------------
+void MidiFilePlayer::schedule(const Event& event, int millisecondsAhead)
+{
+    auto status = event.data[0] & 0xf0;
+    auto channel = event.data[0] & 0x0f;
+
+    if (status == 0x90 && event.data[2] > 0)
+        scheduledNotes[channel].setBit(event.data[1]);
+    else if (status == 0x80 || status == 0x90)
+        scheduledNotes[channel].clearBit(event.data[1]);
+
+    outputBlock.addEvent(event.data, event.size, millisecondsAhead);
+}
+
+void MidiFilePlayer::scheduleNoteOffs(int millisecondsAhead)
+{
+    for (int channel = 0; channel < 16; ++channel)
+    {
+        for (int note = scheduledNotes[channel].findNextSetBit(0); note >= 0; note = scheduledNotes[channel].findNextSetBit(note + 1))
+            outputBlock.addEvent(juce::MidiMessage::noteOff(channel + 1, note), millisecondsAhead);
+
+        scheduledNotes[channel].clear();
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <vector>
+
+//==============================================================================
+// Plays a Standard MIDI File from a dedicated thread. The file is parsed once
+// on load: every track is merged into one flat, time-sorted array of short
+// messages, so starting playback costs nothing and the playback thread only
+// walks an array. Events go out two ways from the playback thread:
+//  - to the MIDI output, a lookahead ahead of time, as timestamped blocks the
+//    output (or its scheduler) plays at the right moment;
+//  - to the event callback at their due time, for the OSC route. The thread
+//    sleeps until shortly before each one and yields for the last moment.
+// Either way event timing doesn't depend on how busy the message thread is. A
+// tempo change applies to events not yet sent to the output, so it takes up to
+// the lookahead to be heard there.
+class MidiFilePlayer : private juce::Thread
+{
+public:
+    // Called on the playback thread with each message at its due time.
+    using EventCallback = std::function<void(const juce::MidiMessage& message)>;
+
+    // Called on the playback thread with the events due within the lookahead; each event's
+    // sample position is in milliseconds after startMillisecondCounter.
+    using BlockCallback = std::function<void(const juce::MidiBuffer& block, juce::uint32 startMillisecondCounter)>;
+
+    MidiFilePlayer(BlockCallback outputCallback, EventCallback callback);
+    ~MidiFilePlayer() override;
+
+    // Parses the file (stopping any playback first); returns an error message, or an empty string.
+    juce::String load(const juce::File& file);
+
+    void play();
+    void stop();
+
+    bool isPlaying() const noexcept              { return isThreadRunning(); }
+    bool isLoaded() const noexcept               { return !events.empty(); }
+
+    // Playback speed relative to the file's own tempo map (1.0 = as written).
+    void setTempo(double newTempo) noexcept      { tempo.store(juce::jlimit(minTempo, maxTempo, newTempo), std::memory_order_relaxed); }
+    double getTempo() const noexcept             { return tempo.load(std::memory_order_relaxed); }
+
+    void setLooping(bool shouldLoop) noexcept    { looping.store(shouldLoop, std::memory_order_relaxed); }
+    bool isLooping() const noexcept              { return looping.load(std::memory_order_relaxed); }
+
+    double getPosition() const noexcept          { return position.load(std::memory_order_relaxed); }
+    double getLength() const noexcept            { return length; }
+    int getNumEvents() const noexcept            { return static_cast<int>(events.size()); }
+    juce::File getFile() const                   { return loadedFile; }
+
+    static constexpr double minTempo = 0.25;
+    static constexpr double maxTempo = 4.0;
+    static constexpr int lookaheadMs = 20;
+
+private:
+    // Channel voice messages only; meta events and SysEx are dropped at load time
+    struct Event
+    {
+        double time;            // seconds from the start of the file
+        juce::uint8 data[3];
+        juce::uint8 size;
+    };
+
+    // A place in playback: an event, and how many times the file has looped before it
+    struct Cursor
+    {
+        size_t index = 0;
+        int pass = 0;
+    };
+
+    void run() override;
+    void dispatch(const Event& event);
+    void releaseHeldNotes();
+
+    // Adds an event to outputBlock, at the given milliseconds after its start
+    void schedule(const Event& event, int millisecondsAhead);
+    void scheduleNoteOffs(int millisecondsAhead);
+
+    BlockCallback blockCallback;
+    EventCallback eventCallback;
+
+    std::vector<Event> events;
+    double length = 0.0;
+    juce::File loadedFile;
+
+    std::atomic<double> tempo { 1.0 };
+    std::atomic<bool> looping { false };
+    std::atomic<double> position { 0.0 };
+
+    // Notes currently on, per channel, so stopping mid-file doesn't leave them hanging: those
+    // dispatched to the event callback, and those already sent to the output
+    juce::BigInteger heldNotes[16];
+    juce::BigInteger scheduledNotes[16];
+
+    juce::MidiBuffer outputBlock;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MidiFilePlayer)
+};
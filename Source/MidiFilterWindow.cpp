@@ -0,0 +1,185 @@
+#include "MidiFilterWindow.h"
+
+MidiFilterWindow::MidiFilterWindow()
+    : DocumentWindow("MIDI Input Filter", juce::Colours::darkgrey, DocumentWindow::allButtons)
+{
+    setUsingNativeTitleBar(true);
+    setContentNonOwned(&filterComponent, true);
+    filterComponent.setSize(900, 500);
+    setResizable(true, true);
+    setResizeLimits(700, 400, 1600, 1000);
+    centreWithSize(getWidth(), getHeight());
+}
+
+MidiFilterWindow::~MidiFilterWindow()
+{
+    clearContentComponent();
+}
+
+void MidiFilterWindow::closeButtonPressed()
+{
+    setVisible(false);
+}
+
+void MidiFilterWindow::setFilter(MidiInputFilter* filter, const juce::String& deviceName)
+{
+    filterComponent.setFilter(filter, deviceName);
+}
+
+//==============================================================================
+MidiFilterWindow::FilterComponent::FilterComponent()
+{
+    addAndMakeVisible(deviceLabel);
+
+    resetCountersButton.setButtonText("Reset Counters");
+    resetCountersButton.onClick = [this]()
+        {
+            if (filter != nullptr)
+                filter->resetCounters();
+        };
+    addAndMakeVisible(resetCountersButton);
+
+    countersLabel.setJustificationType(juce::Justification::topLeft);
+    addAndMakeVisible(countersLabel);
+
+    for (int channel = 1; channel <= 16; ++channel)
+    {
+        auto* label = new juce::Label();
+        label->setText(juce::String(channel), juce::dontSendNotification);
+        label->setJustificationType(juce::Justification::centred);
+        addAndMakeVisible(label);
+        channelLabels.add(label);
+    }
+
+    // One toggle per channel for each channel voice message type
+    for (int type = 0; type < MidiInputFilter::numVoiceTypes; ++type)
+    {
+        auto* label = new juce::Label();
+        label->setText(MidiInputFilter::getVoiceTypeName(type), juce::dontSendNotification);
+        addAndMakeVisible(label);
+        voiceTypeLabels.add(label);
+
+        for (int channel = 1; channel <= 16; ++channel)
+        {
+            auto* toggle = new juce::ToggleButton();
+            toggle->onClick = [this, toggle, type, channel]()
+                {
+                    if (filter != nullptr)
+                        filter->setChannelEnabled(type, channel, toggle->getToggleState());
+                };
+            addAndMakeVisible(toggle);
+            voiceToggles.add(toggle);
+        }
+    }
+
+    // One toggle per defined system message
+    for (int type = 0; type < MidiInputFilter::numSystemTypes; ++type)
+    {
+        auto* name = MidiInputFilter::getSystemTypeName(type);
+        if (name == nullptr)
+            continue;
+
+        auto* toggle = new juce::ToggleButton(name);
+        toggle->onClick = [this, toggle, type]()
+            {
+                if (filter != nullptr)
+                    filter->setSystemEnabled(type, toggle->getToggleState());
+            };
+        addAndMakeVisible(toggle);
+        systemToggles.add(toggle);
+        systemToggleTypes.add(type);
+    }
+
+    setFilter(nullptr, {});
+    startTimerHz(4);
+}
+
+void MidiFilterWindow::FilterComponent::setFilter(MidiInputFilter* newFilter, const juce::String& deviceName)
+{
+    filter = newFilter;
+    deviceLabel.setText(filter != nullptr ? "Device: " + deviceName : juce::String("No MIDI input open"),
+                        juce::dontSendNotification);
+    updateToggles();
+    timerCallback();
+}
+
+void MidiFilterWindow::FilterComponent::updateToggles()
+{
+    for (int type = 0; type < MidiInputFilter::numVoiceTypes; ++type)
+    {
+        for (int channel = 1; channel <= 16; ++channel)
+        {
+            auto* toggle = voiceToggles[type * 16 + channel - 1];
+            toggle->setToggleState(filter != nullptr && filter->isChannelEnabled(type, channel), juce::dontSendNotification);
+            toggle->setEnabled(filter != nullptr);
+        }
+    }
+
+    for (int i = 0; i < systemToggles.size(); ++i)
+    {
+        systemToggles[i]->setToggleState(filter != nullptr && filter->isSystemEnabled(systemToggleTypes[i]), juce::dontSendNotification);
+        systemToggles[i]->setEnabled(filter != nullptr);
+    }
+}
+
+void MidiFilterWindow::FilterComponent::timerCallback()
+{
+    if (filter == nullptr)
+    {
+        countersLabel.setText({}, juce::dontSendNotification);
+        return;
+    }
+
+    juce::String text = "Passed: " + juce::String(filter->getNumPassed()) + "\nFiltered:";
+
+    for (int type = 0; type < MidiInputFilter::numVoiceTypes; ++type)
+        if (auto count = filter->getNumFiltered(type))
+            text += "\n  " + juce::String(MidiInputFilter::getVoiceTypeName(type)) + ": " + juce::String(count);
+
+    for (auto type : systemToggleTypes)
+        if (auto count = filter->getNumSystemFiltered(type))
+            text += "\n  " + juce::String(MidiInputFilter::getSystemTypeName(type)) + ": " + juce::String(count);
+
+    countersLabel.setText(text, juce::dontSendNotification);
+}
+
+void MidiFilterWindow::FilterComponent::resized()
+{
+    auto area = getLocalBounds().reduced(10);
+
+    auto topRow = area.removeFromTop(30);
+    resetCountersButton.setBounds(topRow.removeFromRight(130));
+    deviceLabel.setBounds(topRow);
+
+    countersLabel.setBounds(area.removeFromRight(200));
+
+    // Channel voice grid: type name column, then 16 channel columns
+    const int rowHeight = 26;
+    const int nameWidth = 130;
+    int columnWidth = (area.getWidth() - nameWidth) / 16;
+
+    auto headerRow = area.removeFromTop(rowHeight);
+    headerRow.removeFromLeft(nameWidth);
+    for (auto* label : channelLabels)
+        label->setBounds(headerRow.removeFromLeft(columnWidth));
+
+    for (int type = 0; type < MidiInputFilter::numVoiceTypes; ++type)
+    {
+        auto row = area.removeFromTop(rowHeight);
+        voiceTypeLabels[type]->setBounds(row.removeFromLeft(nameWidth));
+
+        for (int channel = 0; channel < 16; ++channel)
+            voiceToggles[type * 16 + channel]->setBounds(row.removeFromLeft(columnWidth).reduced(4, 0));
+    }
+
+    // System messages in rows of four
+    area.removeFromTop(10);
+    int systemWidth = area.getWidth() / 4;
+
+    for (int i = 0; i < systemToggles.size(); i += 4)
+    {
+        auto row = area.removeFromTop(rowHeight);
+        for (int j = i; j < juce::jmin(i + 4, systemToggles.size()); ++j)
+            systemToggles[j]->setBounds(row.removeFromLeft(systemWidth));
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "MidiInputFilter.h"
+
+// Pop-up window for editing the input filter of the current MIDI input device
+// and watching how much traffic it drops.
+class MidiFilterWindow : public juce::DocumentWindow
+{
+public:
+    MidiFilterWindow();
+    ~MidiFilterWindow() override;
+
+    void closeButtonPressed() override;
+
+    // Shows the filter of another device; filter may be nullptr when no input is open.
+    void setFilter(MidiInputFilter* filter, const juce::String& deviceName);
+
+private:
+    class FilterComponent : public juce::Component,
+                            private juce::Timer
+    {
+    public:
+        FilterComponent();
+
+        void setFilter(MidiInputFilter* filter, const juce::String& deviceName);
+        void resized() override;
+
+    private:
+        void timerCallback() override;
+        void updateToggles();
+
+        MidiInputFilter* filter = nullptr;
+
+        juce::Label deviceLabel;
+        juce::TextButton resetCountersButton;
+        juce::Label countersLabel;
+
+        juce::OwnedArray<juce::Label> channelLabels;
+        juce::OwnedArray<juce::Label> voiceTypeLabels;
+        juce::OwnedArray<juce::ToggleButton> voiceToggles;     // [voiceType * 16 + channel - 1]
+        juce::OwnedArray<juce::ToggleButton> systemToggles;
+        juce::Array<int> systemToggleTypes;                    // system type of each toggle
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FilterComponent)
+    };
+
+    FilterComponent filterComponent;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MidiFilterWindow)
+};
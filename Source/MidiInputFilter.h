@@ -0,0 +1,159 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+
+//==============================================================================
+// Channel x message-type masks for one MIDI input, checked on the raw status
+// byte at the very start of the MIDI callback so filtered traffic is dropped
+// before it is logged, queued or locked. Masks and counters are atomics, so the
+// UI can edit and read them while the MIDI thread is running.
+class MidiInputFilter
+{
+public:
+    // Channel voice messages are indexed by (status >> 4) - 8: note off, note on,
+    // poly pressure, controller, program change, channel pressure, pitch bend.
+    static constexpr int numVoiceTypes = 7;
+
+    // System messages are indexed by status & 0x0f (0xf0 sysex ... 0xff reset).
+    static constexpr int numSystemTypes = 16;
+
+    MidiInputFilter()
+    {
+        for (auto& mask : voiceMasks)
+            mask.store(0xffff, std::memory_order_relaxed);
+
+        // The bridge doesn't convert any system messages, so by default clock,
+        // active sensing and friends are dropped at the edge
+        systemMask.store(0, std::memory_order_relaxed);
+    }
+
+    //==================================================================
+    // Returns true if a message with this status byte should be processed.
+    bool accept(juce::uint8 status) noexcept
+    {
+        if (status >= 0xf0)
+        {
+            int type = status & 0x0f;
+            if ((systemMask.load(std::memory_order_relaxed) >> type) & 1)
+            {
+                numPassed.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+
+            systemFiltered[type].fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        // Data bytes never start a complete message
+        if (status < 0x80)
+            return false;
+
+        int type = (status >> 4) - 8;
+        int channel = status & 0x0f;
+
+        if ((voiceMasks[type].load(std::memory_order_relaxed) >> channel) & 1)
+        {
+            numPassed.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        voiceFiltered[type][channel].fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    //==================================================================
+    // channel is 1-16
+    void setChannelEnabled(int voiceType, int channel, bool enabled) noexcept
+    {
+        auto bit = static_cast<juce::uint16>(1 << (channel - 1));
+        if (enabled)
+            voiceMasks[voiceType].fetch_or(bit, std::memory_order_relaxed);
+        else
+            voiceMasks[voiceType].fetch_and(static_cast<juce::uint16>(~bit), std::memory_order_relaxed);
+    }
+
+    bool isChannelEnabled(int voiceType, int channel) const noexcept
+    {
+        return (voiceMasks[voiceType].load(std::memory_order_relaxed) >> (channel - 1)) & 1;
+    }
+
+    void setSystemEnabled(int systemType, bool enabled) noexcept
+    {
+        auto bit = static_cast<juce::uint16>(1 << systemType);
+        if (enabled)
+            systemMask.fetch_or(bit, std::memory_order_relaxed);
+        else
+            systemMask.fetch_and(static_cast<juce::uint16>(~bit), std::memory_order_relaxed);
+    }
+
+    bool isSystemEnabled(int systemType) const noexcept
+    {
+        return (systemMask.load(std::memory_order_relaxed) >> systemType) & 1;
+    }
+
+    //==================================================================
+    // Counters of what has been dropped (and let through) since the last reset.
+    juce::uint32 getNumFiltered(int voiceType) const noexcept
+    {
+        juce::uint32 total = 0;
+        for (auto& count : voiceFiltered[voiceType])
+            total += count.load(std::memory_order_relaxed);
+        return total;
+    }
+
+    juce::uint32 getNumFiltered(int voiceType, int channel) const noexcept
+    {
+        return voiceFiltered[voiceType][channel - 1].load(std::memory_order_relaxed);
+    }
+
+    juce::uint32 getNumSystemFiltered(int systemType) const noexcept
+    {
+        return systemFiltered[systemType].load(std::memory_order_relaxed);
+    }
+
+    juce::uint32 getNumPassed() const noexcept
+    {
+        return numPassed.load(std::memory_order_relaxed);
+    }
+
+    void resetCounters() noexcept
+    {
+        for (auto& channels : voiceFiltered)
+            for (auto& count : channels)
+                count.store(0, std::memory_order_relaxed);
+
+        for (auto& count : systemFiltered)
+            count.store(0, std::memory_order_relaxed);
+
+        numPassed.store(0, std::memory_order_relaxed);
+    }
+
+    //==================================================================
+    static const char* getVoiceTypeName(int voiceType) noexcept
+    {
+        static const char* const names[numVoiceTypes] = { "Note Off", "Note On", "Poly Pressure", "Controller",
+                                                          "Program Change", "Channel Pressure", "Pitch Bend" };
+        return names[voiceType];
+    }
+
+    // Returns nullptr for status bytes that are undefined or not message starts (0xf4, 0xf5, 0xf7, 0xf9, 0xfd).
+    static const char* getSystemTypeName(int systemType) noexcept
+    {
+        static const char* const names[numSystemTypes] = { "SysEx", "MTC Quarter Frame", "Song Position", "Song Select",
+                                                           nullptr, nullptr, "Tune Request", nullptr,
+                                                           "Clock", nullptr, "Start", "Continue",
+                                                           "Stop", nullptr, "Active Sensing", "Reset" };
+        return names[systemType];
+    }
+
+private:
+    std::atomic<juce::uint16> voiceMasks[numVoiceTypes];
+    std::atomic<juce::uint16> systemMask;
+
+    std::atomic<juce::uint32> voiceFiltered[numVoiceTypes][16] = {};
+    std::atomic<juce::uint32> systemFiltered[numSystemTypes] = {};
+    std::atomic<juce::uint32> numPassed { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MidiInputFilter)
+};
@@ -0,0 +1,302 @@
+#include "MidiOutputScheduler.h"
+#include "OscPacket.h"
+
+//==============================================================================
+MidiOutputScheduler::MidiOutputScheduler(SendCallback callback, int bytesPerSecondToUse)
+    : juce::Thread("MIDI output scheduler"),
+      sendCallback(std::move(callback)),
+      bytesPerSecond(juce::jmax(1, bytesPerSecondToUse))
+{
+    for (auto& slot : queuedSlot)
+        slot = -1;
+
+    timed.reserve(static_cast<size_t>(laneSize));
+    startThread(juce::Thread::Priority::high);
+}
+
+MidiOutputScheduler::~MidiOutputScheduler()
+{
+    signalThreadShouldExit();
+    wakeEvent.signal();
+    stopThread(2000);
+}
+
+//------------------------------------------------------------------------------
+bool MidiOutputScheduler::push(const juce::MidiMessage& message, juce::int64 dueTime)
+{
+    if (message.getRawDataSize() < 1)
+        return false;
+
+    auto now = LatencyMonitor::now();
+    {
+        const juce::ScopedLock lock(laneLock);
+        if (!(dueTime > now ? addTimed(message, dueTime) : addToLane(message, now)))
+            return false;
+    }
+
+    wakeEvent.signal();
+    return true;
+}
+
+void MidiOutputScheduler::clear()
+{
+    const juce::ScopedLock lock(laneLock);
+
+    for (auto& lane : lanes)
+        lane.head = lane.count = 0;
+
+    for (auto& slot : queuedSlot)
+        slot = -1;
+
+    timed.clear();
+}
+
+void MidiOutputScheduler::flushNotes(const SendCallback& send)
+{
+    signalThreadShouldExit();
+    wakeEvent.signal();
+    stopThread(2000);
+
+    std::vector<juce::MidiMessage> remaining;
+    {
+        const juce::ScopedLock lock(laneLock);
+        auto& lane = lanes[notes];
+
+        for (int i = 0; i < lane.count; ++i)
+            remaining.push_back(lane.entries[static_cast<size_t>((lane.head + i) % laneSize)].message);
+
+        for (auto& entry : timed)
+            if (entry.message.isNoteOff())
+                remaining.push_back(entry.message);
+    }
+
+    clear();
+
+    for (auto& message : remaining)
+        send(message);
+}
+
+//------------------------------------------------------------------------------
+bool MidiOutputScheduler::addToLane(const juce::MidiMessage& message, juce::int64 time)
+{
+    auto laneIndex = getLane(message);
+    auto& lane = lanes[laneIndex];
+    auto& laneStats = stats[laneIndex];
+
+    // A newer value takes the older one's place in the queue, and its waiting time
+    auto key = getCoalesceKey(message);
+    if (key >= 0 && queuedSlot[key] >= 0)
+    {
+        lane.entries[static_cast<size_t>(queuedSlot[key])].message = message;
+        laneStats.numCoalesced.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    if (lane.count == laneSize)
+    {
+        laneStats.numDropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    auto index = (lane.head + lane.count) % laneSize;
+    auto& entry = lane.entries[static_cast<size_t>(index)];
+    entry.message = message;
+    entry.time = time;
+    ++lane.count;
+
+    if (key >= 0)
+        queuedSlot[key] = index;
+
+    if (lane.count > laneStats.peakQueued.load(std::memory_order_relaxed))
+        laneStats.peakQueued.store(lane.count, std::memory_order_relaxed);
+
+    return true;
+}
+
+bool MidiOutputScheduler::addTimed(const juce::MidiMessage& message, juce::int64 dueTime)
+{
+    if (static_cast<int>(timed.size()) == laneSize)
+    {
+        stats[getLane(message)].numDropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // Equal times keep their order
+    auto position = std::upper_bound(timed.begin(), timed.end(), dueTime,
+                                     [](juce::int64 time, const Entry& entry) { return time < entry.time; });
+    timed.insert(position, { message, dueTime });
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// Moves what has come due into its lane; returns when the next timed message is due, or -1.
+juce::int64 MidiOutputScheduler::releaseDueMessages(juce::int64 now)
+{
+    size_t numDue = 0;
+    while (numDue < timed.size() && timed[numDue].time <= now)
+    {
+        addToLane(timed[numDue].message, timed[numDue].time);
+        ++numDue;
+    }
+
+    timed.erase(timed.begin(), timed.begin() + static_cast<std::ptrdiff_t>(numDue));
+    return timed.empty() ? -1 : timed.front().time;
+}
+
+bool MidiOutputScheduler::pop(juce::MidiMessage& message, juce::int64 now)
+{
+    for (int i = 0; i < numLanes; ++i)
+    {
+        auto& lane = lanes[i];
+        if (lane.count == 0)
+            continue;
+
+        auto& entry = lane.entries[static_cast<size_t>(lane.head)];
+        auto key = getCoalesceKey(entry.message);
+        if (key >= 0 && queuedSlot[key] == lane.head)
+            queuedSlot[key] = -1;
+
+        message = entry.message;
+        stats[i].delay.record(now - entry.time);
+        stats[i].numSent.fetch_add(1, std::memory_order_relaxed);
+
+        lane.head = (lane.head + 1) % laneSize;
+        --lane.count;
+        return true;
+    }
+
+    return false;
+}
+
+bool MidiOutputScheduler::hasQueued() const noexcept
+{
+    for (auto& lane : lanes)
+        if (lane.count > 0)
+            return true;
+
+    return false;
+}
+
+//------------------------------------------------------------------------------
+void MidiOutputScheduler::run()
+{
+    // When the wire will have finished sending everything written to the port so far
+    juce::int64 wireFreeAt = 0;
+
+    while (!threadShouldExit())
+    {
+        auto now = LatencyMonitor::now();
+        juce::MidiMessage message;
+        bool haveMessage = false, queued = false;
+        juce::int64 nextDue = -1;
+
+        {
+            const juce::ScopedLock lock(laneLock);
+            nextDue = releaseDueMessages(now);
+
+            if (wireFreeAt - now <= leadTime)
+                haveMessage = pop(message, now);
+
+            queued = hasQueued();
+        }
+
+        if (haveMessage)
+        {
+            sendCallback(message);
+            wireFreeAt = juce::jmax(wireFreeAt, now) + static_cast<juce::int64>(message.getRawDataSize()) * 1000000000 / bytesPerSecond;
+            continue;
+        }
+
+        // Until the wire has room, the next timed message is due, or something is pushed
+        juce::int64 wait = 100000000;
+        if (queued)
+            wait = wireFreeAt - leadTime - now;
+        if (nextDue >= 0)
+            wait = juce::jmin(wait, nextDue - now);
+
+        wakeEvent.wait(static_cast<int>(juce::jmax<juce::int64>(1, (wait + 999999) / 1000000)));
+    }
+}
+
+//------------------------------------------------------------------------------
+int MidiOutputScheduler::getLane(const juce::MidiMessage& message) noexcept
+{
+    auto status = message.getRawData()[0];
+
+    if (status >= 0xf8)
+        return realtime;
+
+    if ((status & 0xf0) == 0x80 || (status & 0xf0) == 0x90)
+        return notes;
+
+    return controllers;
+}
+
+int MidiOutputScheduler::getCoalesceKey(const juce::MidiMessage& message) noexcept
+{
+    auto* data = message.getRawData();
+    int channel = data[0] & 0x0f;
+
+    switch (data[0] & 0xf0)
+    {
+    case 0xa0: return message.getRawDataSize() == 3 ? channel * 128 + (data[1] & 0x7f) : -1;
+    case 0xb0: return message.getRawDataSize() == 3 ? 16 * 128 + channel * 128 + (data[1] & 0x7f) : -1;
+    case 0xd0: return 2 * 16 * 128 + channel;
+    case 0xe0: return 2 * 16 * 128 + 16 + channel;
+    default:   return -1;
+    }
+}
+
+const char* MidiOutputScheduler::getLaneName(int lane) noexcept
+{
+    static const char* const names[numLanes] = { "notes", "realtime", "controllers" };
+    return juce::isPositiveAndBelow(lane, static_cast<int>(numLanes)) ? names[lane] : "";
+}
+
+//------------------------------------------------------------------------------
+juce::String MidiOutputScheduler::getReport() const
+{
+    juce::String report;
+    auto toMilliseconds = [](juce::uint32 ns) { return juce::String(static_cast<double>(ns) / 1.0e6, 2); };
+
+    for (int lane = 0; lane < numLanes; ++lane)
+    {
+        auto& delay = getDelay(lane);
+        report << "MIDI output " << getLaneName(lane)
+               << ": " << static_cast<int>(getNumSent(lane)) << " sent"
+               << ", " << static_cast<int>(getNumCoalesced(lane)) << " coalesced"
+               << ", " << static_cast<int>(getNumDropped(lane)) << " dropped"
+               << ", peak " << getPeakQueued(lane) << " queued"
+               << ", delay p50 " << toMilliseconds(delay.getPercentile(0.5))
+               << " / p99 " << toMilliseconds(delay.getPercentile(0.99))
+               << " / max " << toMilliseconds(delay.getMax()) << " ms\n";
+    }
+
+    return report;
+}
+
+//------------------------------------------------------------------------------
+void MidiOutputScheduler::writeSnapshot(std::function<void(const char*, int)> sendPacket) const
+{
+    OscBundleWriter bundle;
+    OscMessageWriter message;
+    auto toMicroseconds = [](juce::uint32 ns) { return static_cast<float>(ns) / 1000.0f; };
+
+    for (int lane = 0; lane < numLanes; ++lane)
+    {
+        auto& delay = getDelay(lane);
+
+        message.begin("/bridge/stats/midiout");
+        message.addString(getLaneName(lane));
+        message.addInt32(static_cast<juce::int32>(getNumSent(lane)));
+        message.addInt32(static_cast<juce::int32>(getNumCoalesced(lane)));
+        message.addInt32(static_cast<juce::int32>(getNumDropped(lane)));
+        message.addInt32(getPeakQueued(lane));
+        message.addFloat32(toMicroseconds(delay.getPercentile(0.5)));
+        message.addFloat32(toMicroseconds(delay.getPercentile(0.99)));
+        message.addFloat32(toMicroseconds(delay.getMax()));
+        bundle.addMessage(message);
+    }
+
+    sendPacket(bundle.getData(), bundle.getSize());
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <vector>
+#include "LatencyMonitor.h"
+
+//==============================================================================
+// Paces one MIDI output port to the rate its wire can carry, so a backlog waits
+// here, where it can be reordered and thinned, instead of in the driver where
+// every note sits behind it. A 5-pin DIN port runs at 31250 baud with ten bits a
+// byte: 3125 bytes, or about a thousand three-byte messages, a second.
+//
+// Messages wait in three lanes, always served in this order: notes (on and off),
+// real-time (clock, start, stop...), then controllers and everything else. While
+// it waits, a queued controller, pitch bend or pressure value is replaced in
+// place by a newer one for the same channel and controller, so a backlog never
+// plays out stale values. The sending thread keeps track of when the wire will
+// be free and writes the next message only once less than leadTime of data is
+// still ahead of it. Messages due later (time-tagged OSC) wait in a timed list
+// until their time, then join their lane.
+//
+// push() and clear() may be called from any thread; messages go out through the
+// callback on the scheduler's own thread.
+class MidiOutputScheduler : private juce::Thread
+{
+public:
+    using SendCallback = std::function<void(const juce::MidiMessage& message)>;
+
+    MidiOutputScheduler(SendCallback callback, int bytesPerSecond);
+    ~MidiOutputScheduler() override;
+
+    int getBytesPerSecond() const noexcept { return bytesPerSecond; }
+
+    // Queues a message to go out as soon as its lane and the wire allow, or not before
+    // dueTime (LatencyMonitor::now() time). Returns false if it had to be dropped.
+    bool push(const juce::MidiMessage& message, juce::int64 dueTime = 0);
+
+    // Forgets everything waiting, e.g. when the port changes.
+    void clear();
+
+    // Stops the sending thread and hands what the note lane still holds, then any note-offs
+    // in the timed list, to send in order, so replacing or removing the scheduler doesn't
+    // leave notes hanging. Everything else waiting is dropped. Call without holding a lock
+    // the send callback takes.
+    void flushNotes(const SendCallback& send);
+
+    enum Lane
+    {
+        notes = 0,
+        realtime,
+        controllers,
+        numLanes
+    };
+
+    static const char* getLaneName(int lane) noexcept;
+
+    // Sent, coalesced and dropped counts, the longest queue and the time each sent
+    // message waited in its lane (a coalesced value counts from the one it replaced).
+    juce::uint32 getNumSent(int lane) const noexcept       { return stats[lane].numSent.load(std::memory_order_relaxed); }
+    juce::uint32 getNumCoalesced(int lane) const noexcept  { return stats[lane].numCoalesced.load(std::memory_order_relaxed); }
+    juce::uint32 getNumDropped(int lane) const noexcept    { return stats[lane].numDropped.load(std::memory_order_relaxed); }
+    int getPeakQueued(int lane) const noexcept             { return stats[lane].peakQueued.load(std::memory_order_relaxed); }
+    const LatencyHistogram& getDelay(int lane) const noexcept { return stats[lane].delay; }
+
+    // One line per lane
+    juce::String getReport() const;
+
+    // Encodes one /bridge/stats/midiout message per lane as a bundle, for the stats snapshot:
+    // s lane, i sent, i coalesced, i dropped, i peak queued, f delay p50, p99, max (microseconds)
+    void writeSnapshot(std::function<void(const char*, int)> sendPacket) const;
+
+    static constexpr int dinBytesPerSecond = 3125;
+    static constexpr int laneSize = 1024;
+    static constexpr juce::int64 leadTime = 2000000;   // ns of data written ahead of the wire
+
+private:
+    struct Entry
+    {
+        juce::MidiMessage message;
+        juce::int64 time = 0;   // when it joined its lane, or for the timed list when it's due
+    };
+
+    struct Queue
+    {
+        std::vector<Entry> entries = std::vector<Entry>(static_cast<size_t>(laneSize));
+        int head = 0, count = 0;
+    };
+
+    struct LaneStats
+    {
+        std::atomic<juce::uint32> numSent { 0 }, numCoalesced { 0 }, numDropped { 0 };
+        std::atomic<int> peakQueued { 0 };
+        LatencyHistogram delay;
+    };
+
+    void run() override;
+
+    // All with laneLock held
+    bool addToLane(const juce::MidiMessage& message, juce::int64 time);
+    bool addTimed(const juce::MidiMessage& message, juce::int64 dueTime);
+    juce::int64 releaseDueMessages(juce::int64 now);
+    bool pop(juce::MidiMessage& message, juce::int64 now);
+    bool hasQueued() const noexcept;
+
+    static int getLane(const juce::MidiMessage& message) noexcept;
+
+    // Index into queuedSlot for values a newer one supersedes (poly pressure and CC per
+    // channel and number, channel pressure and pitch bend per channel), or -1
+    static int getCoalesceKey(const juce::MidiMessage& message) noexcept;
+    static constexpr int numCoalesceKeys = 2 * 16 * 128 + 2 * 16;
+
+    SendCallback sendCallback;
+    const int bytesPerSecond;
+
+    juce::CriticalSection laneLock;
+    Queue lanes[numLanes];
+    int queuedSlot[numCoalesceKeys];   // controller lane entry holding each key's value, or -1
+    std::vector<Entry> timed;          // sorted by due time, at most laneSize entries
+
+    juce::WaitableEvent wakeEvent;
+    LaneStats stats[numLanes];
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MidiOutputScheduler)
+};
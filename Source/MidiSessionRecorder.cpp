@@ -0,0 +1,199 @@
+#include "MidiSessionRecorder.h"
+#include "LatencyMonitor.h"
+
+namespace
+{
+    const char* const trackNames[MidiSessionRecorder::numRoutes] = { "MIDI -> OSC", "OSC -> MIDI" };
+}
+
+//==============================================================================
+MidiSessionRecorder::MidiSessionRecorder(WrittenCallback callback)
+    : juce::Thread("MIDI session recorder"),
+      writtenCallback(std::move(callback))
+{
+    chunks.reserve(maxChunks);
+    writtenEvent.signal();
+}
+
+MidiSessionRecorder::~MidiSessionRecorder()
+{
+    stop();
+    stopThread(10000);
+}
+
+//------------------------------------------------------------------------------
+bool MidiSessionRecorder::start(const juce::File& file)
+{
+    stop();
+
+    if (writing.load(std::memory_order_acquire))
+        return false;
+
+    {
+        const juce::SpinLock::ScopedLockType lock(recordLock);
+
+        chunks.clear();
+        chunks.push_back(std::make_unique<Chunk>());
+        if (spareChunk == nullptr)
+            spareChunk = std::make_unique<Chunk>();
+
+        eventsInChunk = 0;
+        recordingFile = file;
+        numRecorded.store(0, std::memory_order_relaxed);
+        numDropped.store(0, std::memory_order_relaxed);
+        startTimeNs = LatencyMonitor::now();
+        recording.store(true, std::memory_order_release);
+    }
+
+    if (!isThreadRunning())
+        startThread(juce::Thread::Priority::low);
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void MidiSessionRecorder::stop()
+{
+    {
+        const juce::SpinLock::ScopedLockType lock(recordLock);
+
+        if (!recording.load(std::memory_order_relaxed))
+            return;
+
+        recording.store(false, std::memory_order_relaxed);
+        writing.store(true, std::memory_order_release);
+        writtenEvent.reset();
+    }
+
+    notify();
+}
+
+bool MidiSessionRecorder::waitForWrite(int timeoutMilliseconds)
+{
+    return writtenEvent.wait(timeoutMilliseconds);
+}
+
+//------------------------------------------------------------------------------
+void MidiSessionRecorder::record(int route, const juce::uint8* data, int size) noexcept
+{
+    if (!recording.load(std::memory_order_acquire) || size < 1 || size > 3)
+        return;
+
+    auto time = LatencyMonitor::now() - startTimeNs;
+    bool needsSpare = false;
+
+    {
+        const juce::SpinLock::ScopedLockType lock(recordLock);
+
+        if (!recording.load(std::memory_order_relaxed))
+            return;
+
+        if (eventsInChunk == eventsPerChunk)
+        {
+            if (spareChunk == nullptr || chunks.size() == chunks.capacity())
+            {
+                numDropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            chunks.push_back(std::move(spareChunk));
+            eventsInChunk = 0;
+            needsSpare = true;
+        }
+
+        auto& event = chunks.back()->events[eventsInChunk++];
+        event.time = time;
+        event.route = static_cast<juce::uint8>(route);
+        event.size = static_cast<juce::uint8>(size);
+        std::memcpy(event.data, data, static_cast<size_t>(size));
+    }
+
+    numRecorded.fetch_add(1, std::memory_order_relaxed);
+
+    if (needsSpare)
+        notify();
+}
+
+//------------------------------------------------------------------------------
+void MidiSessionRecorder::run()
+{
+    while (!threadShouldExit())
+    {
+        wait(-1);
+
+        // Replace the spare outside the lock so producers never wait on an allocation
+        bool hasSpare;
+        {
+            const juce::SpinLock::ScopedLockType lock(recordLock);
+            hasSpare = spareChunk != nullptr;
+        }
+
+        if (!hasSpare)
+        {
+            auto newChunk = std::make_unique<Chunk>();
+            const juce::SpinLock::ScopedLockType lock(recordLock);
+            spareChunk = std::move(newChunk);
+        }
+
+        if (!writing.load(std::memory_order_acquire))
+            continue;
+
+        std::vector<std::unique_ptr<Chunk>> chunksToWrite;
+        int eventsInLastChunk;
+        {
+            const juce::SpinLock::ScopedLockType lock(recordLock);
+            chunksToWrite.swap(chunks);
+            chunks.reserve(maxChunks);
+            eventsInLastChunk = eventsInChunk;
+        }
+
+        auto error = writeFile(chunksToWrite, eventsInLastChunk);
+
+        if (writtenCallback)
+            writtenCallback(recordingFile, error);
+
+        const juce::SpinLock::ScopedLockType lock(recordLock);
+        writing.store(false, std::memory_order_release);
+        writtenEvent.signal();
+    }
+}
+
+//------------------------------------------------------------------------------
+juce::String MidiSessionRecorder::writeFile(const std::vector<std::unique_ptr<Chunk>>& chunksToWrite, int eventsInLastChunk) const
+{
+    // A fixed 120 bpm, so one quarter note is half a second
+    constexpr double ticksPerSecond = ticksPerQuarterNote * 2.0;
+
+    juce::MidiMessageSequence conductor;
+    conductor.addEvent(juce::MidiMessage::tempoMetaEvent(500000), 0.0);
+    conductor.addEvent(juce::MidiMessage::timeSignatureMetaEvent(4, 4), 0.0);
+
+    juce::MidiMessageSequence tracks[numRoutes];
+    for (int route = 0; route < numRoutes; ++route)
+        tracks[route].addEvent(juce::MidiMessage::textMetaEvent(3, trackNames[route]), 0.0);
+
+    for (size_t i = 0; i < chunksToWrite.size(); ++i)
+    {
+        auto numEvents = i + 1 < chunksToWrite.size() ? eventsPerChunk : eventsInLastChunk;
+
+        for (int j = 0; j < numEvents; ++j)
+        {
+            auto& event = chunksToWrite[i]->events[j];
+            auto ticks = std::round(static_cast<double>(event.time) / 1.0e9 * ticksPerSecond);
+            tracks[event.route].addEvent(juce::MidiMessage(event.data, event.size), ticks);
+        }
+    }
+
+    juce::MidiFile midiFile;
+    midiFile.setTicksPerQuarterNote(ticksPerQuarterNote);
+    midiFile.addTrack(conductor);
+    for (auto& track : tracks)
+        midiFile.addTrack(track);
+
+    recordingFile.deleteFile();
+    juce::FileOutputStream stream(recordingFile);
+    if (!stream.openedOk() || !midiFile.writeTo(stream))
+        return "Couldn't write " + recordingFile.getFullPathName();
+
+    return {};
+}
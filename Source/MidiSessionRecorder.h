@@ -0,0 +1,86 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <vector>
+
+//==============================================================================
+// Records the MIDI that leaves the bridge in both directions and writes it out
+// as a multi-track Standard MIDI File (a conductor track plus one track per
+// route) when recording stops.
+//
+// Events go into fixed-size chunks. A spare chunk is always allocated ahead by
+// the background thread, so record() never allocates: when the current chunk
+// fills it takes the spare, and only if the background thread hasn't replaced
+// it yet is the event dropped and counted. Building and writing the file also
+// happens on the background thread.
+class MidiSessionRecorder : private juce::Thread
+{
+public:
+    // Indexed like TransformWindow::Route
+    static constexpr int numRoutes = 2;
+
+    // Called on the background thread once the file has been written (or failed).
+    using WrittenCallback = std::function<void(const juce::File& file, const juce::String& error)>;
+
+    explicit MidiSessionRecorder(WrittenCallback callback);
+    ~MidiSessionRecorder() override;
+
+    // Starts a new recording that will be written to the file; returns false while
+    // the previous recording is still being written.
+    bool start(const juce::File& file);
+
+    // Stops recording and writes the file in the background.
+    void stop();
+
+    // Blocks until no recording is being written (the written callback has returned);
+    // returns false if that took longer than the timeout.
+    bool waitForWrite(int timeoutMilliseconds);
+
+    bool isRecording() const noexcept { return recording.load(std::memory_order_relaxed); }
+    bool isWriting() const noexcept   { return writing.load(std::memory_order_relaxed); }
+
+    // Short channel messages only (1-3 bytes); may be called from any thread.
+    void record(int route, const juce::uint8* data, int size) noexcept;
+
+    juce::uint64 getNumRecorded() const noexcept { return numRecorded.load(std::memory_order_relaxed); }
+    juce::uint64 getNumDropped() const noexcept  { return numDropped.load(std::memory_order_relaxed); }
+    juce::File getFile() const                   { return recordingFile; }
+
+    static constexpr int eventsPerChunk = 16384;
+    static constexpr int maxChunks = 4096;
+    static constexpr int ticksPerQuarterNote = 960;
+
+private:
+    struct Event
+    {
+        juce::int64 time;       // ns since the recording started
+        juce::uint8 route;
+        juce::uint8 size;
+        juce::uint8 data[3];
+    };
+
+    struct Chunk
+    {
+        Event events[eventsPerChunk];
+    };
+
+    void run() override;
+    juce::String writeFile(const std::vector<std::unique_ptr<Chunk>>& chunksToWrite, int eventsInLastChunk) const;
+
+    WrittenCallback writtenCallback;
+
+    std::atomic<bool> recording { false }, writing { false };
+    juce::WaitableEvent writtenEvent { true };  // signalled while not writing; set and reset with writing, under recordLock
+    juce::int64 startTimeNs = 0;
+    juce::File recordingFile;
+
+    juce::SpinLock recordLock;                  // serialises producers and chunk hand-over
+    std::vector<std::unique_ptr<Chunk>> chunks; // capacity reserved up front, so adding a chunk doesn't allocate
+    std::unique_ptr<Chunk> spareChunk;
+    int eventsInChunk = 0;
+
+    std::atomic<juce::uint64> numRecorded { 0 }, numDropped { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MidiSessionRecorder)
+};
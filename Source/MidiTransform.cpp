@@ -0,0 +1,171 @@
+#include "MidiTransform.h"
+
+//==============================================================================
+MidiTransform::Ptr MidiTransform::compile(const Settings& newSettings)
+{
+    Ptr transform(new MidiTransform());
+    transform->settings = newSettings;
+    auto& s = transform->settings;
+
+    // Channel remap
+    for (int channel = 0; channel < 16; ++channel)
+    {
+        int target = s.channelMap[channel];
+        transform->channelTable[channel] = static_cast<juce::int8>(target >= 1 && target <= 16 ? target : -1);
+    }
+
+    // Transpose + scale quantisation
+    for (int note = 0; note < 128; ++note)
+    {
+        int transposed = note + s.transpose;
+        int quantised = -1;
+
+        // Nearest allowed pitch class, preferring the lower one on a tie
+        for (int distance = 0; distance <= 6 && quantised < 0; ++distance)
+        {
+            for (int candidate : { transposed - distance, transposed + distance })
+            {
+                int pitchClass = ((candidate - s.scaleRoot) % 12 + 12) % 12;
+                if ((s.scaleMask >> pitchClass) & 1)
+                {
+                    quantised = candidate;
+                    break;
+                }
+            }
+        }
+
+        transform->noteTable[note] = static_cast<juce::int8>(quantised >= 0 && quantised <= 127 ? quantised : -1);
+    }
+
+    // Velocity curve; velocity 0 means note-off and is left alone
+    int velocityMin = juce::jlimit(1, 127, s.velocityMin);
+    int velocityMax = juce::jlimit(velocityMin, 127, s.velocityMax);
+
+    transform->velocityTable[0] = 0;
+    for (int velocity = 1; velocity < 128; ++velocity)
+    {
+        float shaped = applyCurve(s.velocityCurve, s.velocityAmount, static_cast<float>(velocity - 1) / 126.0f);
+        transform->velocityTable[velocity] = static_cast<juce::uint8>(
+            juce::jlimit(velocityMin, velocityMax, velocityMin + juce::roundToInt(shaped * static_cast<float>(velocityMax - velocityMin))));
+    }
+
+    // Controller/pressure range and curve (ccMin > ccMax inverts)
+    int ccMin = juce::jlimit(0, 127, s.ccMin);
+    int ccMax = juce::jlimit(0, 127, s.ccMax);
+
+    for (int value = 0; value < 128; ++value)
+    {
+        float shaped = applyCurve(s.ccCurve, s.ccAmount, static_cast<float>(value) / 127.0f);
+        transform->controllerTable[value] = static_cast<juce::uint8>(
+            juce::jlimit(0, 127, ccMin + juce::roundToInt(shaped * static_cast<float>(ccMax - ccMin))));
+    }
+
+    // Pitch bend scaling around the centre
+    float bendScale = s.invertPitchBend ? -s.pitchBendAmount : s.pitchBendAmount;
+
+    for (int value = 0; value < 16384; ++value)
+    {
+        float deflection = static_cast<float>(value - 8192) * bendScale;
+        transform->pitchBendTable[value] = static_cast<juce::uint16>(juce::jlimit(0, 16383, 8192 + juce::roundToInt(deflection)));
+    }
+
+    return transform;
+}
+
+//------------------------------------------------------------------------------
+float MidiTransform::applyCurve(Curve curve, float amount, float x) noexcept
+{
+    float exponent = 1.0f + 3.0f * juce::jlimit(0.0f, 1.0f, amount);
+
+    switch (curve)
+    {
+    case Curve::Exponential:
+        return std::pow(x, exponent);
+
+    case Curve::Logarithmic:
+        return 1.0f - std::pow(1.0f - x, exponent);
+
+    case Curve::SCurve:
+    {
+        // Symmetric power curve around the midpoint
+        float half = x < 0.5f ? x * 2.0f : (1.0f - x) * 2.0f;
+        float shaped = 0.5f * std::pow(half, exponent);
+        return x < 0.5f ? shaped : 1.0f - shaped;
+    }
+
+    case Curve::Linear:
+    default:
+        return x;
+    }
+}
+
+//------------------------------------------------------------------------------
+bool MidiTransform::apply(juce::uint8* data, int size) const noexcept
+{
+    if (size < 1 || data[0] < 0x80 || data[0] >= 0xf0)
+        return true;
+
+    int channel = channelTable[data[0] & 0x0f];
+    if (channel < 0)
+        return false;
+
+    int type = data[0] & 0xf0;
+    data[0] = static_cast<juce::uint8>(type | (channel - 1));
+
+    switch (type)
+    {
+    case 0x80:   // note off
+    case 0x90:   // note on
+    case 0xa0:   // poly pressure
+    {
+        if (size < 3)
+            return false;
+
+        int note = noteTable[data[1] & 127];
+        if (note < 0)
+            return false;
+
+        data[1] = static_cast<juce::uint8>(note);
+
+        if (type == 0x90)
+            data[2] = velocityTable[data[2] & 127];
+        else if (type == 0xa0)
+            data[2] = controllerTable[data[2] & 127];
+    }
+    break;
+
+    case 0xb0:   // controller
+        if (size < 3)
+            return false;
+        data[2] = controllerTable[data[2] & 127];
+        break;
+
+    case 0xd0:   // channel pressure
+        if (size < 2)
+            return false;
+        data[1] = controllerTable[data[1] & 127];
+        break;
+
+    case 0xe0:   // pitch bend
+    {
+        if (size < 3)
+            return false;
+
+        int bend = pitchBendTable[(data[1] & 127) | ((data[2] & 127) << 7)];
+        data[1] = static_cast<juce::uint8>(bend & 127);
+        data[2] = static_cast<juce::uint8>(bend >> 7);
+    }
+    break;
+
+    default:
+        break;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+juce::StringArray MidiTransform::getCurveNames()
+{
+    return { "Linear", "Exponential", "Logarithmic", "S-Curve" };
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// Per-route MIDI transformation: velocity curve, CC/pressure range and curve,
+// transpose, scale quantisation, channel remap and pitch bend scaling.
+//
+// Settings are compiled into lookup tables when they change, so applying a
+// transform to an event is a handful of table loads however complicated the
+// mapping is. A compiled transform is immutable; changing settings means
+// compiling a new one and swapping the pointer.
+class MidiTransform : public juce::ReferenceCountedObject
+{
+public:
+    using Ptr = juce::ReferenceCountedObjectPtr<MidiTransform>;
+
+    enum class Curve
+    {
+        Linear,
+        Exponential,   // softer start, more resolution at the top
+        Logarithmic,   // harder start
+        SCurve
+    };
+
+    struct Settings
+    {
+        // Velocities 1-127 are mapped onto [velocityMin, velocityMax]; 0 stays 0.
+        Curve velocityCurve = Curve::Linear;
+        float velocityAmount = 0.5f;    // curve strength, 0-1
+        int velocityMin = 1, velocityMax = 127;
+
+        // Controller values and channel/poly pressure are mapped onto [ccMin, ccMax].
+        Curve ccCurve = Curve::Linear;
+        float ccAmount = 0.5f;
+        int ccMin = 0, ccMax = 127;
+
+        // Notes are transposed, then moved to the nearest pitch class allowed
+        // by scaleMask (bit n = root + n semitones). Notes pushed outside
+        // 0-127 are dropped.
+        int transpose = 0;
+        int scaleRoot = 0;
+        juce::uint16 scaleMask = 0x0fff;
+
+        // channelMap[c - 1] is the output channel for channel c (1-16), or 0 to drop it.
+        int channelMap[16] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 };
+
+        // Pitch bend deflection is scaled around the centre (and optionally inverted).
+        float pitchBendAmount = 1.0f;
+        bool invertPitchBend = false;
+    };
+
+    static Ptr compile(const Settings& settings);
+
+    const Settings& getSettings() const noexcept { return settings; }
+
+    //==================================================================
+    // Table lookups; a negative result means the event should be dropped.
+    int mapChannel(int channel) const noexcept      { return channelTable[(channel - 1) & 15]; }
+    int mapNote(int note) const noexcept            { return noteTable[note & 127]; }
+    int mapVelocity(int velocity) const noexcept    { return velocityTable[velocity & 127]; }
+    int mapController(int value) const noexcept     { return controllerTable[value & 127]; }
+    int mapPitchBend(int value) const noexcept      { return pitchBendTable[value & 16383]; }
+
+    // Transforms a raw channel message in place; returns false if it should be dropped.
+    // System messages pass through untouched.
+    bool apply(juce::uint8* data, int size) const noexcept;
+
+    static juce::StringArray getCurveNames();
+
+private:
+    MidiTransform() = default;
+
+    static float applyCurve(Curve curve, float amount, float x) noexcept;
+
+    Settings settings;
+
+    juce::int8 channelTable[16] = {};
+    juce::int8 noteTable[128] = {};
+    juce::uint8 velocityTable[128] = {};
+    juce::uint8 controllerTable[128] = {};
+    juce::uint16 pitchBendTable[16384] = {};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MidiTransform)
+};
@@ -0,0 +1,407 @@
+#include "OscPacket.h"
+
+namespace
+{
+    void writeBigEndian(char* dest, juce::uint32 value) noexcept
+    {
+        value = juce::ByteOrder::swapIfLittleEndian(value);
+        std::memcpy(dest, &value, sizeof(value));
+    }
+
+    // Length of the padded, null-terminated OSC string starting at data, or -1
+    // if no terminator is found before end.
+    int paddedStringLength(const char* data, const char* end) noexcept
+    {
+        auto* terminator = static_cast<const char*>(std::memchr(data, 0, static_cast<size_t>(end - data)));
+        if (terminator == nullptr)
+            return -1;
+
+        int length = OscPacket::padded(static_cast<int>(terminator - data) + 1);
+        return length <= end - data ? length : -1;
+    }
+}
+
+//==============================================================================
+void OscMessageWriter::begin(const char* newAddress) noexcept
+{
+    addressLength = juce::jmin(static_cast<int>(std::strlen(newAddress)), static_cast<int>(sizeof(address)) - 1);
+    std::memcpy(address, newAddress, static_cast<size_t>(addressLength));
+    address[addressLength] = 0;
+
+    numArguments = 0;
+    argumentsSize = 0;
+}
+
+//------------------------------------------------------------------------------
+bool OscMessageWriter::addTypeTag(char tag, int argumentSize) noexcept
+{
+    if (numArguments >= maxArguments)
+        return false;
+
+    // Check the finished message will still fit in a single packet
+    int newSize = OscPacket::padded(addressLength + 1)
+                + OscPacket::padded(numArguments + 3)
+                + argumentsSize + argumentSize;
+
+    if (newSize > OscPacket::maxPacketSize)
+        return false;
+
+    typeTags[++numArguments] = tag;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool OscMessageWriter::addInt32(juce::int32 value) noexcept
+{
+    if (!addTypeTag('i', 4))
+        return false;
+
+    writeBigEndian(arguments + argumentsSize, static_cast<juce::uint32>(value));
+    argumentsSize += 4;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool OscMessageWriter::addFloat32(float value) noexcept
+{
+    if (!addTypeTag('f', 4))
+        return false;
+
+    juce::uint32 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    writeBigEndian(arguments + argumentsSize, bits);
+    argumentsSize += 4;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool OscMessageWriter::addString(const char* text) noexcept
+{
+    int length = static_cast<int>(std::strlen(text));
+    int size = OscPacket::padded(length + 1);
+
+    if (!addTypeTag('s', size))
+        return false;
+
+    std::memcpy(arguments + argumentsSize, text, static_cast<size_t>(length));
+    std::memset(arguments + argumentsSize + length, 0, static_cast<size_t>(size - length));
+    argumentsSize += size;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool OscMessageWriter::addMidi(juce::uint8 port, juce::uint8 status, juce::uint8 data1, juce::uint8 data2) noexcept
+{
+    if (!addTypeTag('m', 4))
+        return false;
+
+    auto* dest = arguments + argumentsSize;
+    dest[0] = static_cast<char>(port);
+    dest[1] = static_cast<char>(status);
+    dest[2] = static_cast<char>(data1);
+    dest[3] = static_cast<char>(data2);
+    argumentsSize += 4;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+int OscMessageWriter::getSize() const noexcept
+{
+    return OscPacket::padded(addressLength + 1)
+         + OscPacket::padded(numArguments + 2)
+         + argumentsSize;
+}
+
+//------------------------------------------------------------------------------
+int OscMessageWriter::write(char* dest, int destSize) const noexcept
+{
+    int size = getSize();
+    if (size > destSize)
+        return 0;
+
+    std::memset(dest, 0, static_cast<size_t>(size - argumentsSize));
+
+    std::memcpy(dest, address, static_cast<size_t>(addressLength));
+    auto* tagsStart = dest + OscPacket::padded(addressLength + 1);
+
+    std::memcpy(tagsStart, typeTags, static_cast<size_t>(numArguments + 1));
+    auto* argumentsStart = tagsStart + OscPacket::padded(numArguments + 2);
+
+    std::memcpy(argumentsStart, arguments, static_cast<size_t>(argumentsSize));
+    return size;
+}
+
+//==============================================================================
+void OscBundleWriter::begin(juce::uint64 timeTag) noexcept
+{
+    std::memcpy(data, "#bundle", 8);
+    writeBigEndian(data + 8, static_cast<juce::uint32>(timeTag >> 32));
+    writeBigEndian(data + 12, static_cast<juce::uint32>(timeTag));
+
+    size = headerSize;
+    numElements = 0;
+}
+
+//------------------------------------------------------------------------------
+bool OscBundleWriter::addMessage(const OscMessageWriter& message) noexcept
+{
+    // Each element is a big-endian size followed by the message itself
+    int messageSize = message.getSize();
+    if (size + 4 + messageSize > static_cast<int>(sizeof(data)))
+        return false;
+
+    writeBigEndian(data + size, static_cast<juce::uint32>(messageSize));
+    message.write(data + size + 4, messageSize);
+
+    size += 4 + messageSize;
+    ++numElements;
+    return true;
+}
+
+//==============================================================================
+bool OscMessageReader::parse(const char* data, int dataSize) noexcept
+{
+    address = typeTags = nullptr;
+    numArguments = nextArgument = 0;
+    position = data;
+    end = data + dataSize;
+
+    if (data == nullptr || dataSize < 4 || (dataSize % 4) != 0 || data[0] != '/')
+        return false;
+
+    int addressSize = paddedStringLength(position, end);
+    if (addressSize < 0)
+        return false;
+
+    address = position;
+    position += addressSize;
+
+    // A message without a type tag string is legal OSC 1.0 and simply has no arguments
+    if (position == end)
+    {
+        typeTags = "";
+        return true;
+    }
+
+    if (*position != ',')
+        return false;
+
+    int tagsSize = paddedStringLength(position, end);
+    if (tagsSize < 0)
+        return false;
+
+    typeTags = position + 1;
+    numArguments = static_cast<int>(std::strlen(typeTags));
+    position += tagsSize;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+char OscMessageReader::getNextType() const noexcept
+{
+    return nextArgument < numArguments ? typeTags[nextArgument] : 0;
+}
+
+//------------------------------------------------------------------------------
+bool OscMessageReader::readFourBytes(char expectedType, juce::uint32& result) noexcept
+{
+    if (getNextType() != expectedType || end - position < 4)
+        return false;
+
+    result = juce::ByteOrder::bigEndianInt(position);
+    position += 4;
+    ++nextArgument;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool OscMessageReader::readInt32(juce::int32& result) noexcept
+{
+    juce::uint32 bits;
+    if (!readFourBytes('i', bits))
+        return false;
+
+    result = static_cast<juce::int32>(bits);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool OscMessageReader::readFloat32(float& result) noexcept
+{
+    juce::uint32 bits;
+    if (!readFourBytes('f', bits))
+        return false;
+
+    std::memcpy(&result, &bits, sizeof(result));
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool OscMessageReader::readString(const char*& result) noexcept
+{
+    if (getNextType() != 's')
+        return false;
+
+    int size = paddedStringLength(position, end);
+    if (size < 0)
+        return false;
+
+    result = position;
+    position += size;
+    ++nextArgument;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool OscMessageReader::readMidi(juce::uint8 (&result)[4]) noexcept
+{
+    if (getNextType() != 'm' || end - position < 4)
+        return false;
+
+    std::memcpy(result, position, 4);
+    position += 4;
+    ++nextArgument;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool OscMessageReader::skip() noexcept
+{
+    switch (getNextType())
+    {
+    case 'i': case 'f': case 'c': case 'r': case 'm':
+        if (end - position < 4)
+            return false;
+        position += 4;
+        break;
+
+    case 'h': case 'd': case 't':
+        if (end - position < 8)
+            return false;
+        position += 8;
+        break;
+
+    case 's': case 'S':
+    {
+        int size = paddedStringLength(position, end);
+        if (size < 0)
+            return false;
+        position += size;
+    }
+    break;
+
+    case 'b':
+    {
+        if (end - position < 4)
+            return false;
+
+        // Checked in 64 bits: padding a length near INT_MAX would overflow an int
+        auto size = static_cast<juce::int64>(juce::ByteOrder::bigEndianInt(position));
+        if (((size + 3) & ~static_cast<juce::int64>(3)) > end - position - 4)
+            return false;
+        position += 4 + OscPacket::padded(static_cast<int>(size));
+    }
+    break;
+
+    case 'T': case 'F': case 'N': case 'I':
+        break;   // no argument data
+
+    default:
+        return false;
+    }
+
+    ++nextArgument;
+    return true;
+}
+
+//==============================================================================
+bool OscBundleReader::parse(const char* data, int dataSize) noexcept
+{
+    position = end = nullptr;
+
+    if (data == nullptr || !OscPacket::isBundle(data, dataSize) || (dataSize % 4) != 0)
+        return false;
+
+    timeTag = juce::ByteOrder::bigEndianInt64(data + 8);
+
+    position = data + 16;
+    end = data + dataSize;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool OscBundleReader::getNextElement(const char*& elementData, int& elementSize) noexcept
+{
+    if (end - position < 4)
+        return false;
+
+    auto size = static_cast<int>(juce::ByteOrder::bigEndianInt(position));
+    if (size <= 0 || (size % 4) != 0 || size > end - position - 4)
+    {
+        position = end;
+        return false;
+    }
+
+    elementData = position + 4;
+    elementSize = size;
+    position += 4 + size;
+    return true;
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+#include "ProtocolProfile.h"
+
+class OscPacketTests : public juce::UnitTest
+{
+public:
+    OscPacketTests() : juce::UnitTest("OscPacket", "OSC") {}
+
+    void runTest() override
+    {
+        beginTest("Blob lengths that would overflow when padded are rejected");
+        {
+            for (auto length : { 0x7ffffffdu, 0x7ffffffeu, 0x7fffffffu, 0x80000000u, 0xffffffffu })
+            {
+                // "/midi" ,bm <blob length> then an 'm' argument that must never be reached
+                const char packet[] = { '/', 'm', 'i', 'd', 'i', 0, 0, 0,
+                                        ',', 'b', 'm', 0,
+                                        static_cast<char>(length >> 24), static_cast<char>(length >> 16),
+                                        static_cast<char>(length >> 8), static_cast<char>(length),
+                                        0, static_cast<char>(0x90), 60, 100 };
+
+                OscMessageReader reader;
+                expect(reader.parse(packet, static_cast<int>(sizeof(packet))));
+                expect(!reader.skip(), "blob length " + juce::String::toHexString(static_cast<int>(length)));
+                expectEquals(static_cast<int>(reader.getNextType()), static_cast<int>('b'));
+
+                float arguments[ProtocolProfile::maxArguments];
+                OscMessageReader decoder;
+                decoder.parse(packet, static_cast<int>(sizeof(packet)));
+                expectEquals(ProtocolProfile::readArguments(decoder, arguments), 0);
+            }
+        }
+
+        beginTest("A blob that exactly fills the packet is skipped");
+        {
+            const char packet[] = { '/', 'm', 'i', 'd', 'i', 0, 0, 0,
+                                    ',', 'b', 'm', 0,
+                                    0, 0, 0, 3, 1, 2, 3, 0,
+                                    0, static_cast<char>(0x90), 60, 100 };
+
+            OscMessageReader reader;
+            expect(reader.parse(packet, static_cast<int>(sizeof(packet))));
+            expect(reader.skip());
+
+            juce::uint8 midi[4] = {};
+            expect(reader.readMidi(midi));
+            expectEquals(static_cast<int>(midi[1]), 0x90);
+            expect(!reader.skip());
+        }
+    }
+};
+
+static OscPacketTests oscPacketTests;
+
+#endif
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// Hand-rolled OSC 1.0 message encoding/decoding.
+//
+// juce::OSCSender and juce::OSCReceiver don't support the 'm' (4-byte MIDI
+// message) type tag, so packets using it are built and parsed here instead.
+// Both classes work on fixed-size buffers and never allocate.
+namespace OscPacket
+{
+    // Large enough for any message we build; stays under a typical Ethernet MTU.
+    constexpr int maxPacketSize = 1472;
+
+    // Address used by the native MIDI transport, one 'm' argument per MIDI event.
+    constexpr const char* nativeMidiAddress = "/midi";
+
+    // OSC pads strings and blobs to a multiple of four bytes. Computed unsigned, so it can't
+    // overflow; sizes read from a packet must still be checked against it first (see skip()).
+    constexpr int padded(int size) noexcept { return static_cast<int>((static_cast<juce::uint32>(size) + 3) & ~3u); }
+
+    // Bundle time tag meaning "process immediately".
+    constexpr juce::uint64 immediateTimeTag = 1;
+
+    // Converts an NTP-format time tag (seconds since 1900 in the high 32 bits, binary
+    // fraction in the low 32) to milliseconds since the Unix epoch, like juce::Time.
+    inline juce::int64 timeTagToUnixMillis(juce::uint64 timeTag) noexcept
+    {
+        constexpr juce::int64 ntpToUnixSeconds = 2208988800;
+        auto seconds = static_cast<juce::int64>(timeTag >> 32) - ntpToUnixSeconds;
+        auto millis = static_cast<juce::int64>(((timeTag & 0xffffffff) * 1000) >> 32);
+        return seconds * 1000 + millis;
+    }
+
+    // The same time tag in nanoseconds since 1900, for measuring intervals between tags.
+    inline juce::int64 timeTagToNanoseconds(juce::uint64 timeTag) noexcept
+    {
+        auto seconds = static_cast<juce::int64>(timeTag >> 32);
+        auto nanos = static_cast<juce::int64>(((timeTag & 0xffffffff) * 1000000000) >> 32);
+        return seconds * 1000000000 + nanos;
+    }
+
+    // True if the packet starts with the "#bundle" marker.
+    inline bool isBundle(const char* data, int dataSize) noexcept
+    {
+        return dataSize >= 16 && std::memcmp(data, "#bundle", 8) == 0;
+    }
+}
+
+//==============================================================================
+// Builds a single OSC message. Arguments are appended in order; write() then
+// assembles address, type tag string and argument data into a caller buffer.
+class OscMessageWriter
+{
+public:
+    OscMessageWriter() = default;
+
+    // Starts a new message, discarding any arguments already added.
+    void begin(const char* address) noexcept;
+
+    // Each add* returns false if the argument doesn't fit; the message is left unchanged.
+    bool addInt32(juce::int32 value) noexcept;
+    bool addFloat32(float value) noexcept;
+    bool addString(const char* text) noexcept;
+    bool addMidi(juce::uint8 port, juce::uint8 status, juce::uint8 data1, juce::uint8 data2) noexcept;
+
+    int getNumArguments() const noexcept { return numArguments; }
+    bool isEmpty() const noexcept { return numArguments == 0; }
+
+    // Size in bytes of the encoded message.
+    int getSize() const noexcept;
+
+    // Encodes the message into dest and returns its size, or 0 if dest is too small.
+    int write(char* dest, int destSize) const noexcept;
+
+    static constexpr int maxArguments = 62;
+
+private:
+    bool addTypeTag(char tag, int argumentSize) noexcept;
+
+    char address[128] = {};
+    int addressLength = 0;
+
+    char typeTags[maxArguments + 2] = { ',' };   // leading ',' plus a spare for the terminator
+    int numArguments = 0;
+
+    char arguments[OscPacket::maxPacketSize] = {};
+    int argumentsSize = 0;
+};
+
+//==============================================================================
+// Packs complete messages into a single OSC bundle, up to maxPacketSize.
+class OscBundleWriter
+{
+public:
+    OscBundleWriter() { begin(); }
+
+    // Starts a new, empty bundle.
+    void begin(juce::uint64 timeTag = OscPacket::immediateTimeTag) noexcept;
+
+    // Returns false if the message doesn't fit; the bundle is left unchanged.
+    bool addMessage(const OscMessageWriter& message) noexcept;
+
+    int getNumElements() const noexcept { return numElements; }
+    bool isEmpty() const noexcept { return numElements == 0; }
+
+    const char* getData() const noexcept { return data; }
+    int getSize() const noexcept { return size; }
+
+private:
+    static constexpr int headerSize = 16;   // "#bundle\0" + time tag
+
+    char data[OscPacket::maxPacketSize] = {};
+    int size = 0;
+    int numElements = 0;
+};
+
+//==============================================================================
+// Parses a single OSC message in place. The address, type tags and strings
+// returned point into the packet buffer, which must outlive the reader.
+class OscMessageReader
+{
+public:
+    OscMessageReader() = default;
+
+    // Returns false if the data isn't a well-formed OSC message.
+    bool parse(const char* data, int dataSize) noexcept;
+
+    const char* getAddress() const noexcept { return address; }
+    const char* getTypeTags() const noexcept { return typeTags; }   // without the leading ','
+    int getNumArguments() const noexcept { return numArguments; }
+
+    // The whole message as passed to parse().
+    const char* getData() const noexcept { return address; }
+    int getSize() const noexcept { return static_cast<int>(end - address); }
+
+    // Type tag of the next unread argument, or 0 once all have been read.
+    char getNextType() const noexcept;
+
+    // Sequential argument access. Each returns false on a type mismatch or truncated data.
+    bool readInt32(juce::int32& result) noexcept;
+    bool readFloat32(float& result) noexcept;
+    bool readString(const char*& result) noexcept;
+    bool readMidi(juce::uint8 (&result)[4]) noexcept;
+
+    // Skips over the next argument whatever its type.
+    bool skip() noexcept;
+
+private:
+    bool readFourBytes(char expectedType, juce::uint32& result) noexcept;
+
+    const char* address = nullptr;
+    const char* typeTags = nullptr;
+    int numArguments = 0;
+    int nextArgument = 0;
+
+    const char* position = nullptr;
+    const char* end = nullptr;
+};
+
+//==============================================================================
+// Walks the elements of an OSC bundle in place. Elements may be messages or
+// nested bundles; each is returned as a pointer into the packet and a size.
+class OscBundleReader
+{
+public:
+    OscBundleReader() = default;
+
+    // Returns false if the data isn't a well-formed bundle header.
+    bool parse(const char* data, int dataSize) noexcept;
+
+    juce::uint64 getTimeTag() const noexcept { return timeTag; }
+
+    // Returns false once there are no more elements, or if the next one is truncated.
+    bool getNextElement(const char*& elementData, int& elementSize) noexcept;
+
+private:
+    juce::uint64 timeTag = OscPacket::immediateTimeTag;
+    const char* position = nullptr;
+    const char* end = nullptr;
+};
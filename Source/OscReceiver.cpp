@@ -0,0 +1,239 @@
+#include "OscReceiver.h"
+#include "LatencyMonitor.h"
+#include "SocketOptions.h"
+
+#if JUCE_LINUX
+ #include <arpa/inet.h>
+ #include <netinet/in.h>
+ #include <sys/socket.h>
+ #include <sys/uio.h>
+#endif
+
+namespace
+{
+    // Bundles nested deeper than this are treated as malformed
+    constexpr int maxBundleDepth = 8;
+}
+
+//==============================================================================
+OscReceiver::OscReceiver(Listener& listenerToUse)
+    : juce::Thread("OSC receiver"),
+      listener(listenerToUse)
+{
+}
+
+OscReceiver::~OscReceiver()
+{
+    disconnect();
+}
+
+//------------------------------------------------------------------------------
+juce::String OscReceiver::sourceToString(SourceId source)
+{
+    auto address = static_cast<juce::uint32>(source >> 16);
+    return juce::String(address >> 24) + "." + juce::String((address >> 16) & 0xff) + "."
+         + juce::String((address >> 8) & 0xff) + "." + juce::String(address & 0xff)
+         + ":" + juce::String(static_cast<int>(source & 0xffff));
+}
+
+//------------------------------------------------------------------------------
+void OscReceiver::setMulticastGroup(const juce::String& group, const juce::String& interfaceAddress)
+{
+    multicastGroup = group;
+    multicastInterface = interfaceAddress;
+}
+
+bool OscReceiver::connect(int port)
+{
+    disconnect();
+
+    auto newSocket = std::make_unique<juce::DatagramSocket>(false);
+
+    // Set before binding, so the buffer is in place before the first datagram arrives
+    if (requestedBufferSize > 0)
+        SocketOptions::setBufferSize(*newSocket, SocketOptions::Buffer::receive, requestedBufferSize);
+
+    if (multicastGroup.isNotEmpty())
+        newSocket->setEnablePortReuse(true);
+
+    if (port <= 0 || port > 65535 || !newSocket->bindToPort(port))
+        return false;
+
+    // Leaving the group is implicit when the socket closes
+    if (multicastGroup.isNotEmpty()
+        && !SocketOptions::joinMulticastGroup(*newSocket, multicastGroup, multicastInterface))
+        return false;
+
+    bufferSize = SocketOptions::getBufferSize(*newSocket, SocketOptions::Buffer::receive);
+    numKernelDrops = 0;
+    lastKernelDrops = 0;
+    lastReceiveQueueRead = juce::Time::getMillisecondCounter();
+
+    socket = std::move(newSocket);
+    startThread(juce::Thread::Priority::high);
+    return true;
+}
+
+void OscReceiver::disconnect()
+{
+    if (socket == nullptr)
+        return;
+
+    signalThreadShouldExit();
+    socket->shutdown();
+    stopThread(2000);
+    socket.reset();
+}
+
+//------------------------------------------------------------------------------
+void OscReceiver::run()
+{
+   #if JUCE_LINUX
+    // Headers for the whole pool are set up once; each call only resets the lengths
+    mmsghdr messages[batchSize] = {};
+    iovec vectors[batchSize] = {};
+    sockaddr_in senders[batchSize] = {};
+
+    for (int i = 0; i < batchSize; ++i)
+    {
+        vectors[i].iov_base = pool + i * maxDatagramSize;
+        vectors[i].iov_len = static_cast<size_t>(maxDatagramSize);
+        messages[i].msg_hdr.msg_iov = &vectors[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+        messages[i].msg_hdr.msg_name = &senders[i];
+    }
+   #endif
+
+    // When the listener wants an empty batch, on the millisecond counter
+    bool emptyBatchRequested = false;
+    juce::uint32 emptyBatchTime = 0;
+
+    auto requestEmptyBatch = [&emptyBatchRequested, &emptyBatchTime](int delayMs)
+        {
+            emptyBatchRequested = delayMs >= 0;
+            emptyBatchTime = juce::Time::getMillisecondCounter() + static_cast<juce::uint32>(juce::jmax(0, delayMs));
+        };
+
+    while (!threadShouldExit())
+    {
+        if (juce::Time::getMillisecondCounter() - lastReceiveQueueRead >= receiveQueueReadIntervalMs)
+            readReceiveQueue();
+
+        int timeoutMs = 100;
+        if (emptyBatchRequested)
+            timeoutMs = juce::jlimit(0, 100, static_cast<int>(emptyBatchTime - juce::Time::getMillisecondCounter()));
+
+        if (socket->waitUntilReady(true, timeoutMs) <= 0)
+        {
+            if (emptyBatchRequested && static_cast<int>(juce::Time::getMillisecondCounter() - emptyBatchTime) >= 0)
+            {
+                listener.oscBatchStarted(LatencyMonitor::now());
+                requestEmptyBatch(listener.oscBatchFinished());
+            }
+
+            continue;
+        }
+
+       #if JUCE_LINUX
+        for (auto& message : messages)
+            message.msg_hdr.msg_namelen = sizeof(sockaddr_in);
+
+        // Take everything already queued, up to the pool size, without blocking
+        int numReceived = recvmmsg(socket->getRawSocketHandle(), messages, batchSize, MSG_DONTWAIT, nullptr);
+        if (numReceived <= 0)
+            continue;
+
+        auto receiveTime = LatencyMonitor::now();
+        numReceiveCalls.fetch_add(1, std::memory_order_relaxed);
+        numPackets.fetch_add(static_cast<juce::uint64>(numReceived), std::memory_order_relaxed);
+
+        listener.oscBatchStarted(receiveTime);
+
+        for (int i = 0; i < numReceived; ++i)
+        {
+            auto* data = pool + i * maxDatagramSize;
+            auto size = static_cast<int>(messages[i].msg_len);
+
+            if ((messages[i].msg_hdr.msg_flags & MSG_TRUNC) != 0)
+            {
+                numTruncated.fetch_add(1, std::memory_order_relaxed);
+                listener.oscPacketMalformed(data, size);
+                continue;
+            }
+
+            auto source = makeSourceId(ntohl(senders[i].sin_addr.s_addr), ntohs(senders[i].sin_port));
+            listener.oscPacketReceived(data, size, receiveTime);
+            dispatch(data, size, source, OscPacket::immediateTimeTag, receiveTime, 0);
+        }
+
+        requestEmptyBatch(listener.oscBatchFinished());
+
+        // A full batch means more is waiting, which is when the kernel buffer overflows
+        if (numReceived == batchSize)
+            readReceiveQueue();
+       #else
+        juce::String senderAddress;
+        int senderPort = 0;
+        int size = socket->read(pool, maxDatagramSize, false, senderAddress, senderPort);
+        if (size <= 0)
+            continue;
+
+        juce::IPAddress sender(senderAddress);
+        auto source = makeSourceId(juce::ByteOrder::makeInt(sender.address[3], sender.address[2], sender.address[1], sender.address[0]),
+                                   senderPort);
+
+        auto receiveTime = LatencyMonitor::now();
+        numReceiveCalls.fetch_add(1, std::memory_order_relaxed);
+        numPackets.fetch_add(1, std::memory_order_relaxed);
+
+        listener.oscBatchStarted(receiveTime);
+        listener.oscPacketReceived(pool, size, receiveTime);
+        dispatch(pool, size, source, OscPacket::immediateTimeTag, receiveTime, 0);
+        requestEmptyBatch(listener.oscBatchFinished());
+       #endif
+    }
+}
+
+//------------------------------------------------------------------------------
+void OscReceiver::readReceiveQueue()
+{
+    lastReceiveQueueRead = juce::Time::getMillisecondCounter();
+
+    auto queue = SocketOptions::readReceiveQueue(*socket);
+    if (!queue.valid)
+        return;
+
+    // The kernel's count covers the socket's lifetime; pass on what's new since the last read
+    auto newDrops = queue.drops - lastKernelDrops;
+    lastKernelDrops = queue.drops;
+    numKernelDrops.fetch_add(newDrops, std::memory_order_relaxed);
+
+    listener.oscReceiveQueueRead(newDrops, queue.queuedBytes);
+}
+
+//------------------------------------------------------------------------------
+void OscReceiver::dispatch(const char* data, int size, SourceId source, juce::uint64 timeTag, juce::int64 receiveTime, int depth)
+{
+    if (OscPacket::isBundle(data, size))
+    {
+        OscBundleReader bundle;
+        if (depth >= maxBundleDepth || !bundle.parse(data, size))
+        {
+            listener.oscPacketMalformed(data, size);
+            return;
+        }
+
+        const char* elementData;
+        int elementSize;
+        while (bundle.getNextElement(elementData, elementSize))
+            dispatch(elementData, elementSize, source, bundle.getTimeTag(), receiveTime, depth + 1);
+
+        return;
+    }
+
+    OscMessageReader message;
+    if (message.parse(data, size))
+        listener.oscMessageReceived(message, source, timeTag, receiveTime);
+    else
+        listener.oscPacketMalformed(data, size);
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include "OscPacket.h"
+
+//==============================================================================
+// UDP OSC input without juce::OSCReceiver's per-message juce::OSCMessage and
+// juce::String objects. A thread pulls datagrams into a fixed pool of buffers
+// (on Linux up to batchSize per recvmmsg call, elsewhere one read at a time),
+// unpacks bundles and parses each message in place. The listener sees views
+// into the pool, so nothing is allocated per packet; anything it wants to keep
+// beyond the callback has to be copied.
+class OscReceiver : private juce::Thread
+{
+public:
+    // Identifies a datagram's sender: IPv4 address (host byte order) above the 16-bit port.
+    // 0 if the sender isn't known.
+    using SourceId = juce::uint64;
+
+    static SourceId makeSourceId(juce::uint32 address, int port) noexcept
+    {
+        return (static_cast<SourceId>(address) << 16) | static_cast<SourceId>(port & 0xffff);
+    }
+
+    // "a.b.c.d:port"
+    static juce::String sourceToString(SourceId source);
+
+    // All callbacks come from the receiver thread.
+    class Listener
+    {
+    public:
+        virtual ~Listener() = default;
+
+        // Bracket each batch of datagrams taken from the socket in one receive call, so
+        // the listener can collect what the batch's messages produce and act on it once.
+        // oscBatchFinished() returns how many milliseconds from now the listener wants an
+        // empty batch, to send what it held back, or -1 if it doesn't.
+        virtual void oscBatchStarted(juce::int64 receiveTime) = 0;
+        virtual int oscBatchFinished() = 0;
+
+        // Every datagram as received, before its messages are dispatched.
+        virtual void oscPacketReceived(const char* data, int size, juce::int64 receiveTime) = 0;
+
+        // Each message, with its sender and the time tag of the bundle it came in (immediate if none).
+        virtual void oscMessageReceived(OscMessageReader& message, SourceId source, juce::uint64 timeTag, juce::int64 receiveTime) = 0;
+
+        // Datagrams, or bundle elements, that aren't well-formed OSC.
+        virtual void oscPacketMalformed(const char* data, int size) = 0;
+
+        // The socket's receive queue as last read from the kernel (Linux only): datagrams
+        // dropped since the previous call because the receive buffer was full, and the
+        // bytes still waiting to be read.
+        virtual void oscReceiveQueueRead(juce::uint32 newDrops, int queuedBytes) = 0;
+    };
+
+    explicit OscReceiver(Listener& listener);
+    ~OscReceiver() override;
+
+    // Kernel receive buffer to ask for on the next connect(), in bytes; 0 keeps the
+    // system default. getReceiveBufferSize() is the size the kernel actually granted.
+    void setReceiveBufferSize(int bytes) noexcept { requestedBufferSize = bytes; }
+    int getReceiveBufferSize() const noexcept     { return bufferSize.load(std::memory_order_relaxed); }
+
+    // Multicast group to join on the next connect(), on the interface with the given
+    // address (empty for the kernel's choice); an empty group receives unicast only.
+    void setMulticastGroup(const juce::String& group, const juce::String& interfaceAddress);
+    juce::String getMulticastGroup() const { return multicastGroup; }
+
+    // Binds to the port on all interfaces, joins the multicast group if one is set,
+    // and starts receiving. With a group the port can be shared with other listeners
+    // on this host, so several bridges or monitors can follow the same session.
+    bool connect(int port);
+    void disconnect();
+    bool isConnected() const noexcept { return socket != nullptr; }
+
+    // Datagrams received, receive calls that returned data, and datagrams cut short by the pool
+    juce::uint64 getNumPackets() const noexcept       { return numPackets.load(std::memory_order_relaxed); }
+    juce::uint64 getNumReceiveCalls() const noexcept  { return numReceiveCalls.load(std::memory_order_relaxed); }
+    juce::uint64 getNumTruncated() const noexcept     { return numTruncated.load(std::memory_order_relaxed); }
+
+    // Datagrams the kernel dropped on this connection because the receive buffer was full
+    juce::uint64 getNumKernelDrops() const noexcept   { return numKernelDrops.load(std::memory_order_relaxed); }
+
+    static constexpr int batchSize = 64;
+    static constexpr int maxDatagramSize = 8192;
+
+    // How often the kernel's receive queue counters are read while traffic is light
+    static constexpr juce::uint32 receiveQueueReadIntervalMs = 100;
+
+private:
+    void run() override;
+    void dispatch(const char* data, int size, SourceId source, juce::uint64 timeTag, juce::int64 receiveTime, int depth);
+    void readReceiveQueue();
+
+    Listener& listener;
+    std::unique_ptr<juce::DatagramSocket> socket;
+    juce::HeapBlock<char> pool { static_cast<size_t>(batchSize * maxDatagramSize) };
+
+    std::atomic<juce::uint64> numPackets { 0 }, numReceiveCalls { 0 }, numTruncated { 0 }, numKernelDrops { 0 };
+
+    int requestedBufferSize = 0;
+    juce::String multicastGroup, multicastInterface;
+    std::atomic<int> bufferSize { 0 };
+    juce::uint32 lastKernelDrops = 0, lastReceiveQueueRead = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OscReceiver)
+};
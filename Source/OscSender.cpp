@@ -0,0 +1,191 @@
+#include "OscSender.h"
+#include "SocketOptions.h"
+
+#if JUCE_LINUX
+ #include <netdb.h>
+ #include <sys/socket.h>
+ #include <sys/uio.h>
+#endif
+
+//==============================================================================
+struct OscSender::Batch
+{
+   #if JUCE_LINUX
+    sockaddr_storage address = {};
+    socklen_t addressLength = 0;
+    mmsghdr messages[batchSize] = {};
+    iovec vectors[batchSize] = {};
+   #endif
+    bool resolved = false;
+};
+
+//==============================================================================
+OscSender::OscSender()
+    : batch(std::make_unique<Batch>())
+{
+}
+
+OscSender::~OscSender() = default;
+
+//------------------------------------------------------------------------------
+bool OscSender::setDestination(const juce::String& newHost, int newPort)
+{
+    flush();
+
+    host = newHost;
+    port = newPort;
+    batch->resolved = false;
+
+    if (host.isEmpty() || port <= 0 || port > 65535)
+        return false;
+
+   #if JUCE_LINUX
+    // Resolved once here rather than on every send; if it fails, flush() falls back to single writes
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+
+    addrinfo* info = nullptr;
+    if (getaddrinfo(host.toRawUTF8(), juce::String(port).toRawUTF8(), &hints, &info) == 0 && info != nullptr)
+    {
+        std::memcpy(&batch->address, info->ai_addr, info->ai_addrlen);
+        batch->addressLength = info->ai_addrlen;
+        batch->resolved = true;
+
+        for (int i = 0; i < batchSize; ++i)
+        {
+            batch->vectors[i].iov_base = pool + i * OscPacket::maxPacketSize;
+            batch->messages[i].msg_hdr.msg_name = &batch->address;
+            batch->messages[i].msg_hdr.msg_namelen = batch->addressLength;
+            batch->messages[i].msg_hdr.msg_iov = &batch->vectors[i];
+            batch->messages[i].msg_hdr.msg_iovlen = 1;
+        }
+    }
+
+    if (info != nullptr)
+        freeaddrinfo(info);
+   #endif
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool OscSender::setSendBufferSize(int bytes)
+{
+    return SocketOptions::setBufferSize(socket, SocketOptions::Buffer::send, bytes);
+}
+
+int OscSender::getSendBufferSize()
+{
+    return SocketOptions::getBufferSize(socket, SocketOptions::Buffer::send);
+}
+
+bool OscSender::setMulticastOptions(const juce::String& interfaceAddress, int ttl, bool loopback)
+{
+    return SocketOptions::setMulticastInterface(socket, interfaceAddress)
+        && SocketOptions::setMulticastTtl(socket, ttl)
+        && SocketOptions::setMulticastLoopback(socket, loopback);
+}
+
+//------------------------------------------------------------------------------
+OscSender::Result OscSender::send(const char* data, int size)
+{
+    return sendTo(host, port, data, size);
+}
+
+OscSender::Result OscSender::sendTo(const juce::String& toHost, int toPort, const char* data, int size)
+{
+    Result result;
+    result.calls = 1;
+
+    if (socket.write(toHost, toPort, data, size) == size)
+    {
+        result.packets = 1;
+        result.bytes = size;
+    }
+    else
+    {
+        result.failed = 1;
+    }
+
+    return result;
+}
+
+//------------------------------------------------------------------------------
+void OscSender::queue(const char* data, int size)
+{
+    if (numQueued == batchSize)
+    {
+        auto sent = sendQueued();
+        pendingResult.packets += sent.packets;
+        pendingResult.bytes += sent.bytes;
+        pendingResult.failed += sent.failed;
+        pendingResult.calls += sent.calls;
+    }
+
+    size = juce::jlimit(0, OscPacket::maxPacketSize, size);
+    std::memcpy(pool + numQueued * OscPacket::maxPacketSize, data, static_cast<size_t>(size));
+    sizes[numQueued++] = size;
+}
+
+//------------------------------------------------------------------------------
+OscSender::Result OscSender::flush()
+{
+    auto result = sendQueued();
+    result.packets += pendingResult.packets;
+    result.bytes += pendingResult.bytes;
+    result.failed += pendingResult.failed;
+    result.calls += pendingResult.calls;
+
+    pendingResult = {};
+    return result;
+}
+
+//------------------------------------------------------------------------------
+OscSender::Result OscSender::sendQueued()
+{
+    Result result;
+    auto count = numQueued;
+    numQueued = 0;
+
+   #if JUCE_LINUX
+    if (batch->resolved)
+    {
+        for (int i = 0; i < count; ++i)
+            batch->vectors[i].iov_len = static_cast<size_t>(sizes[i]);
+
+        // sendmmsg can stop early (e.g. a full socket buffer); carry on from there
+        for (int next = 0; next < count;)
+        {
+            int sent = sendmmsg(socket.getRawSocketHandle(), batch->messages + next,
+                                static_cast<unsigned int>(count - next), 0);
+            ++result.calls;
+
+            if (sent <= 0)
+            {
+                result.failed += count - next;
+                break;
+            }
+
+            for (int i = next; i < next + sent; ++i)
+                result.bytes += sizes[i];
+
+            result.packets += sent;
+            next += sent;
+        }
+
+        return result;
+    }
+   #endif
+
+    for (int i = 0; i < count; ++i)
+    {
+        auto sent = send(pool + i * OscPacket::maxPacketSize, sizes[i]);
+        result.packets += sent.packets;
+        result.bytes += sent.bytes;
+        result.failed += sent.failed;
+        result.calls += sent.calls;
+    }
+
+    return result;
+}
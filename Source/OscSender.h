@@ -0,0 +1,76 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "OscPacket.h"
+
+//==============================================================================
+// UDP output for encoded OSC packets. Packets are either sent straight away or
+// queued and submitted together by flush(): on Linux one sendmmsg call covers
+// up to batchSize packets, elsewhere (or if the destination couldn't be
+// resolved for sendmmsg) they go out one write at a time. Queued packets are
+// copied into a fixed pool, so queueing never allocates. Not thread-safe: use
+// it from one thread at a time.
+class OscSender
+{
+public:
+    OscSender();
+    ~OscSender();
+
+    // What a send or flush did, for the stats
+    struct Result
+    {
+        int packets = 0;   // written in full
+        int bytes = 0;
+        int failed = 0;
+        int calls = 0;     // send system calls made
+    };
+
+    // Sets where send() and flush() go, first flushing anything queued for the old
+    // destination. Returns false if the host or port isn't usable.
+    bool setDestination(const juce::String& host, int port);
+
+    // Asks the kernel for a send buffer of this many bytes, so a burst of queued packets
+    // can be taken in one go; getSendBufferSize() is the size actually granted.
+    bool setSendBufferSize(int bytes);
+    int getSendBufferSize();
+
+    // How packets to a multicast destination go out: by the interface with the given
+    // address (empty for the routing table's choice), crossing at most ttl routers,
+    // and with or without a copy for listeners on this host. A group is otherwise
+    // just another destination, so batching works the same.
+    bool setMulticastOptions(const juce::String& interfaceAddress, int ttl, bool loopback);
+
+    // Sends one packet now, to the destination or to another address (e.g. a stats reply).
+    Result send(const char* data, int size);
+    Result sendTo(const juce::String& host, int port, const char* data, int size);
+
+    // Queues a packet for the next flush(). If the pool is full it's flushed first,
+    // and what that sent is added to pendingResult for the next flush() to report.
+    void queue(const char* data, int size);
+
+    // Sends everything queued.
+    Result flush();
+
+    int getNumQueued() const noexcept { return numQueued; }
+
+    static constexpr int batchSize = 64;
+
+private:
+    struct Batch;
+
+    Result sendQueued();
+
+    juce::DatagramSocket socket;
+    juce::String host;
+    int port = 0;
+
+    // Resolved destination and the sendmmsg headers (Linux only)
+    std::unique_ptr<Batch> batch;
+
+    juce::HeapBlock<char> pool { static_cast<size_t>(batchSize * OscPacket::maxPacketSize) };
+    int sizes[batchSize] = {};
+    int numQueued = 0;
+    Result pendingResult;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OscSender)
+};
@@ -0,0 +1,231 @@
+#include "PipelineTrace.h"
+#include <atomic>
+#include <memory>
+#include "LatencyMonitor.h"
+
+namespace
+{
+    struct TraceEvent
+    {
+        const char* name = nullptr;
+        juce::int64 beginTime = 0, endTime = 0;
+        bool async = false;
+    };
+
+    // Written only by its own thread; readers use numWritten to find the valid events.
+    // writing is set while an event is being written, so a reader can wait for it to land.
+    struct ThreadBuffer
+    {
+        juce::String threadName;
+        int trackId = 0;
+        std::unique_ptr<TraceEvent[]> events { new TraceEvent[PipelineTrace::eventsPerThread] };
+        std::atomic<juce::uint64> numWritten { 0 };
+        std::atomic<bool> writing { false };
+    };
+
+    std::atomic<bool> enabled { false };
+
+    // Buffers outlive their threads, so a trace still shows threads that have gone.
+    // They're never freed: there are at most maxThreads of them.
+    std::atomic<ThreadBuffer*> threadBuffers[PipelineTrace::maxThreads] = {};
+    std::atomic<int> numThreadBuffers { 0 };
+
+    thread_local ThreadBuffer* threadBuffer = nullptr;
+    thread_local bool threadBufferClaimed = false;
+
+    ThreadBuffer* claimThreadBuffer()
+    {
+        // Sequentially consistent, like writing below, so pauseWriters() can't miss a new buffer
+        auto index = numThreadBuffers.fetch_add(1);
+        if (index >= PipelineTrace::maxThreads)
+            return nullptr;
+
+        auto* buffer = new ThreadBuffer();
+        buffer->trackId = index + 1;
+
+        if (juce::MessageManager::existsAndIsCurrentThread())
+            buffer->threadName = "Message thread";
+        else if (auto* thread = juce::Thread::getCurrentThread())
+            buffer->threadName = thread->getThreadName();
+        else
+            buffer->threadName = "Thread " + juce::String(buffer->trackId);   // MIDI driver callbacks and the like
+
+        threadBuffers[index].store(buffer);
+        return buffer;
+    }
+
+    void write(const char* name, juce::int64 beginTime, juce::int64 endTime, bool async) noexcept
+    {
+        if (!enabled.load(std::memory_order_relaxed))
+            return;
+
+        if (threadBuffer == nullptr)
+        {
+            // Threads beyond maxThreads aren't traced
+            if (threadBufferClaimed)
+                return;
+
+            threadBufferClaimed = true;
+            threadBuffer = claimThreadBuffer();
+            if (threadBuffer == nullptr)
+                return;
+        }
+
+        // Announce the write, then check tracing is still on: either pauseWriters() sees the
+        // flag and waits, or this sees the pause and backs off (both sequentially consistent)
+        threadBuffer->writing.store(true);
+        if (enabled.load())
+        {
+            auto index = threadBuffer->numWritten.load(std::memory_order_relaxed);
+            auto& event = threadBuffer->events[index % PipelineTrace::eventsPerThread];
+            event.name = name;
+            event.beginTime = beginTime;
+            event.endTime = endTime;
+            event.async = async;
+            threadBuffer->numWritten.store(index + 1, std::memory_order_release);
+        }
+
+        threadBuffer->writing.store(false, std::memory_order_release);
+    }
+
+    // Turns recording off and waits for writes in progress to finish, so the buffers can be
+    // read or reset without tearing an event. Returns whether recording was on.
+    bool pauseWriters() noexcept
+    {
+        auto wasEnabled = enabled.exchange(false);
+
+        for (int i = 0; i < juce::jmin(numThreadBuffers.load(), PipelineTrace::maxThreads); ++i)
+            if (auto* buffer = threadBuffers[i].load())
+                while (buffer->writing.load())
+                    juce::Thread::yield();
+
+        return wasEnabled;
+    }
+}
+
+//==============================================================================
+void PipelineTrace::start() noexcept
+{
+    // Each trace starts empty
+    pauseWriters();
+
+    for (int i = 0; i < juce::jmin(numThreadBuffers.load(std::memory_order_relaxed), maxThreads); ++i)
+        if (auto* buffer = threadBuffers[i].load(std::memory_order_acquire))
+            buffer->numWritten.store(0, std::memory_order_relaxed);
+
+    // Writers see the reset once they see recording back on
+    enabled.store(true);
+}
+
+void PipelineTrace::stop() noexcept
+{
+    enabled.store(false, std::memory_order_relaxed);
+}
+
+bool PipelineTrace::isEnabled() noexcept
+{
+    return enabled.load(std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+void PipelineTrace::record(const char* name, juce::int64 beginTime, juce::int64 endTime) noexcept
+{
+    write(name, beginTime, endTime, false);
+}
+
+void PipelineTrace::recordAsync(const char* name, juce::int64 beginTime, juce::int64 endTime) noexcept
+{
+    write(name, beginTime, endTime, true);
+}
+
+//------------------------------------------------------------------------------
+PipelineTrace::ScopedSpan::ScopedSpan(const char* spanName) noexcept
+    : name(spanName)
+{
+    if (enabled.load(std::memory_order_relaxed))
+        beginTime = LatencyMonitor::now();
+}
+
+PipelineTrace::ScopedSpan::~ScopedSpan() noexcept
+{
+    if (beginTime != 0)
+        write(name, beginTime, LatencyMonitor::now(), false);
+}
+
+//------------------------------------------------------------------------------
+bool PipelineTrace::writeChromeTrace(const juce::File& file)
+{
+    auto wasEnabled = pauseWriters();
+
+    struct Track
+    {
+        const ThreadBuffer* buffer;
+        juce::uint64 first, end;
+    };
+
+    juce::Array<Track> tracks;
+    juce::int64 origin = std::numeric_limits<juce::int64>::max();
+
+    for (int i = 0; i < juce::jmin(numThreadBuffers.load(std::memory_order_relaxed), maxThreads); ++i)
+    {
+        auto* buffer = threadBuffers[i].load(std::memory_order_acquire);
+        if (buffer == nullptr)
+            continue;
+
+        auto end = buffer->numWritten.load(std::memory_order_acquire);
+        auto first = end > static_cast<juce::uint64>(eventsPerThread) ? end - static_cast<juce::uint64>(eventsPerThread) : 0;
+        tracks.add({ buffer, first, end });
+
+        for (auto index = first; index < end; ++index)
+            origin = juce::jmin(origin, buffer->events[index % eventsPerThread].beginTime);
+    }
+
+    file.deleteFile();
+    juce::FileOutputStream out(file);
+
+    if (out.openedOk())
+    {
+        // Timestamps are microseconds from the first event
+        auto toMicroseconds = [origin](juce::int64 time) { return juce::String(static_cast<double>(time - origin) / 1000.0, 3); };
+
+        out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+        bool first = true;
+        juce::int64 asyncId = 0;
+
+        auto writeEvent = [&out, &first](const juce::String& json)
+            {
+                out << (first ? "" : ",\n") << json;
+                first = false;
+            };
+
+        for (auto& track : tracks)
+        {
+            auto tid = juce::String(track.buffer->trackId);
+            writeEvent("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + tid
+                       + ",\"args\":{\"name\":" + juce::JSON::toString(juce::var(track.buffer->threadName)) + "}}");
+
+            for (auto index = track.first; index < track.end; ++index)
+            {
+                auto& event = track.buffer->events[index % eventsPerThread];
+                auto common = "\"name\":\"" + juce::String(event.name) + "\",\"pid\":1,\"tid\":" + tid;
+
+                if (!event.async)
+                {
+                    writeEvent("{" + common + ",\"cat\":\"bridge\",\"ph\":\"X\",\"ts\":" + toMicroseconds(event.beginTime)
+                               + ",\"dur\":" + juce::String(static_cast<double>(event.endTime - event.beginTime) / 1000.0, 3) + "}");
+                    continue;
+                }
+
+                auto id = juce::String(++asyncId);
+                writeEvent("{" + common + ",\"cat\":\"queue\",\"ph\":\"b\",\"id\":" + id + ",\"ts\":" + toMicroseconds(event.beginTime) + "}");
+                writeEvent("{" + common + ",\"cat\":\"queue\",\"ph\":\"e\",\"id\":" + id + ",\"ts\":" + toMicroseconds(event.endTime) + "}");
+            }
+        }
+
+        out << "\n]}\n";
+        out.flush();
+    }
+
+    enabled.store(wasEnabled);
+    return out.openedOk() && out.getStatus().wasOk();
+}
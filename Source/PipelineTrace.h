@@ -0,0 +1,46 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// Optional span tracing of the bridge's pipeline, exported as Chrome trace JSON
+// (chrome://tracing, ui.perfetto.dev). Spans go into a ring buffer per thread
+// with a single writer, so recording takes no locks; a thread's buffer is
+// allocated the first time it records while tracing is on. When tracing is off
+// a span costs one relaxed load.
+//
+// Span names must be string literals: only the pointer is stored.
+namespace PipelineTrace
+{
+    static constexpr int maxThreads = 64;
+    static constexpr int eventsPerThread = 1 << 16;   // the most recent ones are kept
+
+    void start() noexcept;
+    void stop() noexcept;
+    bool isEnabled() noexcept;
+
+    // Records a span on the calling thread's track. Times come from LatencyMonitor::now().
+    void record(const char* name, juce::int64 beginTime, juce::int64 endTime) noexcept;
+
+    // Records a span that may overlap others, such as an event's wait in a queue.
+    // These are shown as async slices grouped by name rather than on a thread track.
+    void recordAsync(const char* name, juce::int64 beginTime, juce::int64 endTime) noexcept;
+
+    // Records a span from construction to destruction, if tracing is on when constructed.
+    class ScopedSpan
+    {
+    public:
+        explicit ScopedSpan(const char* name) noexcept;
+        ~ScopedSpan() noexcept;
+
+    private:
+        const char* name;
+        juce::int64 beginTime = 0;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedSpan)
+    };
+
+    // Writes everything in the buffers as Chrome trace JSON. Recording is paused
+    // while the buffers are read. Returns false if the file couldn't be written.
+    bool writeChromeTrace(const juce::File& file);
+}
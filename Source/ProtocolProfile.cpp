@@ -0,0 +1,418 @@
+#include "ProtocolProfile.h"
+
+namespace
+{
+    // The address scheme documented in the README.
+    const char* const patchworldProfileJSON = R"({
+        "name": "Patchworld",
+        "events": {
+            "noteOn": [
+                { "address": "/ch{channel}note",   "args": [ { "field": "note", "type": "int" } ] },
+                { "address": "/ch{channel}nvalue", "args": [ { "field": "note", "type": "int" },
+                                                             { "field": "velocity", "type": "float", "range": [0, 1] } ] }
+            ],
+            "noteOff": [
+                { "address": "/ch{channel}noteoff", "args": [ { "field": "note", "type": "int" } ] }
+            ],
+            "cc": [
+                { "address": "/ch{channel}cc",      "args": [ { "field": "controller", "type": "int" } ] },
+                { "address": "/ch{channel}ccvalue", "args": [ { "field": "value", "type": "float", "range": [0, 1] } ] }
+            ],
+            "pitch": [
+                { "address": "/ch{channel}pitch", "args": [ { "field": "bend", "type": "float", "range": [-8400, 8400] } ] }
+            ],
+            "pressure": [
+                { "address": "/ch{channel}pressure", "args": [ { "field": "pressure", "type": "int" } ] }
+            ]
+        }
+    })";
+
+    const char* const eventNames[ProtocolProfile::numEventTypes] = { "noteOn", "noteOff", "cc", "pitch", "pressure" };
+
+    void writeBigEndian(char* dest, juce::uint32 value) noexcept
+    {
+        value = juce::ByteOrder::swapIfLittleEndian(value);
+        std::memcpy(dest, &value, sizeof(value));
+    }
+}
+
+//==============================================================================
+ProtocolProfile::Ptr ProtocolProfile::createPatchworld()
+{
+    juce::String error;
+    auto profile = fromJSON(juce::JSON::parse(patchworldProfileJSON), error);
+    jassert(profile != nullptr);
+    return profile;
+}
+
+//------------------------------------------------------------------------------
+ProtocolProfile::Ptr ProtocolProfile::loadFromFile(const juce::File& file, juce::String& error)
+{
+    if (!file.existsAsFile())
+    {
+        error = "Profile not found: " + file.getFullPathName();
+        return nullptr;
+    }
+
+    juce::var json;
+    auto result = juce::JSON::parse(file.loadFileAsString(), json);
+    if (result.failed())
+    {
+        error = file.getFileName() + ": " + result.getErrorMessage();
+        return nullptr;
+    }
+
+    auto profile = fromJSON(json, error);
+    if (profile == nullptr)
+        error = file.getFileName() + ": " + error;
+
+    return profile;
+}
+
+//------------------------------------------------------------------------------
+ProtocolProfile::Ptr ProtocolProfile::fromJSON(const juce::var& json, juce::String& error)
+{
+    if (!json.isObject())
+    {
+        error = "Profile must be a JSON object";
+        return nullptr;
+    }
+
+    Ptr profile(new ProtocolProfile());
+    profile->name = json.getProperty("name", "Unnamed").toString();
+
+    auto events = json.getProperty("events", {});
+    if (!events.isObject())
+    {
+        error = "Profile has no \"events\" object";
+        return nullptr;
+    }
+
+    for (int type = 0; type < numEventTypes; ++type)
+    {
+        auto messages = events.getProperty(eventNames[type], {});
+        if (messages.isVoid())
+            continue;
+
+        auto* list = messages.getArray();
+        if (list == nullptr)
+        {
+            error = juce::String("\"") + eventNames[type] + "\" must be an array of messages";
+            return nullptr;
+        }
+
+        for (int i = 0; i < list->size(); ++i)
+            if (!profile->addMessage(static_cast<EventType>(type), list->getReference(i), i == list->size() - 1, error))
+                return nullptr;
+    }
+
+    profile->buildAddressTable();
+    return profile;
+}
+
+//==============================================================================
+bool ProtocolProfile::addMessage(EventType type, const juce::var& json, bool isLast, juce::String& error)
+{
+    auto addressTemplate = json.getProperty("address", {}).toString();
+    if (!addressTemplate.startsWithChar('/'))
+    {
+        error = "Address \"" + addressTemplate + "\" must start with '/'";
+        return false;
+    }
+
+    Message message;
+    message.emitsEvent = isLast;
+    message.addressHasChannel = addressTemplate.contains("{channel}");
+    message.addressHasNumber = addressTemplate.contains("{number}");
+
+    if (auto* args = json.getProperty("args", {}).getArray())
+    {
+        if (args->size() > maxArguments)
+        {
+            error = addressTemplate + ": too many arguments";
+            return false;
+        }
+
+        for (auto& argJson : *args)
+        {
+            Argument argument;
+            auto fieldName = argJson.getProperty("field", "value").toString();
+
+            if (fieldName == "number" || fieldName == "note" || fieldName == "controller")
+                argument.field = Field::Number;
+            else if (fieldName == "value" || fieldName == "velocity" || fieldName == "bend" || fieldName == "pressure")
+                argument.field = Field::Value;
+            else if (fieldName == "channel")
+                argument.field = Field::Channel;
+            else
+            {
+                error = addressTemplate + ": unknown field \"" + fieldName + "\"";
+                return false;
+            }
+
+            argument.type = argJson.getProperty("type", "float").toString() == "int" ? 'i' : 'f';
+
+            // MIDI range of the field
+            if (argument.field == Field::Channel)
+            {
+                argument.midiMin = 1;
+                argument.midiMax = 16;
+            }
+            else if (argument.field == Field::Value && type == EventType::PitchBend)
+            {
+                argument.midiMax = 16383;
+            }
+
+            float low = static_cast<float>(argument.midiMin);
+            float high = static_cast<float>(argument.midiMax);
+
+            if (auto* range = argJson.getProperty("range", {}).getArray())
+            {
+                if (range->size() != 2 || static_cast<float>((*range)[0]) == static_cast<float>((*range)[1]))
+                {
+                    error = addressTemplate + ": \"range\" must be two different numbers";
+                    return false;
+                }
+
+                low = static_cast<float>((*range)[0]);
+                high = static_cast<float>((*range)[1]);
+            }
+
+            argument.scale = (high - low) / static_cast<float>(argument.midiMax - argument.midiMin);
+            argument.offset = low - static_cast<float>(argument.midiMin) * argument.scale;
+            message.arguments.push_back(argument);
+        }
+    }
+
+    compileHeaders(message, addressTemplate);
+    eventMessages[static_cast<int>(type)].push_back(std::move(message));
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void ProtocolProfile::compileHeaders(Message& message, const juce::String& addressTemplate)
+{
+    int numChannels = message.addressHasChannel ? 16 : 1;
+    int numNumbers = message.addressHasNumber ? 128 : 1;
+
+    OscMessageWriter writer;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        for (int number = 0; number < numNumbers; ++number)
+        {
+            auto address = addressTemplate.replace("{channel}", juce::String(channel + 1))
+                                          .replace("{number}", juce::String(number));
+
+            // Encode with placeholder arguments and keep everything before the argument data
+            writer.begin(address.toRawUTF8());
+            for (auto& argument : message.arguments)
+            {
+                if (argument.type == 'i')
+                    writer.addInt32(0);
+                else
+                    writer.addFloat32(0.0f);
+            }
+
+            char packet[OscPacket::maxPacketSize];
+            int headerSize = writer.write(packet, sizeof(packet)) - 4 * static_cast<int>(message.arguments.size());
+
+            message.headerOffsets.push_back(static_cast<int>(headerPool.size()));
+            message.headerSizes.push_back(static_cast<juce::uint16>(headerSize));
+            headerPool.insert(headerPool.end(), packet, packet + headerSize);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void ProtocolProfile::buildAddressTable()
+{
+    size_t numAddresses = 0;
+    for (auto& messages : eventMessages)
+        for (auto& message : messages)
+            numAddresses += message.headerOffsets.size();
+
+    auto tableSize = static_cast<size_t>(juce::nextPowerOfTwo(juce::jmax(16, static_cast<int>(numAddresses * 2))));
+    addressTable.assign(tableSize, AddressEntry());
+    addressMask = static_cast<juce::uint32>(tableSize - 1);
+
+    for (int type = 0; type < numEventTypes; ++type)
+    {
+        for (size_t messageIndex = 0; messageIndex < eventMessages[type].size(); ++messageIndex)
+        {
+            auto& message = eventMessages[type][messageIndex];
+            int numNumbers = message.addressHasNumber ? 128 : 1;
+
+            for (size_t i = 0; i < message.headerOffsets.size(); ++i)
+            {
+                const char* address = headerPool.data() + message.headerOffsets[i];
+
+                // The first message registered for an address wins
+                if (findAddress(address) != nullptr)
+                    continue;
+
+                AddressEntry entry;
+                entry.hash = hashAddress(address);
+                entry.addressOffset = message.headerOffsets[i];
+                entry.eventType = static_cast<juce::int8>(type);
+                entry.messageIndex = static_cast<juce::int8>(messageIndex);
+                entry.channel = static_cast<juce::int8>(message.addressHasChannel ? static_cast<int>(i) / numNumbers + 1 : 0);
+                entry.number = static_cast<juce::int16>(message.addressHasNumber ? static_cast<int>(i) % numNumbers : -1);
+
+                auto slot = entry.hash & addressMask;
+                while (addressTable[slot].addressOffset >= 0)
+                    slot = (slot + 1) & addressMask;
+
+                addressTable[slot] = entry;
+            }
+        }
+    }
+}
+
+//==============================================================================
+juce::uint32 ProtocolProfile::hashAddress(const char* address) noexcept
+{
+    // FNV-1a
+    juce::uint32 hash = 2166136261u;
+    for (; *address != 0; ++address)
+        hash = (hash ^ static_cast<juce::uint8>(*address)) * 16777619u;
+
+    return hash;
+}
+
+//------------------------------------------------------------------------------
+int ProtocolProfile::headerIndex(const Message& message, int channel, int number) noexcept
+{
+    int channelIndex = message.addressHasChannel ? juce::jlimit(1, 16, channel) - 1 : 0;
+    int numberIndex = message.addressHasNumber ? juce::jlimit(0, 127, number) : 0;
+    return channelIndex * (message.addressHasNumber ? 128 : 1) + numberIndex;
+}
+
+//------------------------------------------------------------------------------
+const ProtocolProfile::AddressEntry* ProtocolProfile::findAddress(const char* address) const noexcept
+{
+    if (addressTable.empty())
+        return nullptr;
+
+    auto hash = hashAddress(address);
+
+    for (auto slot = hash & addressMask;; slot = (slot + 1) & addressMask)
+    {
+        auto& entry = addressTable[slot];
+        if (entry.addressOffset < 0)
+            return nullptr;
+
+        if (entry.hash == hash && std::strcmp(headerPool.data() + entry.addressOffset, address) == 0)
+            return &entry;
+    }
+}
+
+//------------------------------------------------------------------------------
+bool ProtocolProfile::acceptsAddress(const char* address) const noexcept
+{
+    return findAddress(address) != nullptr;
+}
+
+//------------------------------------------------------------------------------
+int ProtocolProfile::encodeMessage(const Message& message, const Event& event, char* dest) const noexcept
+{
+    int index = headerIndex(message, event.channel, event.number);
+    int size = message.headerSizes[static_cast<size_t>(index)];
+    std::memcpy(dest, headerPool.data() + message.headerOffsets[static_cast<size_t>(index)], static_cast<size_t>(size));
+
+    for (auto& argument : message.arguments)
+    {
+        int midiValue = argument.field == Field::Number ? event.number
+                      : argument.field == Field::Channel ? event.channel
+                                                         : event.value;
+
+        float oscValue = static_cast<float>(juce::jlimit(argument.midiMin, argument.midiMax, midiValue)) * argument.scale + argument.offset;
+
+        juce::uint32 bits;
+        if (argument.type == 'i')
+        {
+            bits = static_cast<juce::uint32>(juce::roundToInt(oscValue));
+        }
+        else
+        {
+            std::memcpy(&bits, &oscValue, sizeof(bits));
+        }
+
+        writeBigEndian(dest + size, bits);
+        size += 4;
+    }
+
+    return size;
+}
+
+//------------------------------------------------------------------------------
+int ProtocolProfile::readArguments(OscMessageReader& message, float* arguments) noexcept
+{
+    int numArguments = 0;
+
+    while (numArguments < maxArguments && message.getNextType() != 0)
+    {
+        juce::int32 intValue;
+        float floatValue;
+
+        if (message.getNextType() == 'i' && message.readInt32(intValue))
+            arguments[numArguments++] = static_cast<float>(intValue);
+        else if (message.getNextType() == 'f' && message.readFloat32(floatValue))
+            arguments[numArguments++] = floatValue;
+        else if (message.skip())
+            arguments[numArguments++] = 0.0f;
+        else
+            break;
+    }
+
+    return numArguments;
+}
+
+//------------------------------------------------------------------------------
+bool ProtocolProfile::decode(const char* address, const float* arguments, int numArguments,
+                             DecoderState& state, Event& result) const noexcept
+{
+    auto* entry = findAddress(address);
+    if (entry == nullptr)
+        return false;
+
+    auto& message = eventMessages[entry->eventType][static_cast<size_t>(entry->messageIndex)];
+    int count = juce::jmin(numArguments, static_cast<int>(message.arguments.size()));
+
+    auto toMidi = [&](int i)
+        {
+            auto& argument = message.arguments[static_cast<size_t>(i)];
+            return juce::jlimit(argument.midiMin, argument.midiMax,
+                                juce::roundToInt((arguments[i] - argument.offset) / argument.scale));
+        };
+
+    // The channel has to be known before anything can be latched against it
+    int channel = entry->channel > 0 ? entry->channel : 1;
+    for (int i = 0; i < count; ++i)
+        if (message.arguments[static_cast<size_t>(i)].field == Field::Channel)
+            channel = toMidi(i);
+
+    auto& number = state.latchedNumber[entry->eventType][channel - 1];
+    auto& value = state.latchedValue[entry->eventType][channel - 1];
+
+    if (entry->number >= 0)
+        number = entry->number;
+
+    for (int i = 0; i < count; ++i)
+    {
+        auto field = message.arguments[static_cast<size_t>(i)].field;
+        if (field == Field::Number)
+            number = toMidi(i);
+        else if (field == Field::Value)
+            value = toMidi(i);
+    }
+
+    if (!message.emitsEvent)
+        return false;
+
+    result.type = static_cast<EventType>(entry->eventType);
+    result.channel = channel;
+    result.number = number;
+    result.value = value;
+    return true;
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+#include "OscPacket.h"
+
+//==============================================================================
+// An OSC address scheme (Patchworld, TouchOSC, Max...) describing how each kind
+// of MIDI event maps to one or more OSC messages.
+//
+// Profiles are loaded from JSON and compiled once into lookup tables: every
+// address a profile can produce is pre-encoded (padded address plus type tag
+// string), and every address it accepts is placed in a hash table. Encoding
+// and decoding an event therefore only copies bytes and scales arguments, and
+// swapping profiles is a pointer change.
+//
+// Profile file format:
+//   {
+//     "name": "TouchOSC",
+//     "events": {
+//       "noteOn":  [ { "address": "/ch{channel}/note/{number}",
+//                      "args": [ { "field": "velocity", "type": "float", "range": [0, 1] } ] } ],
+//       "noteOff": [ ... ], "cc": [ ... ], "pitch": [ ... ], "pressure": [ ... ]
+//     }
+//   }
+// {channel} expands to 1-16 and {number} to the note or controller number 0-127.
+// Argument fields are "number" (alias "note"/"controller"), "value" (alias
+// "velocity"/"bend"/"pressure") and "channel"; "range" maps the field's MIDI
+// range linearly onto the OSC value and defaults to the MIDI range itself.
+// When an event uses several messages, incoming earlier messages only latch
+// their fields and the last one in the list emits the MIDI event.
+class ProtocolProfile : public juce::ReferenceCountedObject
+{
+public:
+    using Ptr = juce::ReferenceCountedObjectPtr<ProtocolProfile>;
+
+    enum class EventType
+    {
+        NoteOn,
+        NoteOff,
+        ControlChange,
+        PitchBend,
+        ChannelPressure
+    };
+
+    static constexpr int numEventTypes = 5;
+    static constexpr int maxArguments = 8;
+
+    // A MIDI event in MIDI units: channel 1-16, number 0-127 (note or controller),
+    // value 0-127 (velocity, CC value, pressure) or 0-16383 (pitch bend).
+    struct Event
+    {
+        EventType type = EventType::NoteOn;
+        int channel = 1;
+        int number = 0;
+        int value = 0;
+    };
+
+    // Per-connection state for multi-message events (e.g. /chXcc followed by /chXccvalue).
+    struct DecoderState
+    {
+        int latchedNumber[numEventTypes][16] = {};
+        int latchedValue[numEventTypes][16] = {};
+    };
+
+    //==================================================================
+    // The scheme from the README, matching what the bridge has always sent.
+    static Ptr createPatchworld();
+
+    // Returns nullptr and fills error if the file can't be read or compiled.
+    static Ptr loadFromFile(const juce::File& file, juce::String& error);
+    static Ptr fromJSON(const juce::var& json, juce::String& error);
+
+    const juce::String& getName() const noexcept { return name; }
+
+    //==================================================================
+    // Encodes an event into one packet per message template, calling
+    // sendPacket(const char* data, int size) for each. Doesn't allocate.
+    template <typename PacketCallback>
+    void encode(const Event& event, PacketCallback&& sendPacket) const
+    {
+        auto& messages = eventMessages[static_cast<int>(event.type)];
+        char packet[OscPacket::maxPacketSize];
+
+        for (auto& message : messages)
+        {
+            int size = encodeMessage(message, event, packet);
+            if (size > 0)
+                sendPacket(static_cast<const char*>(packet), size);
+        }
+    }
+
+    // Reads up to maxArguments of a message's arguments for decode(): ints and floats
+    // by value, any other type as 0 so later arguments keep their positions. Stops at
+    // an argument that can't be skipped. Returns the number read.
+    static int readArguments(OscMessageReader& message, float* arguments) noexcept;
+
+    // Looks up an incoming address and updates state with its arguments. Returns
+    // true and fills result when the message completes an event.
+    bool decode(const char* address, const float* arguments, int numArguments,
+                DecoderState& state, Event& result) const noexcept;
+
+    // True if the profile has any message at this address.
+    bool acceptsAddress(const char* address) const noexcept;
+
+private:
+    enum class Field { Number, Value, Channel };
+
+    struct Argument
+    {
+        Field field = Field::Value;
+        char type = 'f';              // 'i' or 'f'
+        float scale = 1.0f;           // osc = midi * scale + offset
+        float offset = 0.0f;
+        int midiMin = 0, midiMax = 127;
+    };
+
+    struct Message
+    {
+        bool emitsEvent = true;        // last message of its event
+        bool addressHasChannel = false;
+        bool addressHasNumber = false;
+        std::vector<Argument> arguments;
+
+        // Offsets into headerPool of the pre-encoded address + type tags for each
+        // [channel][number] combination the address template can produce.
+        std::vector<int> headerOffsets;
+        std::vector<juce::uint16> headerSizes;
+    };
+
+    struct AddressEntry
+    {
+        juce::uint32 hash = 0;
+        int addressOffset = -1;        // into headerPool; -1 marks an empty slot
+        juce::int8 eventType = 0;
+        juce::int8 messageIndex = 0;   // into eventMessages[eventType]
+        juce::int8 channel = 0;
+        juce::int16 number = -1;       // -1 when the number comes from an argument
+    };
+
+    ProtocolProfile() = default;
+
+    bool addMessage(EventType type, const juce::var& json, bool isLast, juce::String& error);
+    void compileHeaders(Message& message, const juce::String& addressTemplate);
+    void buildAddressTable();
+    int encodeMessage(const Message& message, const Event& event, char* dest) const noexcept;
+    const AddressEntry* findAddress(const char* address) const noexcept;
+
+    static juce::uint32 hashAddress(const char* address) noexcept;
+    static int headerIndex(const Message& message, int channel, int number) noexcept;
+
+    juce::String name;
+
+    std::vector<Message> eventMessages[numEventTypes];
+
+    std::vector<char> headerPool;
+    std::vector<AddressEntry> addressTable;   // open addressing, power-of-two size
+    juce::uint32 addressMask = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ProtocolProfile)
+};
@@ -0,0 +1,276 @@
+#include "SessionCapture.h"
+#include "LatencyMonitor.h"
+
+namespace
+{
+    void writeLittleEndian(char* dest, juce::uint64 value, int numBytes) noexcept
+    {
+        for (int i = 0; i < numBytes; ++i)
+            dest[i] = static_cast<char>((value >> (8 * i)) & 0xff);
+    }
+
+    juce::uint64 readLittleEndian(const char* source, int numBytes) noexcept
+    {
+        juce::uint64 value = 0;
+        for (int i = 0; i < numBytes; ++i)
+            value |= static_cast<juce::uint64>(static_cast<juce::uint8>(source[i])) << (8 * i);
+        return value;
+    }
+}
+
+//==============================================================================
+CaptureRecorder::CaptureRecorder()
+    : juce::Thread("Capture writer")
+{
+    buffer.allocate(bufferSize, false);
+}
+
+CaptureRecorder::~CaptureRecorder()
+{
+    stop();
+}
+
+//------------------------------------------------------------------------------
+bool CaptureRecorder::start(const juce::File& file)
+{
+    stop();
+
+    file.deleteFile();
+    auto newStream = std::make_unique<juce::FileOutputStream>(file, 1024 * 1024);
+    if (!newStream->openedOk())
+        return false;
+
+    char header[SessionCapture::fileHeaderSize] = {};
+    std::memcpy(header, SessionCapture::magic, sizeof(SessionCapture::magic));
+    writeLittleEndian(header + 8, SessionCapture::version, 4);
+    writeLittleEndian(header + 16, static_cast<juce::uint64>(juce::Time::currentTimeMillis()), 8);
+    newStream->write(header, sizeof(header));
+
+    stream = std::move(newStream);
+    captureFile = file;
+    fifo.reset();
+    numRecorded.store(0, std::memory_order_relaxed);
+    numDropped.store(0, std::memory_order_relaxed);
+    startTimeNs = LatencyMonitor::now();
+
+    startThread();
+    recording.store(true, std::memory_order_release);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void CaptureRecorder::stop()
+{
+    if (!recording.exchange(false, std::memory_order_acq_rel))
+        return;
+
+    // Wait for any producer that got in before the flag was cleared
+    {
+        const juce::SpinLock::ScopedLockType lock(writeLock);
+    }
+
+    signalThreadShouldExit();
+    dataReady.signal();
+    stopThread(5000);
+
+    stream.reset();
+}
+
+//------------------------------------------------------------------------------
+void CaptureRecorder::record(SessionCapture::Source source, const void* data, int size, juce::int64 timeNs) noexcept
+{
+    if (!recording.load(std::memory_order_acquire) || size < 0 || size > SessionCapture::maxPayloadSize)
+        return;
+
+    char header[SessionCapture::recordHeaderSize];
+    writeLittleEndian(header, static_cast<juce::uint64>(juce::jmax<juce::int64>(0, timeNs - startTimeNs)), 8);
+    header[8] = static_cast<char>(source);
+    header[9] = 0;
+    writeLittleEndian(header + 10, static_cast<juce::uint64>(size), 2);
+
+    const int total = SessionCapture::recordHeaderSize + size;
+
+    const juce::SpinLock::ScopedLockType lock(writeLock);
+
+    if (!recording.load(std::memory_order_relaxed))
+        return;
+
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite(total, start1, size1, start2, size2);
+
+    if (size1 + size2 < total)
+    {
+        numDropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // The record may wrap around the end of the ring buffer
+    auto copy = [&](const char* bytes, int length, int offset)
+        {
+            for (int i = 0; i < length; ++i, ++offset)
+                buffer[offset < size1 ? start1 + offset : start2 + offset - size1] = bytes[i];
+        };
+
+    if (size2 == 0)
+    {
+        std::memcpy(buffer + start1, header, sizeof(header));
+        std::memcpy(buffer + start1 + sizeof(header), data, static_cast<size_t>(size));
+    }
+    else
+    {
+        copy(header, static_cast<int>(sizeof(header)), 0);
+        copy(static_cast<const char*>(data), size, static_cast<int>(sizeof(header)));
+    }
+
+    fifo.finishedWrite(total);
+    numRecorded.fetch_add(1, std::memory_order_relaxed);
+
+    // The writer polls, so it only needs waking when the buffer is getting full
+    if (fifo.getFreeSpace() < bufferSize / 2)
+        dataReady.signal();
+}
+
+//------------------------------------------------------------------------------
+void CaptureRecorder::run()
+{
+    while (!threadShouldExit())
+    {
+        dataReady.wait(20);
+        drain();
+    }
+
+    drain();
+    stream->flush();
+}
+
+//------------------------------------------------------------------------------
+void CaptureRecorder::drain()
+{
+    int start1, size1, start2, size2;
+    fifo.prepareToRead(fifo.getNumReady(), start1, size1, start2, size2);
+
+    if (size1 > 0)
+        stream->write(buffer + start1, static_cast<size_t>(size1));
+    if (size2 > 0)
+        stream->write(buffer + start2, static_cast<size_t>(size2));
+
+    fifo.finishedRead(size1 + size2);
+}
+
+//==============================================================================
+CaptureReplayer::CaptureReplayer()
+    : juce::Thread("Capture replay")
+{
+}
+
+CaptureReplayer::~CaptureReplayer()
+{
+    stop();
+}
+
+//------------------------------------------------------------------------------
+juce::String CaptureReplayer::open(const juce::File& file)
+{
+    stop();
+
+    mappedFile = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+    auto* data = static_cast<const char*>(mappedFile->getData());
+    auto size = static_cast<juce::int64>(mappedFile->getSize());
+
+    if (data == nullptr || size < SessionCapture::fileHeaderSize
+        || std::memcmp(data, SessionCapture::magic, sizeof(SessionCapture::magic)) != 0)
+    {
+        mappedFile.reset();
+        return "Not a capture file: " + file.getFullPathName();
+    }
+
+    if (readLittleEndian(data + 8, 4) != SessionCapture::version)
+    {
+        mappedFile.reset();
+        return "Unsupported capture version in " + file.getFullPathName();
+    }
+
+    // Timestamps grow through the file, so the last complete record gives the duration
+    juce::uint64 lastTime = 0;
+    for (juce::int64 position = SessionCapture::fileHeaderSize; position + SessionCapture::recordHeaderSize <= size;)
+    {
+        auto payloadSize = static_cast<juce::int64>(readLittleEndian(data + position + 10, 2));
+        if (position + SessionCapture::recordHeaderSize + payloadSize > size)
+            break;
+
+        lastTime = juce::jmax(lastTime, readLittleEndian(data + position, 8));
+        position += SessionCapture::recordHeaderSize + payloadSize;
+    }
+
+    capturedSeconds = static_cast<double>(lastTime) / 1.0e9;
+    return {};
+}
+
+//------------------------------------------------------------------------------
+void CaptureReplayer::start(double newSpeed, EventCallback onEvent, std::function<void()> onFinished)
+{
+    stop();
+
+    if (mappedFile == nullptr)
+        return;
+
+    speed = newSpeed;
+    eventCallback = std::move(onEvent);
+    finishedCallback = std::move(onFinished);
+    numReplayed.store(0, std::memory_order_relaxed);
+    elapsedSeconds.store(0.0, std::memory_order_relaxed);
+
+    startThread(juce::Thread::Priority::high);
+}
+
+//------------------------------------------------------------------------------
+void CaptureReplayer::stop()
+{
+    stopThread(2000);
+}
+
+//------------------------------------------------------------------------------
+void CaptureReplayer::run()
+{
+    auto* data = static_cast<const char*>(mappedFile->getData());
+    auto size = static_cast<juce::int64>(mappedFile->getSize());
+    auto startTime = LatencyMonitor::now();
+
+    for (juce::int64 position = SessionCapture::fileHeaderSize; position + SessionCapture::recordHeaderSize <= size;)
+    {
+        if (threadShouldExit())
+            break;
+
+        auto* record = data + position;
+        auto time = static_cast<juce::int64>(readLittleEndian(record, 8));
+        auto source = static_cast<SessionCapture::Source>(record[8]);
+        auto payloadSize = static_cast<int>(readLittleEndian(record + 10, 2));
+
+        if (position + SessionCapture::recordHeaderSize + payloadSize > size)
+            break;
+
+        if (speed > 0.0)
+        {
+            // Sleep until close to the event, then yield for the last couple of milliseconds
+            auto due = startTime + static_cast<juce::int64>(static_cast<double>(time) / speed);
+
+            for (auto remaining = due - LatencyMonitor::now(); remaining > 0 && !threadShouldExit(); remaining = due - LatencyMonitor::now())
+            {
+                if (remaining > 2000000)
+                    juce::Thread::sleep(static_cast<int>((remaining - 2000000) / 1000000) + 1);
+                else
+                    juce::Thread::yield();
+            }
+        }
+
+        eventCallback(source, record + SessionCapture::recordHeaderSize, payloadSize);
+        numReplayed.fetch_add(1, std::memory_order_relaxed);
+
+        position += SessionCapture::recordHeaderSize + payloadSize;
+    }
+
+    elapsedSeconds.store(static_cast<double>(LatencyMonitor::now() - startTime) / 1.0e9, std::memory_order_relaxed);
+
+    if (finishedCallback)
+        finishedCallback();
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+
+//==============================================================================
+// Binary capture format for ingress traffic.
+//
+//   file header   "OSC2MCAP", uint32 version, uint32 reserved, int64 wall-clock start (ms since epoch)
+//   records       uint64 time (ns since capture start), uint8 source, uint8 reserved,
+//                 uint16 payload size, payload (raw MIDI bytes or a raw OSC message)
+//
+// All integers are little-endian. Records are appended in the order they were
+// captured, which is close to but not strictly timestamp order when several
+// threads are capturing.
+namespace SessionCapture
+{
+    constexpr char magic[8] = { 'O', 'S', 'C', '2', 'M', 'C', 'A', 'P' };
+    constexpr juce::uint32 version = 1;
+    constexpr int fileHeaderSize = 24;
+    constexpr int recordHeaderSize = 12;
+    constexpr int maxPayloadSize = 65535;
+
+    enum class Source : juce::uint8
+    {
+        midiInput = 0,   // bytes from the MIDI input device
+        keyboard,        // note on/off from the on-screen keyboard
+        oscMessage       // one OSC message as it arrived (or re-encoded from juce::OSCMessage)
+    };
+}
+
+//==============================================================================
+// Appends ingress events to a capture file. record() may be called from any
+// thread: it copies the event into a ring buffer under a spin lock and returns;
+// a background thread drains the buffer to disk with large buffered writes.
+// If the disk can't keep up, records are dropped and counted rather than
+// blocking the live path.
+class CaptureRecorder : private juce::Thread
+{
+public:
+    CaptureRecorder();
+    ~CaptureRecorder() override;
+
+    // Creates (or overwrites) the file and starts capturing; returns false if it can't be opened.
+    bool start(const juce::File& file);
+
+    // Stops capturing, writes out everything buffered and closes the file.
+    void stop();
+
+    bool isRecording() const noexcept { return recording.load(std::memory_order_relaxed); }
+
+    // timeNs is a LatencyMonitor::now() timestamp.
+    void record(SessionCapture::Source source, const void* data, int size, juce::int64 timeNs) noexcept;
+
+    juce::uint64 getNumRecorded() const noexcept { return numRecorded.load(std::memory_order_relaxed); }
+    juce::uint64 getNumDropped() const noexcept  { return numDropped.load(std::memory_order_relaxed); }
+    juce::File getFile() const                   { return captureFile; }
+
+    static constexpr int bufferSize = 4 * 1024 * 1024;
+
+private:
+    void run() override;
+    void drain();
+
+    std::atomic<bool> recording { false };
+    juce::int64 startTimeNs = 0;
+
+    juce::AbstractFifo fifo { bufferSize };
+    juce::HeapBlock<char> buffer;
+    juce::SpinLock writeLock;          // serialises producers; the writer thread never takes it
+    juce::WaitableEvent dataReady;
+
+    std::unique_ptr<juce::FileOutputStream> stream;
+    juce::File captureFile;
+
+    std::atomic<juce::uint64> numRecorded { 0 }, numDropped { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CaptureRecorder)
+};
+
+//==============================================================================
+// Plays a capture file back from a background thread, either with its original
+// timing (optionally sped up) or as fast as possible. The file is memory-mapped,
+// so records go straight from the page cache to the callback without copying.
+class CaptureReplayer : private juce::Thread
+{
+public:
+    using EventCallback = std::function<void(SessionCapture::Source source, const char* data, int size)>;
+
+    CaptureReplayer();
+    ~CaptureReplayer() override;
+
+    // Maps the file and checks its header; returns an error message, or an empty string.
+    juce::String open(const juce::File& file);
+
+    // Replays the opened file. speed scales the original timing (2.0 = twice as fast);
+    // 0 replays as fast as possible. Both callbacks are called on the replay thread.
+    void start(double speed, EventCallback onEvent, std::function<void()> onFinished);
+    void stop();
+
+    bool isReplaying() const noexcept                { return isThreadRunning(); }
+
+    juce::uint64 getNumReplayed() const noexcept     { return numReplayed.load(std::memory_order_relaxed); }
+    double getElapsedSeconds() const noexcept        { return elapsedSeconds.load(std::memory_order_relaxed); }
+    double getCapturedSeconds() const noexcept       { return capturedSeconds; }
+
+private:
+    void run() override;
+
+    std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+    double capturedSeconds = 0.0;
+
+    double speed = 1.0;
+    EventCallback eventCallback;
+    std::function<void()> finishedCallback;
+
+    std::atomic<juce::uint64> numReplayed { 0 };
+    std::atomic<double> elapsedSeconds { 0.0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CaptureReplayer)
+};
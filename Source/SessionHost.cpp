@@ -0,0 +1,172 @@
+#include "SessionHost.h"
+#include <iostream>
+
+//==============================================================================
+SessionWorker::SessionWorker(int index)
+    : juce::Thread("Session worker " + juce::String(index + 1))
+{
+}
+
+SessionWorker::~SessionWorker()
+{
+    stop();
+}
+
+void SessionWorker::start()
+{
+    startThread(juce::Thread::Priority::high);
+}
+
+void SessionWorker::stop()
+{
+    signalThreadShouldExit();
+    wake();
+    stopThread(2000);
+}
+
+//------------------------------------------------------------------------------
+void SessionWorker::run()
+{
+    int timeoutMs = 100;
+
+    while (!threadShouldExit())
+    {
+        // A wake between two waits is remembered, so no request is missed
+        wakeEvent.wait(timeoutMs);
+
+        // Sooner if a session has events held back by a source's rate limit
+        timeoutMs = 100;
+        for (auto* session : sessions)
+        {
+            auto retryMs = session->drainIfPending();
+            if (retryMs >= 0)
+                timeoutMs = juce::jmin(timeoutMs, retryMs);
+        }
+    }
+}
+
+//==============================================================================
+SessionHost::SessionHost(const juce::StringArray& args)
+{
+    auto error = start(args);
+
+    if (error.isNotEmpty())
+    {
+        std::cerr << error << std::endl;
+        juce::JUCEApplication::getInstance()->setApplicationReturnValue(1);
+        juce::JUCEApplication::quit();
+    }
+}
+
+SessionHost::~SessionHost()
+{
+    stopTimer();
+    timerCallback();
+
+    // No drain may run once sessions start going; a stopped worker can still be woken harmlessly
+    for (auto& worker : workers)
+        worker->stop();
+
+    sessions.clear();
+    workers.clear();
+}
+
+//------------------------------------------------------------------------------
+juce::String SessionHost::start(const juce::StringArray& args)
+{
+    auto getOption = [&args](const char* name)
+        {
+            int index = args.indexOf(name);
+            return index >= 0 && index + 1 < args.size() ? args[index + 1] : juce::String();
+        };
+
+    auto sessionsFile = juce::File::getCurrentWorkingDirectory().getChildFile(getOption("--sessions"));
+    if (!sessionsFile.existsAsFile())
+        return "Sessions file not found: " + sessionsFile.getFullPathName();
+
+    std::vector<juce::StringArray> sessionArgs;
+    juce::StringArray lines;
+    sessionsFile.readLines(lines);
+
+    for (auto& line : lines)
+    {
+        auto trimmed = line.trim();
+        if (trimmed.isNotEmpty() && !trimmed.startsWithChar('#'))
+            sessionArgs.push_back(parseSessionLine(trimmed));
+    }
+
+    if (sessionArgs.empty())
+        return "No sessions in " + sessionsFile.getFullPathName();
+
+    auto numSessions = static_cast<int>(sessionArgs.size());
+    auto numWorkers = getOption("--workers").isNotEmpty() ? getOption("--workers").getIntValue()
+                                                          : juce::SystemStats::getNumCpus() - 1;
+    numWorkers = juce::jlimit(1, numSessions, numWorkers);
+
+    for (int i = 0; i < numWorkers; ++i)
+        workers.push_back(std::make_unique<SessionWorker>(i));
+
+    // Each session is tied to its worker before it starts, so its first event already goes there
+    for (int i = 0; i < numSessions; ++i)
+    {
+        auto& worker = *workers[static_cast<size_t>(i % numWorkers)];
+        sessions.push_back(std::make_unique<MainComponent>());
+
+        auto& session = *sessions.back();
+        session.setSessionWorker(&worker);
+        worker.addSession(session);
+    }
+
+    for (auto& worker : workers)
+        worker->start();
+
+    for (int i = 0; i < numSessions; ++i)
+    {
+        auto& options = sessionArgs[static_cast<size_t>(i)];
+        auto error = sessions[static_cast<size_t>(i)]->startHeadless(options);
+
+        if (error.isNotEmpty())
+            return "Session " + juce::String(i + 1) + ": " + error;
+
+        std::cout << "Session " << (i + 1) << " on worker " << (i % numWorkers + 1) << ": "
+                  << options.joinIntoString(" ") << std::endl;
+    }
+
+    std::cout << "Hosting " << numSessions << " sessions on " << numWorkers << " worker threads" << std::endl;
+
+    auto dumpFile = getOption("--latency-dump");
+    if (dumpFile.isNotEmpty())
+    {
+        latencyDumpFile = juce::File::getCurrentWorkingDirectory().getChildFile(dumpFile);
+
+        auto intervalSeconds = getOption("--dump-interval");
+        startTimer(juce::jmax(1, intervalSeconds.isNotEmpty() ? intervalSeconds.getIntValue() : 10) * 1000);
+    }
+
+    return {};
+}
+
+//------------------------------------------------------------------------------
+void SessionHost::timerCallback()
+{
+    if (latencyDumpFile == juce::File())
+        return;
+
+    for (size_t i = 0; i < sessions.size(); ++i)
+        sessions[i]->writeLatencyReport(latencyDumpFile.getSiblingFile(latencyDumpFile.getFileNameWithoutExtension()
+                                                                       + "-" + juce::String(static_cast<int>(i) + 1)
+                                                                       + latencyDumpFile.getFileExtension()));
+}
+
+//------------------------------------------------------------------------------
+juce::StringArray SessionHost::parseSessionLine(const juce::String& line)
+{
+    juce::StringArray tokens;
+    tokens.addTokens(line, " \t", "\"");
+    tokens.removeEmptyStrings();
+
+    for (auto& token : tokens)
+        token = token.unquoted();
+
+    return tokens;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+#include "MainComponent.h"
+
+//==============================================================================
+// One thread draining the MIDI->OSC queues of the sessions assigned to it. A
+// session wakes it when it has queued events; the worker then drains every one
+// of its sessions that asked.
+class SessionWorker : private juce::Thread
+{
+public:
+    explicit SessionWorker(int index);
+    ~SessionWorker() override;
+
+    // Sessions are assigned before start() and never move to another worker.
+    void addSession(MainComponent& session) { sessions.push_back(&session); }
+    int getNumSessions() const noexcept { return static_cast<int>(sessions.size()); }
+
+    void start();
+    void stop();
+
+    // From any thread; doesn't block or allocate.
+    void wake() noexcept { wakeEvent.signal(); }
+
+private:
+    void run() override;
+
+    std::vector<MainComponent*> sessions;
+    juce::WaitableEvent wakeEvent;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SessionWorker)
+};
+
+//==============================================================================
+// Hosts several independent bridge sessions in one process, run with
+// --sessions <file>. Each line of the file holds one session's headless options
+// (its own ports, protocol, MIDI devices, transforms; see --headless), and each
+// session is a full bridge with its own receiver thread, queues and note state.
+//
+// The MIDI->OSC drain, which a single bridge runs on the message thread, runs on
+// a small pool of workers here: session i belongs to worker i % numWorkers for
+// its whole life, so a worker only ever touches its own sessions and nothing is
+// locked across sessions.
+//
+// Only that drain is sharded. Each session still runs its own OSC receiver
+// thread (the OSC->MIDI route), so there is one such thread per session rather
+// than per worker. Every session's log flushing, stats requests and replies, ARP
+// and retry timers share the one message thread, which can become the limit
+// with many busy sessions.
+//
+//   --sessions <file>        one session per line; blank lines and # comments are skipped
+//   --workers <n>            worker threads (default: one per core but one, at most one per session)
+//   --latency-dump <file>    each session's latency report to <file>-<session number>, rewritten
+//                            every --dump-interval seconds (default 10) and on exit
+class SessionHost : private juce::Timer
+{
+public:
+    explicit SessionHost(const juce::StringArray& args);
+    ~SessionHost() override;
+
+private:
+    void timerCallback() override;
+    juce::String start(const juce::StringArray& args);
+
+    // Splits a line of the sessions file into arguments, honouring double quotes
+    static juce::StringArray parseSessionLine(const juce::String& line);
+
+    std::vector<std::unique_ptr<SessionWorker>> workers;
+    std::vector<std::unique_ptr<MainComponent>> sessions;
+    juce::File latencyDumpFile;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SessionHost)
+};
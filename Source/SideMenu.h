@@ -20,6 +20,38 @@ public:
         buttonMixer.setButtonText("Mixer");
         buttonMixer.onClick = [this]() { handleMenuClick(3); };
 
+        addAndMakeVisible(buttonMidiFilter);
+        buttonMidiFilter.setButtonText("MIDI Filter");
+        buttonMidiFilter.onClick = [this]() { handleMenuClick(4); };
+
+        addAndMakeVisible(buttonTransforms);
+        buttonTransforms.setButtonText("Transforms");
+        buttonTransforms.onClick = [this]() { handleMenuClick(5); };
+
+        addAndMakeVisible(buttonLatency);
+        buttonLatency.setButtonText("Latency");
+        buttonLatency.onClick = [this]() { handleMenuClick(6); };
+
+        addAndMakeVisible(buttonCapture);
+        buttonCapture.setButtonText("Capture");
+        buttonCapture.onClick = [this]() { handleMenuClick(7); };
+
+        addAndMakeVisible(buttonReplay);
+        buttonReplay.setButtonText("Replay");
+        buttonReplay.onClick = [this]() { handleMenuClick(8); };
+
+        addAndMakeVisible(buttonTrace);
+        buttonTrace.setButtonText("Trace");
+        buttonTrace.onClick = [this]() { handleMenuClick(9); };
+
+        addAndMakeVisible(buttonJitter);
+        buttonJitter.setButtonText("Jitter Buffer");
+        buttonJitter.onClick = [this]() { handleMenuClick(10); };
+
+        addAndMakeVisible(buttonPacing);
+        buttonPacing.setButtonText("DIN Pacing");
+        buttonPacing.onClick = [this]() { handleMenuClick(11); };
+
         // Initialize Close Button
         addAndMakeVisible(closeButton);
         closeButton.setButtonText(juce::String::fromUTF8("✕"));
@@ -35,6 +67,14 @@ public:
         buttonCC.setColour(juce::TextButton::buttonColourId, button == &buttonCC ? juce::Colours::yellow : juce::Colours::grey);
         buttonFileBrowser.setColour(juce::TextButton::buttonColourId, button == &buttonFileBrowser ? juce::Colours::yellow : juce::Colours::grey);
         buttonMixer.setColour(juce::TextButton::buttonColourId, button == &buttonMixer ? juce::Colours::yellow : juce::Colours::grey);
+        buttonMidiFilter.setColour(juce::TextButton::buttonColourId, button == &buttonMidiFilter ? juce::Colours::yellow : juce::Colours::grey);
+        buttonTransforms.setColour(juce::TextButton::buttonColourId, button == &buttonTransforms ? juce::Colours::yellow : juce::Colours::grey);
+        buttonLatency.setColour(juce::TextButton::buttonColourId, button == &buttonLatency ? juce::Colours::yellow : juce::Colours::grey);
+        buttonCapture.setColour(juce::TextButton::buttonColourId, button == &buttonCapture ? juce::Colours::yellow : juce::Colours::grey);
+        buttonReplay.setColour(juce::TextButton::buttonColourId, button == &buttonReplay ? juce::Colours::yellow : juce::Colours::grey);
+        buttonTrace.setColour(juce::TextButton::buttonColourId, button == &buttonTrace ? juce::Colours::yellow : juce::Colours::grey);
+        buttonJitter.setColour(juce::TextButton::buttonColourId, button == &buttonJitter ? juce::Colours::yellow : juce::Colours::grey);
+        buttonPacing.setColour(juce::TextButton::buttonColourId, button == &buttonPacing ? juce::Colours::yellow : juce::Colours::grey);
 
         repaint();
     }
@@ -48,6 +88,14 @@ public:
         buttonCC.setBounds(area.removeFromTop(buttonHeight).reduced(0, 5));
         buttonFileBrowser.setBounds(area.removeFromTop(buttonHeight).reduced(0, 5));
         buttonMixer.setBounds(area.removeFromTop(buttonHeight).reduced(0, 5));
+        buttonMidiFilter.setBounds(area.removeFromTop(buttonHeight).reduced(0, 5));
+        buttonTransforms.setBounds(area.removeFromTop(buttonHeight).reduced(0, 5));
+        buttonLatency.setBounds(area.removeFromTop(buttonHeight).reduced(0, 5));
+        buttonCapture.setBounds(area.removeFromTop(buttonHeight).reduced(0, 5));
+        buttonReplay.setBounds(area.removeFromTop(buttonHeight).reduced(0, 5));
+        buttonTrace.setBounds(area.removeFromTop(buttonHeight).reduced(0, 5));
+        buttonJitter.setBounds(area.removeFromTop(buttonHeight).reduced(0, 5));
+        buttonPacing.setBounds(area.removeFromTop(buttonHeight).reduced(0, 5));
 
         // Position close button
         closeButton.setBounds(area.removeFromTop(buttonHeight).withWidth(30).withPosition(area.getRight() - 40, 10));
@@ -70,6 +118,14 @@ private:
         case 1: setActiveButton(&buttonCC); break;
         case 2: setActiveButton(&buttonFileBrowser); break;
         case 3: setActiveButton(&buttonMixer); break;
+        case 4: setActiveButton(&buttonMidiFilter); break;
+        case 5: setActiveButton(&buttonTransforms); break;
+        case 6: setActiveButton(&buttonLatency); break;
+        case 7: setActiveButton(&buttonCapture); break;
+        case 8: setActiveButton(&buttonReplay); break;
+        case 9: setActiveButton(&buttonTrace); break;
+        case 10: setActiveButton(&buttonJitter); break;
+        case 11: setActiveButton(&buttonPacing); break;
         default: break;
         }
     }
@@ -77,6 +133,14 @@ private:
     juce::TextButton buttonCC{ "CC" };
     juce::TextButton buttonFileBrowser{ "File Browser" };
     juce::TextButton buttonMixer{ "Mixer" };
+    juce::TextButton buttonMidiFilter{ "MIDI Filter" };
+    juce::TextButton buttonTransforms{ "Transforms" };
+    juce::TextButton buttonLatency{ "Latency" };
+    juce::TextButton buttonCapture{ "Capture" };
+    juce::TextButton buttonReplay{ "Replay" };
+    juce::TextButton buttonTrace{ "Trace" };
+    juce::TextButton buttonJitter{ "Jitter Buffer" };
+    juce::TextButton buttonPacing{ "DIN Pacing" };
 
     juce::TextButton* activeButton = nullptr; // Tracks the currently active button
 };
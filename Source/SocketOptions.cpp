@@ -0,0 +1,145 @@
+#include "SocketOptions.h"
+
+#if JUCE_WINDOWS
+ #include <winsock2.h>
+ #include <ws2tcpip.h>
+#else
+ #include <arpa/inet.h>
+ #include <netinet/in.h>
+ #include <sys/socket.h>
+#endif
+
+#if JUCE_LINUX
+ #include <linux/sock_diag.h>
+
+ #ifndef SO_MEMINFO
+  #define SO_MEMINFO 55
+ #endif
+#endif
+
+namespace SocketOptions
+{
+    namespace
+    {
+        int getOptionName(Buffer buffer) noexcept
+        {
+            return buffer == Buffer::receive ? SO_RCVBUF : SO_SNDBUF;
+        }
+
+        // An empty string is INADDR_ANY; anything that isn't a dotted IPv4 address fails
+        bool parseAddress(const juce::String& text, in_addr& address) noexcept
+        {
+            if (text.isEmpty())
+            {
+                address.s_addr = htonl(INADDR_ANY);
+                return true;
+            }
+
+            return inet_pton(AF_INET, text.toRawUTF8(), &address) == 1;
+        }
+
+        template <typename Value>
+        bool setIpOption(juce::DatagramSocket& socket, int name, const Value& value) noexcept
+        {
+            auto handle = socket.getRawSocketHandle();
+            return handle >= 0
+                && setsockopt(handle, IPPROTO_IP, name, reinterpret_cast<const char*>(&value), sizeof(value)) == 0;
+        }
+    }
+
+    //==============================================================================
+    bool setBufferSize(juce::DatagramSocket& socket, Buffer buffer, int bytes)
+    {
+        auto handle = socket.getRawSocketHandle();
+        if (handle < 0 || bytes <= 0)
+            return false;
+
+        return setsockopt(handle, SOL_SOCKET, getOptionName(buffer),
+                          reinterpret_cast<const char*>(&bytes), sizeof(bytes)) == 0;
+    }
+
+    int getBufferSize(juce::DatagramSocket& socket, Buffer buffer)
+    {
+        auto handle = socket.getRawSocketHandle();
+        if (handle < 0)
+            return 0;
+
+        int bytes = 0;
+       #if JUCE_WINDOWS
+        int length = sizeof(bytes);
+       #else
+        socklen_t length = sizeof(bytes);
+       #endif
+
+        if (getsockopt(handle, SOL_SOCKET, getOptionName(buffer), reinterpret_cast<char*>(&bytes), &length) != 0)
+            return 0;
+
+        return bytes;
+    }
+
+    //------------------------------------------------------------------------------
+    ReceiveQueue readReceiveQueue(juce::DatagramSocket& socket)
+    {
+        ReceiveQueue queue;
+
+       #if JUCE_LINUX
+        auto handle = socket.getRawSocketHandle();
+        if (handle < 0)
+            return queue;
+
+        // Older kernels fill in fewer entries, so anything they leave out stays zero
+        juce::uint32 memInfo[SK_MEMINFO_VARS] = {};
+        socklen_t length = sizeof(memInfo);
+
+        if (getsockopt(handle, SOL_SOCKET, SO_MEMINFO, memInfo, &length) == 0
+            && length > SK_MEMINFO_DROPS * sizeof(juce::uint32))
+        {
+            queue.valid = true;
+            queue.drops = memInfo[SK_MEMINFO_DROPS];
+            queue.queuedBytes = static_cast<int>(memInfo[SK_MEMINFO_RMEM_ALLOC]);
+        }
+       #else
+        juce::ignoreUnused(socket);
+       #endif
+
+        return queue;
+    }
+
+    //==============================================================================
+    bool isMulticastAddress(const juce::String& address)
+    {
+        in_addr parsed;
+        return address.isNotEmpty() && parseAddress(address, parsed)
+            && (ntohl(parsed.s_addr) & 0xf0000000) == 0xe0000000;
+    }
+
+    bool joinMulticastGroup(juce::DatagramSocket& socket, const juce::String& group, const juce::String& interfaceAddress)
+    {
+        ip_mreq request = {};
+        if (!isMulticastAddress(group)
+            || !parseAddress(group, request.imr_multiaddr)
+            || !parseAddress(interfaceAddress, request.imr_interface))
+            return false;
+
+        return setIpOption(socket, IP_ADD_MEMBERSHIP, request);
+    }
+
+    //------------------------------------------------------------------------------
+    bool setMulticastInterface(juce::DatagramSocket& socket, const juce::String& interfaceAddress)
+    {
+        in_addr address;
+        return parseAddress(interfaceAddress, address) && setIpOption(socket, IP_MULTICAST_IF, address);
+    }
+
+    bool setMulticastTtl(juce::DatagramSocket& socket, int hops)
+    {
+        // An int is what both Linux and Windows accept here (Windows wants a DWORD)
+        return hops >= 0 && hops <= 255 && setIpOption(socket, IP_MULTICAST_TTL, hops);
+    }
+
+    bool setMulticastLoopback(juce::DatagramSocket& socket, bool shouldLoopBack)
+    {
+        int value = shouldLoopBack ? 1 : 0;
+        return setIpOption(socket, IP_MULTICAST_LOOP, value);
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// Socket-level settings and counters that juce::DatagramSocket doesn't expose.
+namespace SocketOptions
+{
+    enum class Buffer
+    {
+        receive,   // SO_RCVBUF
+        send       // SO_SNDBUF
+    };
+
+    // Requests a kernel buffer size in bytes. The kernel may round or cap it
+    // (Linux doubles the request and limits it to net.core.rmem_max/wmem_max),
+    // so read back the size actually in use with getBufferSize().
+    bool setBufferSize(juce::DatagramSocket& socket, Buffer buffer, int bytes);
+    int getBufferSize(juce::DatagramSocket& socket, Buffer buffer);
+
+    // The kernel's view of a socket's receive queue: datagrams it has dropped
+    // since the socket was opened because the receive buffer was full, and the
+    // bytes currently waiting to be read. Only available on Linux (SO_MEMINFO);
+    // elsewhere valid is false.
+    struct ReceiveQueue
+    {
+        bool valid = false;
+        juce::uint32 drops = 0;
+        int queuedBytes = 0;
+    };
+
+    ReceiveQueue readReceiveQueue(juce::DatagramSocket& socket);
+
+    //==============================================================================
+    // IPv4 multicast. Interfaces are given by one of their addresses; an empty
+    // string leaves the choice to the kernel's routing table.
+
+    // True for an address in 224.0.0.0/4.
+    bool isMulticastAddress(const juce::String& address);
+
+    // Joins a group on one interface, unlike juce::DatagramSocket::joinMulticast().
+    // The socket should already be bound to the group's port.
+    bool joinMulticastGroup(juce::DatagramSocket& socket, const juce::String& group, const juce::String& interfaceAddress);
+
+    // Settings for datagrams the socket sends to a group: the interface they leave by,
+    // how many router hops they may cross (1 keeps them on the local network), and
+    // whether listeners on this host get a copy too.
+    bool setMulticastInterface(juce::DatagramSocket& socket, const juce::String& interfaceAddress);
+    bool setMulticastTtl(juce::DatagramSocket& socket, int hops);
+    bool setMulticastLoopback(juce::DatagramSocket& socket, bool shouldLoopBack);
+}
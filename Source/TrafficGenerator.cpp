@@ -0,0 +1,271 @@
+#include "TrafficGenerator.h"
+#include <iostream>
+#include "LatencyMonitor.h"
+
+namespace
+{
+    const char* const patternNames[] = { "notes", "chords", "cc", "bend", "mixed" };
+
+    // Controllers the CC sweeps move: modulation, volume, pan, expression, cutoff
+    const int sweptControllers[] = { 1, 7, 10, 11, 74 };
+}
+
+//==============================================================================
+TrafficGenerator::TrafficGenerator(const juce::StringArray& args)
+    : juce::Thread("Traffic generator")
+{
+    auto getOption = [&args](const char* name)
+        {
+            int index = args.indexOf(name);
+            return index >= 0 && index + 1 < args.size() ? args[index + 1] : juce::String();
+        };
+
+    juce::String error;
+
+    auto target = getOption("--target");
+    if (target.isNotEmpty())
+    {
+        host = target.upToLastOccurrenceOf(":", false, false);
+        port = target.fromLastOccurrenceOf(":", false, false).getIntValue();
+        if (host.isEmpty() || port <= 0 || port > 65535)
+            error = "Bad --target, expected host:port: " + target;
+    }
+
+    auto patternName = getOption("--pattern");
+    if (patternName.isNotEmpty())
+    {
+        int index = juce::StringArray(patternNames, juce::numElementsInArray(patternNames)).indexOf(patternName);
+        if (index < 0)
+            error = "Unknown pattern: " + patternName;
+        else
+            pattern = static_cast<Pattern>(index);
+    }
+
+    if (getOption("--rate").isNotEmpty())
+        rate = juce::jmax(1.0, getOption("--rate").getDoubleValue());
+    if (getOption("--duration").isNotEmpty())
+        duration = juce::jmax(0.0, getOption("--duration").getDoubleValue());
+    busyWait = args.contains("--busy-wait");
+
+    auto protocol = getOption("--protocol");
+    if (protocol.isEmpty() || protocol.equalsIgnoreCase("patchworld"))
+        profile = ProtocolProfile::createPatchworld();
+    else if (protocol != "native")
+        profile = ProtocolProfile::loadFromFile(juce::File::getCurrentWorkingDirectory().getChildFile(protocol), error);
+
+    // Each client sends from its own socket, so the bridge sees a distinct source port per client
+    auto numClients = juce::jlimit(1, 1024, getOption("--clients").isNotEmpty() ? getOption("--clients").getIntValue() : 1);
+    auto numChannels = juce::jlimit(1, 16, getOption("--channels").isNotEmpty() ? getOption("--channels").getIntValue() : 1);
+
+    for (int i = 0; i < numClients && error.isEmpty(); ++i)
+    {
+        auto* socket = clients.add(new juce::DatagramSocket());
+        if (!socket->bindToPort(0))
+            error = "Couldn't open a socket for client " + juce::String(i + 1);
+    }
+
+    // Every client gets at least one channel and every channel at least one client
+    for (int i = 0; i < juce::jmax(numClients, numChannels); ++i)
+    {
+        Voice voice;
+        voice.client = i % numClients;
+        voice.channel = i % numChannels + 1;
+        voices.push_back(voice);
+    }
+
+    if (error.isNotEmpty())
+    {
+        std::cerr << error << std::endl;
+        juce::JUCEApplication::getInstance()->setApplicationReturnValue(1);
+        juce::JUCEApplication::quit();
+        return;
+    }
+
+    std::cout << "Sending " << patternNames[static_cast<int>(pattern)] << " at " << rate << " events/s to "
+              << host << ":" << port << " from " << numClients << " client(s) on " << numChannels
+              << " channel(s), " << (profile != nullptr ? profile->getName() : juce::String("native MIDI")) << std::endl;
+
+    startThread(juce::Thread::Priority::highest);
+}
+
+TrafficGenerator::~TrafficGenerator()
+{
+    stopThread(2000);
+}
+
+//------------------------------------------------------------------------------
+void TrafficGenerator::run()
+{
+    juce::Random random(42);
+    auto interval = 1.0e9 / rate;
+    auto startTime = LatencyMonitor::now();
+    auto endTime = duration > 0.0 ? startTime + static_cast<juce::int64>(duration * 1.0e9) : std::numeric_limits<juce::int64>::max();
+    auto nextProgress = startTime + 1000000000;
+    size_t nextVoice = 0;
+
+    while (!threadShouldExit())
+    {
+        // Due times come from the event count, so timing errors don't accumulate
+        auto due = startTime + static_cast<juce::int64>(static_cast<double>(numEvents) * interval);
+        if (due >= endTime)
+            break;
+
+        for (auto remaining = due - LatencyMonitor::now(); remaining > 0; remaining = due - LatencyMonitor::now())
+        {
+            if (busyWait)
+                continue;
+
+            if (remaining > 2000000)
+                juce::Thread::sleep(static_cast<int>((remaining - 2000000) / 1000000) + 1);
+            else
+                juce::Thread::yield();
+        }
+
+        auto& voice = voices[nextVoice];
+        nextVoice = (nextVoice + 1) % voices.size();
+
+        auto voicePattern = pattern == Pattern::mixed ? static_cast<Pattern>((voice.tick / 64) % 4) : pattern;
+        numEvents += static_cast<juce::uint64>(generate(voice, voicePattern, random));
+
+        auto now = LatencyMonitor::now();
+        if (now >= nextProgress)
+        {
+            printProgress(static_cast<double>(now - startTime) / 1.0e9);
+            nextProgress += 1000000000;
+        }
+    }
+
+    // Release whatever is still held so the target isn't left with hanging notes
+    for (auto& voice : voices)
+        for (auto note : voice.heldNotes)
+            sendEvent(voice.client, ProtocolProfile::EventType::NoteOff, voice.channel, note, 0);
+
+    printProgress(static_cast<double>(LatencyMonitor::now() - startTime) / 1.0e9);
+
+    juce::MessageManager::callAsync([] { juce::JUCEApplication::quit(); });
+}
+
+//------------------------------------------------------------------------------
+// Sends the voice's next step of the pattern and returns how many MIDI events it sent.
+int TrafficGenerator::generate(Voice& voice, Pattern voicePattern, juce::Random& random)
+{
+    auto tick = voice.tick++;
+    int sent = 0;
+
+    auto noteOff = [&](int note)
+        {
+            sendEvent(voice.client, ProtocolProfile::EventType::NoteOff, voice.channel, note, 0);
+            voice.heldNotes.removeFirstMatchingValue(note);
+            ++sent;
+        };
+
+    auto noteOn = [&](int note, int velocity)
+        {
+            if (voice.heldNotes.contains(note))
+                noteOff(note);
+
+            sendEvent(voice.client, ProtocolProfile::EventType::NoteOn, voice.channel, note, velocity);
+            voice.heldNotes.add(note);
+            ++sent;
+        };
+
+    switch (voicePattern)
+    {
+    case Pattern::notes:
+        // At most eight notes ring at once; the oldest is released first
+        if (voice.heldNotes.size() >= 8)
+            noteOff(voice.heldNotes.getFirst());
+        else
+            noteOn(36 + random.nextInt(60), 1 + random.nextInt(127));
+        break;
+
+    case Pattern::chords:
+    {
+        if (!voice.heldNotes.isEmpty())
+        {
+            while (!voice.heldNotes.isEmpty())
+                noteOff(voice.heldNotes.getFirst());
+            break;
+        }
+
+        static const int intervals[] = { 0, 4, 7, 11 };
+        auto root = 48 + random.nextInt(24);
+        auto size = 3 + random.nextInt(2);
+        for (int i = 0; i < size; ++i)
+            noteOn(root + intervals[i], 80 + random.nextInt(40));
+    }
+    break;
+
+    case Pattern::cc:
+    {
+        // A triangle sweep, moving to the next controller every full sweep
+        auto position = tick % 254;
+        auto controller = sweptControllers[(tick / 254) % juce::numElementsInArray(sweptControllers)];
+        sendEvent(voice.client, ProtocolProfile::EventType::ControlChange, voice.channel, controller,
+                  position < 127 ? position : 254 - position);
+        ++sent;
+    }
+    break;
+
+    case Pattern::bend:
+    {
+        auto phase = static_cast<double>(tick % 200) / 200.0 * juce::MathConstants<double>::twoPi;
+        sendEvent(voice.client, ProtocolProfile::EventType::PitchBend, voice.channel, 0,
+                  8192 + juce::roundToInt(std::sin(phase) * 4096.0));
+        ++sent;
+    }
+    break;
+
+    case Pattern::mixed:
+        break;
+    }
+
+    return sent;
+}
+
+//------------------------------------------------------------------------------
+void TrafficGenerator::sendEvent(int client, ProtocolProfile::EventType type, int channel, int number, int value)
+{
+    auto* socket = clients[client];
+
+    auto send = [&](const char* data, int size)
+        {
+            if (socket->write(host, port, data, size) == size)
+                ++numPackets;
+            else
+                ++numErrors;
+        };
+
+    if (profile != nullptr)
+    {
+        ProtocolProfile::Event event;
+        event.type = type;
+        event.channel = channel;
+        event.number = number;
+        event.value = value;
+        profile->encode(event, send);
+        return;
+    }
+
+    static const juce::uint8 statusForType[] = { 0x90, 0x80, 0xb0, 0xe0, 0xd0 };   // in ProtocolProfile::EventType order
+    auto status = static_cast<juce::uint8>(statusForType[static_cast<int>(type)] | (channel - 1));
+    auto data1 = type == ProtocolProfile::EventType::PitchBend ? (value & 0x7f) : number;
+    auto data2 = type == ProtocolProfile::EventType::PitchBend ? (value >> 7) : value;
+
+    OscMessageWriter writer;
+    writer.begin(OscPacket::nativeMidiAddress);
+    writer.addMidi(0, status, static_cast<juce::uint8>(data1 & 0x7f), static_cast<juce::uint8>(data2 & 0x7f));
+
+    char packet[OscPacket::maxPacketSize];
+    send(packet, writer.write(packet, sizeof(packet)));
+}
+
+//------------------------------------------------------------------------------
+void TrafficGenerator::printProgress(double seconds)
+{
+    std::cout << juce::String(seconds, 1) << " s: " << static_cast<juce::int64>(numEvents) << " events ("
+              << static_cast<juce::int64>(numEvents - lastEvents) << " since last), "
+              << static_cast<juce::int64>(numPackets) << " packets, " << static_cast<juce::int64>(numErrors)
+              << " send errors" << std::endl;
+    lastEvents = numEvents;
+}
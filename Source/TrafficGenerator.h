@@ -0,0 +1,68 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+#include "OscPacket.h"
+#include "ProtocolProfile.h"
+
+//==============================================================================
+// Synthetic OSC traffic for soak testing, run with --generate instead of starting
+// the bridge (typically as a second instance pointed at the first). Events are
+// MIDI in the README address scheme, or any profile or native 'm' MIDI, sent at
+// a precise rate from a timed loop: it sleeps while the next event is far off
+// and yields for the last couple of milliseconds, or spins with --busy-wait.
+//
+//   --generate
+//   --target <host:port>        where to send (default 127.0.0.1:5550)
+//   --pattern <name>            notes, chords, cc, bend or mixed (default mixed)
+//   --rate <events/s>           MIDI events per second over all clients (default 1000)
+//   --duration <seconds>        stop after this long (default: run until killed)
+//   --channels <n>              spread the traffic over channels 1-n (default 1)
+//   --clients <n>               simulated clients, each with its own source port (default 1)
+//   --protocol <name>|native    Patchworld (default), native, or a profile JSON file
+//   --busy-wait                 spin between events instead of sleeping
+class TrafficGenerator : private juce::Thread
+{
+public:
+    explicit TrafficGenerator(const juce::StringArray& args);
+    ~TrafficGenerator() override;
+
+    enum class Pattern
+    {
+        notes,     // note storm: random notes, each released a few events later
+        chords,    // 3-4 note chords, each replaced by the next
+        cc,        // dense sweeps over a handful of controllers
+        bend,      // pitch bend wiggle
+        mixed      // the others in turn
+    };
+
+private:
+    // One client on one channel, with its own pattern state
+    struct Voice
+    {
+        int client = 0;
+        int channel = 1;
+        int tick = 0;
+        juce::Array<int> heldNotes;
+    };
+
+    void run() override;
+    int generate(Voice& voice, Pattern pattern, juce::Random& random);
+    void sendEvent(int client, ProtocolProfile::EventType type, int channel, int number, int value);
+    void printProgress(double seconds);
+
+    juce::String host = "127.0.0.1";
+    int port = 5550;
+    Pattern pattern = Pattern::mixed;
+    double rate = 1000.0, duration = 0.0;
+    bool busyWait = false;
+
+    ProtocolProfile::Ptr profile;   // nullptr for native 'm' MIDI
+    juce::OwnedArray<juce::DatagramSocket> clients;
+    std::vector<Voice> voices;
+
+    juce::uint64 numEvents = 0, numPackets = 0, numErrors = 0;
+    juce::uint64 lastEvents = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TrafficGenerator)
+};
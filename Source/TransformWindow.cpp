@@ -0,0 +1,246 @@
+#include "TransformWindow.h"
+
+namespace
+{
+    struct Scale
+    {
+        const char* name;
+        juce::uint16 mask;   // bit n = root + n semitones
+    };
+
+    const Scale scales[] = {
+        { "Chromatic",         0x0fff },
+        { "Major",             0x0ab5 },
+        { "Natural Minor",     0x05ad },
+        { "Harmonic Minor",    0x09ad },
+        { "Dorian",            0x06ad },
+        { "Major Pentatonic",  0x0295 },
+        { "Minor Pentatonic",  0x04a9 },
+        { "Blues",             0x04e9 }
+    };
+
+    const char* const noteNames[12] = { "C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B" };
+}
+
+TransformWindow::TransformWindow(SettingsChangedCallback callback)
+    : DocumentWindow("MIDI Transforms", juce::Colours::darkgrey, DocumentWindow::allButtons),
+      transformComponent(std::move(callback))
+{
+    setUsingNativeTitleBar(true);
+    setContentNonOwned(&transformComponent, true);
+    transformComponent.setSize(560, 380);
+    setResizable(true, true);
+    setResizeLimits(480, 360, 1200, 800);
+    centreWithSize(getWidth(), getHeight());
+}
+
+TransformWindow::~TransformWindow()
+{
+    clearContentComponent();
+}
+
+void TransformWindow::closeButtonPressed()
+{
+    setVisible(false);
+}
+
+void TransformWindow::setRouteSettings(int route, const MidiTransform::Settings& settings)
+{
+    transformComponent.setRouteSettings(route, settings);
+}
+
+//==============================================================================
+TransformWindow::TransformComponent::TransformComponent(SettingsChangedCallback callback)
+    : onSettingsChanged(std::move(callback))
+{
+    auto onChange = [this]() { settingsEdited(); };
+
+    routeComboBox.addItem(juce::String::fromUTF8("MIDI In \xe2\x86\x92 OSC / MIDI Out"), midiToOsc + 1);
+    routeComboBox.addItem(juce::String::fromUTF8("OSC In \xe2\x86\x92 MIDI Out"), oscToMidi + 1);
+    routeComboBox.onChange = [this]() { showRoute(routeComboBox.getSelectedId() - 1); };
+    addAndMakeVisible(routeLabel);
+    addAndMakeVisible(routeComboBox);
+
+    resetButton.onClick = [this]()
+        {
+            routeSettings[currentRoute] = {};
+            showRoute(currentRoute);
+            settingsEdited();
+        };
+    addAndMakeVisible(resetButton);
+
+    // Velocity and CC: curve, curve strength, output range
+    velocityCurveComboBox.addItemList(MidiTransform::getCurveNames(), 1);
+    ccCurveComboBox.addItemList(MidiTransform::getCurveNames(), 1);
+
+    for (auto* amount : { &velocityAmountSlider, &ccAmountSlider })
+    {
+        amount->setRange(0.0, 1.0, 0.01);
+        amount->setTextBoxStyle(juce::Slider::TextBoxRight, false, 50, 20);
+        amount->setTooltip("Curve strength");
+    }
+
+    velocityRangeSlider.setSliderStyle(juce::Slider::TwoValueHorizontal);
+    velocityRangeSlider.setRange(1.0, 127.0, 1.0);
+    ccRangeSlider.setSliderStyle(juce::Slider::TwoValueHorizontal);
+    ccRangeSlider.setRange(0.0, 127.0, 1.0);
+
+    for (auto* range : { &velocityRangeSlider, &ccRangeSlider })
+    {
+        range->setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
+        range->setPopupDisplayEnabled(true, true, this);
+        range->setTooltip("Output range");
+    }
+
+    // Notes
+    transposeSlider.setRange(-24.0, 24.0, 1.0);
+    transposeSlider.setTextBoxStyle(juce::Slider::TextBoxRight, false, 50, 20);
+
+    for (int i = 0; i < juce::numElementsInArray(scales); ++i)
+        scaleComboBox.addItem(scales[i].name, i + 1);
+
+    for (int i = 0; i < 12; ++i)
+        scaleRootComboBox.addItem(noteNames[i], i + 1);
+
+    channelComboBox.addItem("Keep", 1);
+    for (int channel = 1; channel <= 16; ++channel)
+        channelComboBox.addItem(juce::String::fromUTF8("All \xe2\x86\x92 ") + juce::String(channel), channel + 1);
+
+    pitchBendAmountSlider.setRange(0.0, 2.0, 0.01);
+    pitchBendAmountSlider.setTextBoxStyle(juce::Slider::TextBoxRight, false, 50, 20);
+
+    for (auto* slider : { &velocityAmountSlider, &velocityRangeSlider, &ccAmountSlider, &ccRangeSlider,
+                          &transposeSlider, &pitchBendAmountSlider })
+    {
+        slider->onValueChange = onChange;
+        addAndMakeVisible(slider);
+    }
+
+    for (auto* comboBox : { &velocityCurveComboBox, &ccCurveComboBox, &scaleComboBox, &scaleRootComboBox, &channelComboBox })
+    {
+        comboBox->onChange = onChange;
+        addAndMakeVisible(comboBox);
+    }
+
+    invertPitchBendToggle.onClick = onChange;
+    addAndMakeVisible(invertPitchBendToggle);
+
+    for (auto* label : { &velocityLabel, &ccLabel, &transposeLabel, &scaleLabel, &channelLabel, &pitchBendLabel })
+        addAndMakeVisible(label);
+
+    routeComboBox.setSelectedId(midiToOsc + 1, juce::dontSendNotification);
+    showRoute(midiToOsc);
+}
+
+void TransformWindow::TransformComponent::setRouteSettings(int route, const MidiTransform::Settings& settings)
+{
+    routeSettings[route] = settings;
+
+    if (route == currentRoute)
+        showRoute(route);
+}
+
+void TransformWindow::TransformComponent::showRoute(int route)
+{
+    currentRoute = juce::jlimit(0, numRoutes - 1, route);
+    auto& s = routeSettings[currentRoute];
+
+    velocityCurveComboBox.setSelectedId(static_cast<int>(s.velocityCurve) + 1, juce::dontSendNotification);
+    velocityAmountSlider.setValue(s.velocityAmount, juce::dontSendNotification);
+    velocityRangeSlider.setMinAndMaxValues(s.velocityMin, s.velocityMax, juce::dontSendNotification);
+
+    ccCurveComboBox.setSelectedId(static_cast<int>(s.ccCurve) + 1, juce::dontSendNotification);
+    ccAmountSlider.setValue(s.ccAmount, juce::dontSendNotification);
+    ccRangeSlider.setMinAndMaxValues(juce::jmin(s.ccMin, s.ccMax), juce::jmax(s.ccMin, s.ccMax), juce::dontSendNotification);
+
+    transposeSlider.setValue(s.transpose, juce::dontSendNotification);
+    scaleRootComboBox.setSelectedId(s.scaleRoot + 1, juce::dontSendNotification);
+
+    int scaleId = 1;
+    for (int i = 0; i < juce::numElementsInArray(scales); ++i)
+        if (scales[i].mask == s.scaleMask)
+            scaleId = i + 1;
+    scaleComboBox.setSelectedId(scaleId, juce::dontSendNotification);
+
+    // The UI only offers "keep" or "everything to one channel"
+    bool allSame = std::all_of(std::begin(s.channelMap), std::end(s.channelMap),
+                               [&s](int channel) { return channel == s.channelMap[0]; });
+    channelComboBox.setSelectedId(allSame ? s.channelMap[0] + 1 : 1, juce::dontSendNotification);
+
+    pitchBendAmountSlider.setValue(s.pitchBendAmount, juce::dontSendNotification);
+    invertPitchBendToggle.setToggleState(s.invertPitchBend, juce::dontSendNotification);
+}
+
+void TransformWindow::TransformComponent::settingsEdited()
+{
+    auto& s = routeSettings[currentRoute];
+
+    s.velocityCurve = static_cast<MidiTransform::Curve>(juce::jmax(0, velocityCurveComboBox.getSelectedId() - 1));
+    s.velocityAmount = static_cast<float>(velocityAmountSlider.getValue());
+    s.velocityMin = juce::roundToInt(velocityRangeSlider.getMinValue());
+    s.velocityMax = juce::roundToInt(velocityRangeSlider.getMaxValue());
+
+    s.ccCurve = static_cast<MidiTransform::Curve>(juce::jmax(0, ccCurveComboBox.getSelectedId() - 1));
+    s.ccAmount = static_cast<float>(ccAmountSlider.getValue());
+    s.ccMin = juce::roundToInt(ccRangeSlider.getMinValue());
+    s.ccMax = juce::roundToInt(ccRangeSlider.getMaxValue());
+
+    s.transpose = juce::roundToInt(transposeSlider.getValue());
+    s.scaleRoot = juce::jmax(0, scaleRootComboBox.getSelectedId() - 1);
+    s.scaleMask = scales[juce::jmax(0, scaleComboBox.getSelectedId() - 1)].mask;
+
+    int channelId = channelComboBox.getSelectedId();
+    for (int channel = 1; channel <= 16; ++channel)
+        s.channelMap[channel - 1] = channelId > 1 ? channelId - 1 : channel;
+
+    s.pitchBendAmount = static_cast<float>(pitchBendAmountSlider.getValue());
+    s.invertPitchBend = invertPitchBendToggle.getToggleState();
+
+    if (onSettingsChanged)
+        onSettingsChanged(currentRoute, s);
+}
+
+void TransformWindow::TransformComponent::resized()
+{
+    auto area = getLocalBounds().reduced(10);
+    const int rowHeight = 30;
+    const int labelWidth = 110;
+
+    auto topRow = area.removeFromTop(rowHeight);
+    resetButton.setBounds(topRow.removeFromRight(110).reduced(0, 3));
+    routeLabel.setBounds(topRow.removeFromLeft(labelWidth));
+    routeComboBox.setBounds(topRow.reduced(0, 3).withTrimmedRight(10));
+    area.removeFromTop(10);
+
+    // Curve rows: curve type, strength, output range
+    auto layoutCurveRow = [&](juce::Label& label, juce::ComboBox& curve, juce::Slider& amount, juce::Slider& range)
+        {
+            auto row = area.removeFromTop(rowHeight);
+            label.setBounds(row.removeFromLeft(labelWidth));
+            curve.setBounds(row.removeFromLeft(120).reduced(0, 3));
+            int half = row.getWidth() / 2;
+            amount.setBounds(row.removeFromLeft(half).reduced(5, 0));
+            range.setBounds(row.reduced(5, 0));
+        };
+
+    layoutCurveRow(velocityLabel, velocityCurveComboBox, velocityAmountSlider, velocityRangeSlider);
+    layoutCurveRow(ccLabel, ccCurveComboBox, ccAmountSlider, ccRangeSlider);
+
+    auto row = area.removeFromTop(rowHeight);
+    transposeLabel.setBounds(row.removeFromLeft(labelWidth));
+    transposeSlider.setBounds(row);
+
+    row = area.removeFromTop(rowHeight);
+    scaleLabel.setBounds(row.removeFromLeft(labelWidth));
+    scaleRootComboBox.setBounds(row.removeFromLeft(70).reduced(0, 3));
+    scaleComboBox.setBounds(row.removeFromLeft(180).reduced(5, 3));
+
+    row = area.removeFromTop(rowHeight);
+    channelLabel.setBounds(row.removeFromLeft(labelWidth));
+    channelComboBox.setBounds(row.removeFromLeft(150).reduced(0, 3));
+
+    row = area.removeFromTop(rowHeight);
+    pitchBendLabel.setBounds(row.removeFromLeft(labelWidth));
+    invertPitchBendToggle.setBounds(row.removeFromRight(80));
+    pitchBendAmountSlider.setBounds(row);
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "MidiTransform.h"
+
+// Pop-up window for editing the transform applied on each route. Every edit
+// produces a new Settings for the route, which the owner compiles and swaps in.
+class TransformWindow : public juce::DocumentWindow
+{
+public:
+    enum Route
+    {
+        midiToOsc = 0,   // MIDI input / keyboard -> OSC and MIDI output
+        oscToMidi,       // OSC input -> MIDI output
+        numRoutes
+    };
+
+    using SettingsChangedCallback = std::function<void(int route, const MidiTransform::Settings&)>;
+
+    explicit TransformWindow(SettingsChangedCallback callback);
+    ~TransformWindow() override;
+
+    void closeButtonPressed() override;
+
+    // Shows the settings currently in use for a route.
+    void setRouteSettings(int route, const MidiTransform::Settings& settings);
+
+private:
+    class TransformComponent : public juce::Component
+    {
+    public:
+        explicit TransformComponent(SettingsChangedCallback callback);
+
+        void setRouteSettings(int route, const MidiTransform::Settings& settings);
+        void resized() override;
+
+    private:
+        void showRoute(int route);
+        void settingsEdited();
+
+        SettingsChangedCallback onSettingsChanged;
+        MidiTransform::Settings routeSettings[numRoutes];
+        int currentRoute = midiToOsc;
+
+        juce::Label routeLabel{ "routeLabel", "Route:" };
+        juce::ComboBox routeComboBox;
+        juce::TextButton resetButton{ "Reset Route" };
+
+        juce::Label velocityLabel{ "velocityLabel", "Velocity:" };
+        juce::ComboBox velocityCurveComboBox;
+        juce::Slider velocityAmountSlider, velocityRangeSlider;
+
+        juce::Label ccLabel{ "ccLabel", "CC / Pressure:" };
+        juce::ComboBox ccCurveComboBox;
+        juce::Slider ccAmountSlider, ccRangeSlider;
+
+        juce::Label transposeLabel{ "transposeLabel", "Transpose:" };
+        juce::Slider transposeSlider;
+
+        juce::Label scaleLabel{ "scaleLabel", "Scale:" };
+        juce::ComboBox scaleComboBox, scaleRootComboBox;
+
+        juce::Label channelLabel{ "channelLabel", "Channel:" };
+        juce::ComboBox channelComboBox;
+
+        juce::Label pitchBendLabel{ "pitchBendLabel", "Pitch Bend:" };
+        juce::Slider pitchBendAmountSlider;
+        juce::ToggleButton invertPitchBendToggle{ "Invert" };
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TransformComponent)
+    };
+
+    TransformComponent transformComponent;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TransformWindow)
+};